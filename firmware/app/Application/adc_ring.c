@@ -0,0 +1,34 @@
+#include "adc_ring.h"
+
+void AdcRing_Init(AdcRing_t *ring, AdcSample_t *buff, uint32_t len)
+{
+    ring->sample = buff;
+    ring->len = len;
+    ring->writeCount = 0;
+}
+
+void AdcRing_Push(AdcRing_t *ring, uint32_t time, uint16_t v0, uint16_t v1, uint16_t v2, uint16_t v3)
+{
+    AdcSample_t *sample = &ring->sample[ring->writeCount % ring->len];
+    sample->time = time;
+    sample->value[0] = v0;
+    sample->value[1] = v1;
+    sample->value[2] = v2;
+    sample->value[3] = v3;
+    ring->writeCount++;
+}
+
+uint32_t AdcRing_Read(const AdcRing_t *ring, uint32_t *readCount, AdcSample_t *out, uint32_t max)
+{
+    uint32_t writeCount = ring->writeCount;
+    if (writeCount - *readCount > ring->len)
+        *readCount = writeCount - ring->len; // 读取太慢, 丢弃最旧的采样
+
+    uint32_t n = 0;
+    while (*readCount != writeCount && n < max)
+    {
+        out[n++] = ring->sample[*readCount % ring->len];
+        (*readCount)++;
+    }
+    return n;
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "cl_common.h"
+
+// 带时间戳的采样环形缓冲: 中断中写入, 任务中各自保存读计数读取, 互不影响
+// 读取落后超过缓冲长度时丢弃最旧的采样
+
+typedef struct
+{
+    uint32_t time; // 采样时间, us
+    uint16_t value[4];
+} AdcSample_t;
+
+typedef struct
+{
+    AdcSample_t *sample;
+    uint32_t len; // 2的幂, 写计数溢出回绕后位置仍连续
+    volatile uint32_t writeCount;
+} AdcRing_t;
+
+void AdcRing_Init(AdcRing_t *ring, AdcSample_t *buff, uint32_t len);
+void AdcRing_Push(AdcRing_t *ring, uint32_t time, uint16_t v0, uint16_t v1, uint16_t v2, uint16_t v3);
+// 读取readCount之后的新采样, 最多max个, 返回读取个数
+uint32_t AdcRing_Read(const AdcRing_t *ring, uint32_t *readCount, AdcSample_t *out, uint32_t max);
@@ -5,6 +5,7 @@
 #define MINOR_VER_NUMBER (0)
 #define PATCH_VER_NUMBER (6)
 
+// 地址为APP_FW_INFO_ADDR, boot读取版本号
 const FirmwareInfo_t appFwInfo __attribute__((section(".ARM.__AT_0x08013800"))) = {
     .verMajor = MAJOR_VER_NUMBER,
     .verMinor = MINOR_VER_NUMBER,
@@ -0,0 +1,58 @@
+#include "button_map.h"
+
+// [半字节序号][半字节值] -> 映射后的按键位
+static uint16_t mapLut[BUTTON_MAP_COUNT / 4][16];
+static bool mapIdentity = true; // 默认映射时直接返回
+
+void ButtonMap_GetDefault(ButtonMapParams_t *params)
+{
+    for (int i = 0; i < BUTTON_MAP_COUNT; i++)
+        params->target[i] = i;
+}
+
+bool ButtonMap_IsValid(const ButtonMapParams_t *params)
+{
+    for (int i = 0; i < BUTTON_MAP_COUNT; i++)
+    {
+        if (params->target[i] >= BUTTON_MAP_COUNT && params->target[i] != BUTTON_MAP_NONE)
+            return false;
+    }
+    return true;
+}
+
+void ButtonMap_Build(const ButtonMapParams_t *params)
+{
+    bool identity = true;
+    for (int nibble = 0; nibble < BUTTON_MAP_COUNT / 4; nibble++)
+    {
+        for (int value = 0; value < 16; value++)
+        {
+            uint16_t out = 0;
+            for (int bit = 0; bit < 4; bit++)
+            {
+                uint8_t target = params->target[nibble * 4 + bit];
+                if ((value & (1 << bit)) && target != BUTTON_MAP_NONE)
+                    out |= 1 << target;
+            }
+            mapLut[nibble][value] = out;
+        }
+    }
+
+    for (int i = 0; i < BUTTON_MAP_COUNT; i++)
+    {
+        if (params->target[i] != i)
+            identity = false;
+    }
+    mapIdentity = identity;
+}
+
+uint16_t ButtonMap_Apply(uint16_t buttons)
+{
+    if (mapIdentity)
+        return buttons;
+
+    return mapLut[0][buttons & 0xf] |
+           mapLut[1][(buttons >> 4) & 0xf] |
+           mapLut[2][(buttons >> 8) & 0xf] |
+           mapLut[3][buttons >> 12];
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "cl_common.h"
+
+// 按键重映射: 物理按键位i上报为target[i], 可以禁用或多个键映射到同一位
+// 按位编号与上报一致: button[0]为0~7, button[1]为8~15
+// 切换配置时展开为按半字节查表, 上报时4次查表完成映射
+
+#define BUTTON_MAP_COUNT (16)
+#define BUTTON_MAP_NONE (0xff) // 禁用该键
+
+typedef struct
+{
+    uint8_t target[BUTTON_MAP_COUNT];
+} ButtonMapParams_t;
+
+void ButtonMap_GetDefault(ButtonMapParams_t *params);
+bool ButtonMap_IsValid(const ButtonMapParams_t *params);
+
+// 任务中调用, 生成查表
+void ButtonMap_Build(const ButtonMapParams_t *params);
+
+// 上报任务中调用, buttons为button[1] << 8 | button[0]
+uint16_t ButtonMap_Apply(uint16_t buttons);
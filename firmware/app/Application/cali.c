@@ -3,18 +3,33 @@
 #include "cl_log.h"
 #include "crc.h"
 #include "string.h"
+#include "stdlib.h"
 #include "flash_layout.h"
 #include "iflash_stm32.h"
 #include "cl_event_system.h"
 #include "button.h"
 #include "led.h"
-#include "cl_queue.h"
-#include "systime.h"
+#include "sched.h"
+#include "ustime.h"
 #include "adc.h"
 #include "mathex.h"
+#include "profile.h"
+#include "pad_func.h"
+#include "rapid_trigger.h"
+#include "haptics.h"
+#include "stick_fit.h"
+#include "button_map.h"
 
 static float GetRadian(const Vector2 *v);
 
+// 摇杆最小内死区(半径平方), 中心漂移由后台补偿, 死区不必覆盖漂移量
+// 按校准时测得的噪声计算, 噪声未知(旧参数)时使用上限, 整形参数可设置更大的死区
+#define STICK_DEADZONE_SQR (0.005f)
+#define STICK_DEADZONE_MIN (0.02f)   // 最小死区半径
+#define STICK_DEADZONE_SIGMA_K (4.0f) // 死区半径取噪声标准差的倍数
+
+#define PARAM_SAVE_DELAY USTIME_SECOND(2) // 整形等参数最后一次修改后延迟保存
+
 static CaliParams_t caliParams = {0};
 
 const CaliParams_t *GetCaliParams(void)
@@ -26,97 +41,301 @@ static void PrintParams(CaliParams_t *params)
 {
     CL_LOG_INFO("**********");
     CL_LOG_INFO("cali params:");
-    CL_LOG_INFO("left trigger: %d, %d", caliParams.leftTrigger[0], caliParams.leftTrigger[1]);
-    CL_LOG_INFO("right trigger: %d, %d", caliParams.rightTrigger[0], caliParams.rightTrigger[1]);
+    CL_LOG_INFO("left trigger: %d, %d", params->leftTrigger[0], params->leftTrigger[1]);
+    CL_LOG_INFO("right trigger: %d, %d", params->rightTrigger[0], params->rightTrigger[1]);
+    CL_LOG_INFO("left drift: %d, %d", params->leftDrift[0], params->leftDrift[1]);
+    CL_LOG_INFO("right drift: %d, %d", params->rightDrift[0], params->rightDrift[1]);
+    CL_LOG_INFO("left sigma: %d, %d", params->leftSigma[0], params->leftSigma[1]);
+    CL_LOG_INFO("right sigma: %d, %d", params->rightSigma[0], params->rightSigma[1]);
+    for (int i = 0; i < RapidTrig_Max; i++)
+    {
+        const RapidTrigParams_t *rt = &params->rapidTrigger[i];
+        CL_LOG_INFO("rapid trigger %d: %d, bit %d, %d/%d, top %d",
+                    i, rt->enable, rt->buttonBit, rt->pressDelta, rt->releaseDelta, rt->topDz);
+    }
     CL_LOG_INFO("----------");
 }
 
-static void ResetParams(void)
+static void ResetParams(CaliParams_t *params)
 {
-    caliParams.leftMidX = 2048;
-    caliParams.leftMidY = 2048;
-    for (int i = 0; i < CL_ARRAY_LENGTH(caliParams.leftMag); i++)
+    params->leftMidX = 2048;
+    params->leftMidY = 2048;
+    for (int i = 0; i < CL_ARRAY_LENGTH(params->leftMag); i++)
     {
-        caliParams.leftMag[i] = 2048;
+        params->leftMag[i] = 2048;
     }
 
-    caliParams.rightMidX = 2048;
-    caliParams.rightMidY = 2048;
-    for (int i = 0; i < CL_ARRAY_LENGTH(caliParams.rightMag); i++)
+    params->rightMidX = 2048;
+    params->rightMidY = 2048;
+    for (int i = 0; i < CL_ARRAY_LENGTH(params->rightMag); i++)
     {
-        caliParams.rightMag[i] = 2048;
+        params->rightMag[i] = 2048;
     }
 
-    caliParams.leftTrigger[0] = 0;
-    caliParams.leftTrigger[1] = 4096;
+    params->leftTrigger[0] = 0;
+    params->leftTrigger[1] = 4096;
+
+    params->rightTrigger[0] = 0;
+    params->rightTrigger[1] = 4096;
+
+    memset(params->leftDrift, 0, sizeof(params->leftDrift));
+    memset(params->rightDrift, 0, sizeof(params->rightDrift));
+    memset(params->leftSigma, 0, sizeof(params->leftSigma));
+    memset(params->rightSigma, 0, sizeof(params->rightSigma));
+
+    for (int i = 0; i < ShapeIn_Max; i++)
+        Shape_GetDefault((ShapeInput_t)i, &params->shape[i]);
+
+    for (int i = 0; i < RapidTrig_Max; i++)
+        RapidTrig_GetDefault((RapidTrigIdx_t)i, &params->rapidTrigger[i]);
 
-    caliParams.rightTrigger[0] = 0;
-    caliParams.rightTrigger[1] = 4096;
+    for (int i = 0; i < StickLin_Max; i++)
+        StickLin_GetDefault(&params->linear[i]);
+
+    ButtonMap_GetDefault(&params->buttonMap);
+
+    params->version = CALI_PARAMS_VERSION;
+    params->size = sizeof(CaliParams_t);
 }
 
-static void LoadCalibration(void)
+#define CALI_V0_SIZE (CL_OFFSET_OF(CaliParams_t, version)) // v0格式crc之前的长度
+
+static bool IsSavedCrcValid(const uint8_t *saved, uint32_t len)
 {
-    memcpy((void *)&caliParams, (void *)PAD_PARAM_ADDR, sizeof(caliParams));
-    uint32_t crc = Ethernet_CRC32((const uint8_t *)&caliParams, CL_OFFSET_OF(CaliParams_t, crc));
-    if (crc != caliParams.crc)
-    { // use default params
-        CL_LOG_INFO("use default params");
-        ResetParams();
+    uint32_t crc;
+    memcpy(&crc, saved + len, sizeof(crc));
+    return crc == Ethernet_CRC32(saved, len);
+}
+
+static void LoadCalibration(uint8_t profile, CaliParams_t *params)
+{
+    const uint8_t *saved = (const uint8_t *)PAD_PROFILE_ADDR(profile);
+    uint16_t savedSize;
+    memcpy(&savedSize, saved + CL_OFFSET_OF(CaliParams_t, size), sizeof(savedSize));
+
+    // 先填默认值, 再用保存的数据覆盖, 旧版本缺少的字段保持默认
+    ResetParams(params);
+    if (savedSize > CALI_V0_SIZE + sizeof(uint32_t) &&
+        savedSize <= FLASH_PAGE_SIZE &&
+        savedSize % sizeof(uint32_t) == 0 &&
+        IsSavedCrcValid(saved, savedSize - sizeof(uint32_t)))
+    {
+        memcpy(params, saved, CL_MIN(savedSize - sizeof(uint32_t), CL_OFFSET_OF(CaliParams_t, crc)));
+        params->version = CALI_PARAMS_VERSION;
+        params->size = sizeof(CaliParams_t);
+        CL_LOG_INFO("profile %d use saved params, size: %d", profile, savedSize);
+        PrintParams(params);
+    }
+    else if (IsSavedCrcValid(saved, CALI_V0_SIZE))
+    { // v0格式, 无版本号
+        memcpy(params, saved, CALI_V0_SIZE);
+        CL_LOG_INFO("profile %d use saved params, migrated from v0", profile);
+        PrintParams(params);
     }
     else
+    { // use default params
+        CL_LOG_INFO("profile %d use default params", profile);
+    }
+
+    for (int i = 0; i < ShapeIn_Max; i++)
+    {
+        if (!Shape_IsValid(&params->shape[i]))
+            Shape_GetDefault((ShapeInput_t)i, &params->shape[i]);
+    }
+
+    for (int i = 0; i < RapidTrig_Max; i++)
     {
-        CL_LOG_INFO("use saved params");
-        PrintParams(&caliParams);
+        if (!RapidTrig_IsValid(&params->rapidTrigger[i]))
+            RapidTrig_GetDefault((RapidTrigIdx_t)i, &params->rapidTrigger[i]);
     }
+
+    for (int i = 0; i < StickLin_Max; i++)
+    {
+        if (!StickLin_IsValid(&params->linear[i]))
+            StickLin_GetDefault(&params->linear[i]);
+    }
+
+    if (!ButtonMap_IsValid(&params->buttonMap))
+        ButtonMap_GetDefault(&params->buttonMap);
 }
 
+static uint8_t activeProfile = 0; // 当前档案, 参数修改保存到该档案
+
 static void SaveCalibration(void)
 {
+    uint32_t addr = PAD_PROFILE_ADDR(activeProfile);
     caliParams.crc = Ethernet_CRC32((const uint8_t *)&caliParams, CL_OFFSET_OF(CaliParams_t, crc));
     HAL_FLASH_Unlock();
-    IFlashStm32_ErasePages(PAD_PARAM_ADDR, 1);
-    IFlashStm32_Write(PAD_PARAM_ADDR, (const uint8_t *)&caliParams, sizeof(caliParams));
+    IFlashStm32_ErasePages(addr, 1);
+    IFlashStm32_Write(addr, (const uint8_t *)&caliParams, sizeof(caliParams));
+    HAL_FLASH_Lock();
+}
+
+//**************当前档案记录****************
+// 记录在独立的一页, 位置与参数长度无关; 每次切换追加一个半字, 以最后一条为准, 不必每次擦除
+// 写满时只擦除记录页, 擦除后掉电只会回到档案0, 各档案参数不受影响
+#define PROFILE_SEL_START (PAD_PROFILE_SEL_ADDR)
+#define PROFILE_SEL_END (PAD_PROFILE_SEL_ADDR + FLASH_PAGE_SIZE)
+#define PROFILE_SEL_TAG (0xa500)
+#define PROFILE_SEL_EMPTY (0xffff)
+
+// 返回第一条空记录的地址, 写满时返回PROFILE_SEL_END
+static uint32_t FindProfileSelection(uint8_t *profile)
+{
+    *profile = 0;
+    uint32_t addr = PROFILE_SEL_START;
+    for (; addr < PROFILE_SEL_END; addr += sizeof(uint16_t))
+    {
+        uint16_t rec = *(const uint16_t *)addr;
+        if (rec == PROFILE_SEL_EMPTY)
+            break;
+        if ((rec & 0xff00) == PROFILE_SEL_TAG && (rec & 0xff) < PAD_PROFILE_COUNT)
+            *profile = rec & 0xff;
+    }
+    return addr;
+}
+
+static void SaveProfileSelection(uint8_t profile)
+{
+    uint8_t saved;
+    uint32_t addr = FindProfileSelection(&saved);
+    if (saved == profile)
+        return;
+
+    uint16_t rec = PROFILE_SEL_TAG | profile;
+    HAL_FLASH_Unlock();
+    if (addr >= PROFILE_SEL_END)
+    { // 写满, 擦除记录页后重新记录
+        IFlashStm32_ErasePages(PROFILE_SEL_START, 1);
+        addr = PROFILE_SEL_START;
+        CL_LOG_INFO("profile selection log rewritten");
+    }
+    if (profile != 0 || addr != PROFILE_SEL_START)
+        IFlashStm32_Write(addr, (const uint8_t *)&rec, sizeof(rec));
     HAL_FLASH_Lock();
 }
 
 static CaliStatus_t caliStatus = CaliSta_None;
+static uint32_t caliStepTime = 0; // 当前校准步骤开始时间, 用于统计收敛耗时
+static bool marginCovered = false;
+static StickFit_t leftFit, rightFit; // 边界校准的拟合累加量
+static uint32_t marginReadCount = 0; // 摇杆采样流的读计数
+
+static void DriftReset(void);
+static void ParamSaveIfNeeded(void);
+static void LinCaptureProc(void);
+static void ProfileSwitchProc(void);
+static void ProfileSwitchAbort(void);
+static bool OnProfileChord(uint8_t profile, void *eventArg);
+
+static float CalcDeadzoneSqr(const uint16_t sigma[2], const uint16_t *mags, uint8_t len)
+{
+    if (sigma[0] == 0 || sigma[1] == 0)
+        return STICK_DEADZONE_SQR;
+
+    float magSum = 0;
+    for (int i = 0; i < len; i++)
+        magSum += mags[i];
+    if (magSum <= 0)
+        return STICK_DEADZONE_SQR;
+
+    // 死区半径 = K * 径向噪声 / 平均边界长度
+    float sigmaR = sqrtf((float)sigma[0] * sigma[0] + (float)sigma[1] * sigma[1]) / CALI_SIGMA_SCALE;
+    float radius = STICK_DEADZONE_SIGMA_K * sigmaR / (magSum / len);
+    radius = CL_MAX(radius, STICK_DEADZONE_MIN);
+    return CL_MIN(radius * radius, STICK_DEADZONE_SQR);
+}
+
+// 摇杆噪声决定的最小内死区半径
+static float MinInnerDeadzone(const CaliParams_t *params, ShapeInput_t in)
+{
+    float deadzoneSqr = 0;
+    if (in == ShapeIn_LeftStick)
+        deadzoneSqr = CalcDeadzoneSqr(params->leftSigma, params->leftMag, CL_ARRAY_LENGTH(params->leftMag));
+    else if (in == ShapeIn_RightStick)
+        deadzoneSqr = CalcDeadzoneSqr(params->rightSigma, params->rightMag, CL_ARRAY_LENGTH(params->rightMag));
+
+    return sqrtf(deadzoneSqr);
+}
+
+static void BuildShape(ShapeInput_t in)
+{
+    Shape_Build(in, &caliParams.shape[in], MinInnerDeadzone(&caliParams, in));
+}
+
+static void UpdateShape(void)
+{
+    uint32_t start = GetUsTime();
+    for (int i = 0; i < ShapeIn_Max; i++)
+        BuildShape((ShapeInput_t)i);
+    CL_LOG_INFO("shape built in %u us", UsTimeSpan(start));
+}
+
+static void ApplyRapidTrig(RapidTrigIdx_t idx)
+{
+    uint16_t min = idx == RapidTrig_Left ? caliParams.leftTrigger[0] : caliParams.rightTrigger[0];
+    RapidTrig_Config(idx, &caliParams.rapidTrigger[idx], min);
+}
+
+// 校准结束提示: 两次短震
+static const HapticsEffect_t caliDoneEffect = {
+    .level = 160, .pulses = 2, .attack = 0, .sustain = 60, .decay = 20, .gap = 80};
 
 static void ToCaliNone(void)
 {
     SetPadLedStyle(PadLedStyle_On);
+    Haptics_Play(HapticsMotor_Left, &caliDoneEffect);
+    Haptics_Play(HapticsMotor_Right, &caliDoneEffect);
+    UpdateShape();
+    ApplyRapidTrig(RapidTrig_Left);
+    ApplyRapidTrig(RapidTrig_Right);
+    ButtonMap_Build(&caliParams.buttonMap);
+    DriftReset();
     caliStatus = CaliSta_None;
     CL_LOG_INFO("cali done");
     PrintParams(&caliParams);
 }
 
+// 中间值统计, Welford算法在线计算均值和方差
 typedef struct
 {
-    uint16_t leftX, leftY, rightX, rightY;
-    uint16_t leftHall, rightHall;
-} MidVal_t;
-CL_QUEUE_DEF_INIT(middleQueue, 20, MidVal_t, static);
+    uint32_t count;
+    float mean;
+    float m2; // 与均值之差的平方和
+} MidStat_t;
+static MidStat_t midStat[AdcChan_Max];
+static uint32_t midReadCount = 0; // 摇杆采样流的读计数
+static uint16_t midOutliers = 0;  // 连续离群的帧数
+
 static void ToCaliMiddle(void)
 {
     SetPadLedStyle(PadLedStyle_Breath);
-    CL_QueueClear(&middleQueue);
+    ProfileSwitchAbort();
+    memset(midStat, 0, sizeof(midStat));
+    midReadCount = AdcStream_Count(AdcStream_Stick);
+    midOutliers = 0;
     caliStatus = CaliSta_Middle;
+    caliStepTime = GetUsTime();
     CL_LOG_INFO("start cali middle");
 }
 
 static void ToCaliMargin(void)
 {
-    for (int i = 0; i < CL_ARRAY_LENGTH(caliParams.leftMag); i++)
-        caliParams.leftMag[i] = 0;
-
-    for (int i = 0; i < CL_ARRAY_LENGTH(caliParams.rightMag); i++)
-        caliParams.rightMag[i] = 0;
+    StickFit_Reset(&leftFit);
+    StickFit_Reset(&rightFit);
+    marginReadCount = AdcStream_Count(AdcStream_Stick);
+    // 线性校正基于边界归一化后的值, 边界变化后失效
+    for (int i = 0; i < StickLin_Max; i++)
+        StickLin_GetDefault(&caliParams.linear[i]);
 
     caliParams.leftTrigger[1] = 0;
     caliParams.rightTrigger[1] = 0;
 
     SetPadLedStyle(PadLedStyle_Blink);
     caliStatus = CaliSta_Margin;
-    CL_LOG_INFO("start cali margin");
+    CL_LOG_INFO("start cali margin, middle converged in %u ms", UsTimeSpan(caliStepTime) / 1000);
+    caliStepTime = GetUsTime();
+    marginCovered = false;
 }
 
 static bool OnBtnPairEvent(void *eventArg)
@@ -139,6 +358,17 @@ static bool OnBtnAEvent(void *eventArg)
     {
         if (caliStatus == CaliSta_Margin)
         {
+            // 求解拟合并生成边界表, 失败时保持在边界校准状态, 继续搓圈后再确认
+            uint16_t leftMag[CL_ARRAY_LENGTH(caliParams.leftMag)];
+            uint16_t rightMag[CL_ARRAY_LENGTH(caliParams.rightMag)];
+            if (StickFit_Solve(&leftFit, leftMag, CL_ARRAY_LENGTH(leftMag)) != CL_ResSuccess ||
+                StickFit_Solve(&rightFit, rightMag, CL_ARRAY_LENGTH(rightMag)) != CL_ResSuccess)
+            {
+                CL_LOG_INFO("margin fit failed, keep rotating sticks");
+                return true;
+            }
+            memcpy(caliParams.leftMag, leftMag, sizeof(leftMag));
+            memcpy(caliParams.rightMag, rightMag, sizeof(rightMag));
             SaveCalibration();
             ToCaliNone();
         }
@@ -153,7 +383,7 @@ static bool OnBtnYEvent(void *eventArg)
     {
         if (caliStatus == CaliSta_Margin)
         {
-            ResetParams();
+            ResetParams(&caliParams);
             SaveCalibration();
             ToCaliNone();
         }
@@ -161,158 +391,174 @@ static bool OnBtnYEvent(void *eventArg)
     return true;
 }
 
+static bool OnBtnUpEvent(void *eventArg)
+{
+    return OnProfileChord(0, eventArg);
+}
+
+static bool OnBtnRightEvent(void *eventArg)
+{
+    return OnProfileChord(1, eventArg);
+}
+
+static bool OnBtnDownEvent(void *eventArg)
+{
+    return OnProfileChord(2, eventArg);
+}
+
+static bool OnBtnLeftEvent(void *eventArg)
+{
+    return OnProfileChord(3, eventArg);
+}
+
 void Cali_Init(void)
 {
     SetPadLedStyle(PadLedStyle_On);
-    LoadCalibration();
+    FindProfileSelection(&activeProfile);
+    LoadCalibration(activeProfile, &caliParams);
+    UpdateShape();
+    ApplyRapidTrig(RapidTrig_Left);
+    ApplyRapidTrig(RapidTrig_Right);
+    ButtonMap_Build(&caliParams.buttonMap);
+    DriftReset();
     CL_EventSysAddListener(OnBtnPairEvent, CL_Event_Button, BtnIdx_Pair);
     CL_EventSysAddListener(OnBtnAEvent, CL_Event_Button, BtnIdx_A);
     CL_EventSysAddListener(OnBtnYEvent, CL_Event_Button, BtnIdx_Y);
+    CL_EventSysAddListener(OnBtnUpEvent, CL_Event_Button, BtnIdx_Up);
+    CL_EventSysAddListener(OnBtnRightEvent, CL_Event_Button, BtnIdx_Right);
+    CL_EventSysAddListener(OnBtnDownEvent, CL_Event_Button, BtnIdx_Down);
+    CL_EventSysAddListener(OnBtnLeftEvent, CL_Event_Button, BtnIdx_Left);
 }
 
-#define MID_MAX_DIFF (50)
-static void MiddleProc(void)
-{
-    // 摇杆和扳机值稳定后,记录下来作为摇杆的中间值,扳机的最小值
-    static uint32_t lastTime = 0;
-    if (SysTimeSpan(lastTime) >= 100)
-    {
-        lastTime = GetSysTime();
+#define MID_MIN_SAMPLES (400)  // 收敛所需最少帧数, 摇杆帧2kHz, 约200ms
+#define MID_MAX_SAMPLES (4000) // 超过仍未收敛则重新统计
+#define MID_MAX_DIFF (50)      // 采样偏离均值超过该值视为离群, 整帧不计入
+#define MID_MOVE_FRAMES (20)   // 连续离群达到该帧数(10ms)视为在动, 重新统计
+#define MID_MAX_SIGMA (8.0f)   // 收敛条件: 每个通道标准差上限
 
-        MidVal_t temp;
-        temp.leftX = GetAdcResult(AdcChan_LeftX);
-        temp.leftY = GetAdcResult(AdcChan_LeftY);
-        temp.rightX = GetAdcResult(AdcChan_RightX);
-        temp.rightY = GetAdcResult(AdcChan_RightY);
-        temp.leftHall = GetAdcResult(AdcChan_LeftHall);
-        temp.rightHall = GetAdcResult(AdcChan_RightHall);
+static uint16_t MidSigma(const MidStat_t *stat)
+{
+    float sigma = sqrtf(stat->m2 / (stat->count - 1));
+    return CL_MAX(1, (uint16_t)(sigma * CALI_SIGMA_SCALE + 0.5f)); // 0表示未知, 至少为1
+}
 
-        if (CL_QueueFull(&middleQueue))
-        {
-            CL_QueuePoll(&middleQueue, CL_NULL);
-        }
-        CL_QueueAdd(&middleQueue, &temp);
+// 累加一帧, 返回是否已收敛
+static bool MidAddFrame(const AdcSample_t *frame)
+{
+    float x[AdcChan_Max];
+    x[AdcChan_LeftX] = frame->value[0];
+    x[AdcChan_LeftY] = frame->value[1];
+    x[AdcChan_RightX] = frame->value[2];
+    x[AdcChan_RightY] = frame->value[3];
+    x[AdcChan_LeftHall] = GetAdcResult(AdcChan_LeftHall);
+    x[AdcChan_RightHall] = GetAdcResult(AdcChan_RightHall);
 
-        if (CL_QueueFull(&middleQueue))
+    // 单个尖峰只丢弃该帧, 连续偏离才认为摇杆在动
+    for (int chan = 0; chan < AdcChan_Max; chan++)
+    {
+        if (midStat[chan].count > 0 && fabsf(x[chan] - midStat[chan].mean) > MID_MAX_DIFF)
         {
-            MidVal_t min, max;
-            memset(&min, 0xff, sizeof(MidVal_t));
-            memset(&max, 0, sizeof(MidVal_t));
-
-            MidVal_t *pData;
-            CL_QUEUE_FOR_EACH(&middleQueue, pData, MidVal_t)
-            {
-                min.leftX = CL_MIN(min.leftX, pData->leftX);
-                min.leftY = CL_MIN(min.leftY, pData->leftY);
-                min.rightX = CL_MIN(min.rightX, pData->rightX);
-                min.rightY = CL_MIN(min.rightY, pData->rightY);
-                min.leftHall = CL_MIN(min.leftHall, pData->leftHall);
-                min.rightHall = CL_MIN(min.rightHall, pData->rightHall);
-
-                max.leftX = CL_MAX(max.leftX, pData->leftX);
-                max.leftY = CL_MAX(max.leftY, pData->leftY);
-                max.rightX = CL_MAX(max.rightX, pData->rightX);
-                max.rightY = CL_MAX(max.rightY, pData->rightY);
-                max.leftHall = CL_MAX(max.leftHall, pData->leftHall);
-                max.rightHall = CL_MAX(max.rightHall, pData->rightHall);
-            }
-
-            MidVal_t diff;
-            diff.leftX = max.leftX - min.leftX;
-            diff.leftY = max.leftY - min.leftY;
-            diff.rightX = max.rightX - min.rightX;
-            diff.rightY = max.rightY - min.rightY;
-            diff.leftHall = max.leftHall - min.leftHall;
-            diff.rightHall = max.rightHall - min.rightHall;
-
-            if (diff.leftX < MID_MAX_DIFF &&
-                diff.leftY < MID_MAX_DIFF &&
-                diff.rightX < MID_MAX_DIFF &&
-                diff.rightY < MID_MAX_DIFF &&
-                diff.leftHall < MID_MAX_DIFF &&
-                diff.rightHall < MID_MAX_DIFF)
+            if (++midOutliers >= MID_MOVE_FRAMES)
             {
-                caliParams.leftMidX = (min.leftX + max.leftX) / 2;
-                caliParams.leftMidY = (min.leftY + max.leftY) / 2;
-                caliParams.rightMidX = (min.rightX + max.rightX) / 2;
-                caliParams.rightMidY = (min.rightY + max.rightY) / 2;
-                caliParams.leftTrigger[0] = (min.leftHall + max.leftHall) / 2;
-                caliParams.rightTrigger[0] = (min.rightHall + max.rightHall) / 2;
-
-                CL_LOG_INFO("middle: %d, %d, %d, %d, %d, %d",
-                            caliParams.leftMidX,
-                            caliParams.leftMidY,
-                            caliParams.rightMidX,
-                            caliParams.rightMidY,
-                            caliParams.leftTrigger[0],
-                            caliParams.rightTrigger[0]);
-                ToCaliMargin();
+                memset(midStat, 0, sizeof(midStat));
+                midOutliers = 0;
             }
+            return false;
         }
     }
-}
-
-static void StickMarginProc(Vector2 *stick, bool left)
-{
-    const float magrinThreshold = 90000.0f;
+    midOutliers = 0;
 
-    uint16_t *mags;
-    uint8_t len = CL_ARRAY_LENGTH(caliParams.leftMag);
-    if (left)
+    bool stable = true;
+    for (int chan = 0; chan < AdcChan_Max; chan++)
     {
-        stick->x -= caliParams.leftMidX;
-        stick->y -= caliParams.leftMidY;
-        mags = caliParams.leftMag;
+        MidStat_t *stat = &midStat[chan];
+        float delta = x[chan] - stat->mean;
+        stat->count++;
+        stat->mean += delta / stat->count;
+        stat->m2 += delta * (x[chan] - stat->mean);
+
+        if (stat->count < MID_MIN_SAMPLES || stat->m2 > MID_MAX_SIGMA * MID_MAX_SIGMA * (stat->count - 1))
+            stable = false;
     }
-    else
+
+    if (!stable && midStat[0].count >= MID_MAX_SAMPLES)
+        memset(midStat, 0, sizeof(midStat));
+    return stable;
+}
+
+static void MiddleProc(void)
+{
+    // 摇杆和扳机静止时逐帧统计每个通道的均值和噪声, 作为摇杆的中间值,扳机的最小值
+    AdcSample_t frames[8];
+    uint32_t n;
+    bool stable = false;
+    while (!stable && (n = AdcStream_Read(AdcStream_Stick, &midReadCount, frames, CL_ARRAY_LENGTH(frames))) > 0)
     {
-        stick->x -= caliParams.rightMidX;
-        stick->y -= caliParams.rightMidY;
-        mags = caliParams.rightMag;
+        for (uint32_t i = 0; i < n && !stable; i++)
+            stable = MidAddFrame(&frames[i]);
     }
+    if (!stable)
+        return;
 
-    float sqrMag = Vector2_SqrMagnitude(stick);
-    if (sqrMag > magrinThreshold)
-    {
-        float rad = GetRadian(stick);
-        rad /= (M_PI * 2 / len);
-        int pos = roundf(rad);
-        if (FLOAT_NEAR(rad, pos, 0.1f))
-        {
-            pos %= len;
+    caliParams.leftMidX = midStat[AdcChan_LeftX].mean + 0.5f;
+    caliParams.leftMidY = midStat[AdcChan_LeftY].mean + 0.5f;
+    caliParams.rightMidX = midStat[AdcChan_RightX].mean + 0.5f;
+    caliParams.rightMidY = midStat[AdcChan_RightY].mean + 0.5f;
+    caliParams.leftTrigger[0] = midStat[AdcChan_LeftHall].mean + 0.5f;
+    caliParams.rightTrigger[0] = midStat[AdcChan_RightHall].mean + 0.5f;
+    caliParams.leftSigma[0] = MidSigma(&midStat[AdcChan_LeftX]);
+    caliParams.leftSigma[1] = MidSigma(&midStat[AdcChan_LeftY]);
+    caliParams.rightSigma[0] = MidSigma(&midStat[AdcChan_RightX]);
+    caliParams.rightSigma[1] = MidSigma(&midStat[AdcChan_RightY]);
+    memset(caliParams.leftDrift, 0, sizeof(caliParams.leftDrift));
+    memset(caliParams.rightDrift, 0, sizeof(caliParams.rightDrift));
 
-            if (sqrMag > mags[pos] * mags[pos])
-                mags[pos] = sqrtf(sqrMag);
-        }
-    }
+    CL_LOG_INFO("middle: %d, %d, %d, %d, %d, %d",
+                caliParams.leftMidX,
+                caliParams.leftMidY,
+                caliParams.rightMidX,
+                caliParams.rightMidY,
+                caliParams.leftTrigger[0],
+                caliParams.rightTrigger[0]);
+    CL_LOG_INFO("middle sigma: %d, %d, %d, %d (1/%d), %u samples",
+                caliParams.leftSigma[0],
+                caliParams.leftSigma[1],
+                caliParams.rightSigma[0],
+                caliParams.rightSigma[1],
+                CALI_SIGMA_SCALE,
+                midStat[0].count);
+    ToCaliMargin();
 }
 
 static void MarginProc(void)
 {
-    // 摇杆记录60个角度的向量长度
-    Vector2 leftStick;
-    leftStick.x = GetAdcResult(AdcChan_LeftX);
-    leftStick.y = GetAdcResult(AdcChan_LeftY);
-    StickMarginProc(&leftStick, true);
-
-    Vector2 rightStick;
-    rightStick.x = GetAdcResult(AdcChan_RightX);
-    rightStick.y = GetAdcResult(AdcChan_RightY);
-    StickMarginProc(&rightStick, false);
+    // 逐帧处理摇杆采样流(2kHz), 任务1ms一次, 通常2帧; 每帧两个摇杆各累加一次
+    // 没有新帧时直接返回, 每次最多处理一个流缓冲的帧, 耗时有上限
+    AdcSample_t frames[8];
+    uint32_t n;
+    bool added = false;
+    while ((n = AdcStream_Read(AdcStream_Stick, &marginReadCount, frames, CL_ARRAY_LENGTH(frames))) > 0)
+    {
+        // 摇杆边界: 累加最小二乘拟合的矩, 按A确认时求解
+        for (uint32_t i = 0; i < n; i++)
+        {
+            StickFit_Add(&leftFit,
+                         (float)frames[i].value[0] - caliParams.leftMidX,
+                         (float)frames[i].value[1] - caliParams.leftMidY);
+            StickFit_Add(&rightFit,
+                         (float)frames[i].value[2] - caliParams.rightMidX,
+                         (float)frames[i].value[3] - caliParams.rightMidY);
+        }
+        added = true;
+    }
+    if (!added)
+        return;
 
     // 记录扳机的最大值
     caliParams.leftTrigger[1] = CL_MAX(caliParams.leftTrigger[1], GetAdcResult(AdcChan_LeftHall));
     caliParams.rightTrigger[1] = CL_MAX(caliParams.rightTrigger[1], GetAdcResult(AdcChan_RightHall));
 
-    bool allFound = true;
-    for (int i = 0; i < CL_ARRAY_LENGTH(caliParams.leftMag); i++)
-    {
-        if (caliParams.leftMag[i] == 0 || caliParams.rightMag[i] == 0)
-        {
-            allFound = false;
-            break;
-        }
-    }
+    bool allFound = StickFit_IsCovered(&leftFit) && StickFit_IsCovered(&rightFit);
 
     if (caliParams.leftTrigger[1] < caliParams.leftTrigger[0] + 500)
         allFound = false;
@@ -320,16 +566,146 @@ static void MarginProc(void)
         allFound = false;
 
     if (allFound)
-    { // 每个点都至少采集到数据了,设置为呼吸灯效果
+    { // 每个扇区都采集到足够数据了,设置为呼吸灯效果
         SetPadLedStyle(PadLedStyle_Breath);
+        if (!marginCovered)
+        {
+            marginCovered = true;
+            CL_LOG_INFO("margin covered in %u ms", UsTimeSpan(caliStepTime) / 1000);
+        }
     }
 }
 
+//**************中心漂移补偿****************
+// 摇杆静止(无按键, 靠近中心, 窗口内方差小)时, 把窗口均值与当前中心的偏差
+// 按比例累加到漂移补偿上, 补偿值有上限, 只在RAM中更新, 偏差较大时才低频写flash
+#define DRIFT_SAMPLE_INTERVAL USTIME_MS(10) // 用自己的时间戳计时, 校准任务其他部分仍每1ms运行
+#define DRIFT_WINDOW (32)           // 窗口采样数, 约320ms
+#define DRIFT_REST_RADIUS (120)     // 静止判定: 与当前中心的最大距离, ADC值
+#define DRIFT_REST_VARIANCE (9)     // 静止判定: 窗口内方差上限, ADC值平方
+#define DRIFT_MAX (150)             // 补偿上限, ADC值
+#define DRIFT_GAIN_SHIFT (3)        // 每个静止窗口修正剩余偏差的1/8
+#define DRIFT_SAVE_DIFF (8)         // 与已保存值相差超过该值才考虑保存
+#define DRIFT_SAVE_INTERVAL USTIME_SECOND(600ull)
+
+typedef struct
+{
+    int32_t sumX, sumY;
+    uint32_t sumXX, sumYY;
+    uint8_t count;
+} DriftWindow_t;
+
+static DriftWindow_t driftWindow[2]; // 0:左 1:右
+static int16_t savedDrift[4];        // 最近一次写入flash的补偿值
+static uint64_t driftSaveTime = 0;
+static uint32_t driftSampleTime = 0; // 上次采样时间
+
+static int16_t DriftStep(int32_t offset)
+{
+    int32_t step = offset / (1 << DRIFT_GAIN_SHIFT);
+    if (step == 0 && offset != 0)
+        step = offset > 0 ? 1 : -1;
+    return step;
+}
+
+static void DriftSample(DriftWindow_t *win, int16_t drift[2], uint16_t midX, uint16_t midY,
+                        AdcChannel_t chanX, AdcChannel_t chanY, bool busy)
+{
+    int32_t x = (int32_t)GetAdcResult(chanX) - (midX + drift[0]);
+    int32_t y = (int32_t)GetAdcResult(chanY) - (midY + drift[1]);
+    if (busy || x * x + y * y > DRIFT_REST_RADIUS * DRIFT_REST_RADIUS)
+    { // 正在操作, 重新开始窗口
+        memset(win, 0, sizeof(DriftWindow_t));
+        return;
+    }
+
+    win->sumX += x;
+    win->sumY += y;
+    win->sumXX += x * x;
+    win->sumYY += y * y;
+    if (++win->count < DRIFT_WINDOW)
+        return;
+
+    int32_t meanX = win->sumX / DRIFT_WINDOW;
+    int32_t meanY = win->sumY / DRIFT_WINDOW;
+    int32_t varX = (int32_t)(win->sumXX / DRIFT_WINDOW) - meanX * meanX;
+    int32_t varY = (int32_t)(win->sumYY / DRIFT_WINDOW) - meanY * meanY;
+    memset(win, 0, sizeof(DriftWindow_t));
+
+    if (varX > DRIFT_REST_VARIANCE || varY > DRIFT_REST_VARIANCE)
+        return;
+
+    drift[0] = CL_CLAMP(drift[0] + DriftStep(meanX), -DRIFT_MAX, DRIFT_MAX);
+    drift[1] = CL_CLAMP(drift[1] + DriftStep(meanY), -DRIFT_MAX, DRIFT_MAX);
+}
+
+static void DriftSaveIfNeeded(void)
+{
+    const int16_t *drift[4] = {&caliParams.leftDrift[0], &caliParams.leftDrift[1],
+                               &caliParams.rightDrift[0], &caliParams.rightDrift[1]};
+    bool changed = false;
+    for (int i = 0; i < CL_ARRAY_LENGTH(savedDrift); i++)
+    {
+        if (abs(*drift[i] - savedDrift[i]) >= DRIFT_SAVE_DIFF)
+            changed = true;
+    }
+
+    if (!changed || GetUsTime64() - driftSaveTime < DRIFT_SAVE_INTERVAL)
+        return;
+
+    // 擦写flash期间CPU停顿, 只在静止时执行, 且间隔足够长
+    for (int i = 0; i < CL_ARRAY_LENGTH(savedDrift); i++)
+        savedDrift[i] = *drift[i];
+    driftSaveTime = GetUsTime64();
+    SaveCalibration();
+    CL_LOG_INFO("drift saved: %d, %d, %d, %d", savedDrift[0], savedDrift[1], savedDrift[2], savedDrift[3]);
+}
+
+static void DriftProc(void)
+{
+    if (UsTimeSpan(driftSampleTime) < DRIFT_SAMPLE_INTERVAL)
+        return;
+    driftSampleTime = GetUsTime();
+
+    bool busy = PadFunc_IsAnyButtonPressed();
+    DriftSample(&driftWindow[0], caliParams.leftDrift, caliParams.leftMidX, caliParams.leftMidY,
+                AdcChan_LeftX, AdcChan_LeftY, busy);
+    DriftSample(&driftWindow[1], caliParams.rightDrift, caliParams.rightMidX, caliParams.rightMidY,
+                AdcChan_RightX, AdcChan_RightY, busy);
+
+    if (!busy && driftWindow[0].count > 0 && driftWindow[1].count > 0)
+        DriftSaveIfNeeded();
+}
+
+static void DriftReset(void)
+{
+    memset(driftWindow, 0, sizeof(driftWindow));
+    savedDrift[0] = caliParams.leftDrift[0];
+    savedDrift[1] = caliParams.leftDrift[1];
+    savedDrift[2] = caliParams.rightDrift[0];
+    savedDrift[3] = caliParams.rightDrift[1];
+    driftSaveTime = GetUsTime64();
+    driftSampleTime = GetUsTime();
+}
+
 void Cali_Process(void)
 {
+    PROFILE_BEGIN(CaliProcess);
     switch (caliStatus)
     {
     case CaliSta_None:
+        if (Cali_IsProfileSwitching())
+        { // 切换档案期间每1ms生成一段查找表, 暂停漂移补偿, 完成后按新档案重新开始
+            ProfileSwitchProc();
+            break;
+        }
+        if (Cali_IsLinCapturing())
+        { // 引导采样每1ms一次, 约64ms完成; 摇杆不在中心, 暂停漂移补偿
+            LinCaptureProc();
+            break;
+        }
+        DriftProc();
+        ParamSaveIfNeeded();
         break;
     case CaliSta_Middle:
         MiddleProc();
@@ -338,6 +714,7 @@ void Cali_Process(void)
         MarginProc();
         break;
     }
+    PROFILE_END(CaliProcess);
 }
 
 CaliStatus_t GetCaliStatus(void)
@@ -347,7 +724,10 @@ CaliStatus_t GetCaliStatus(void)
 
 static float GetRadian(const Vector2 *v)
 {
-    float cos = v->y / Vector2_Magnitude(v);
+    float mag = Vector2_Magnitude(v);
+    if (mag == 0)
+        return 0; // 正好在中心, 避免NaN转换为下标
+    float cos = v->y / mag;
     cos = CL_CLAMP(cos, -1.0, 1.0f);
     float rad = acosf(cos);
     // rad = CL_CLAMP(rad, 0, M_PI);
@@ -358,21 +738,22 @@ static float GetRadian(const Vector2 *v)
     return rad;
 }
 
-void StickCorrect(Vector2 *stick, bool left)
+// 减去中心点, 按边界长度归一化, 推到边界时长度为1
+static void StickNormalize(Vector2 *stick, bool left)
 {
     uint16_t *caliMags;
     uint8_t len = CL_ARRAY_LENGTH(caliParams.leftMag); // 边界值数组长度
     // 减去中心点值,获取不同角度的边界值数组
     if (left)
     {
-        stick->x -= caliParams.leftMidX;
-        stick->y -= caliParams.leftMidY;
+        stick->x -= caliParams.leftMidX + caliParams.leftDrift[0];
+        stick->y -= caliParams.leftMidY + caliParams.leftDrift[1];
         caliMags = caliParams.leftMag;
     }
     else
     {
-        stick->x -= caliParams.rightMidX;
-        stick->y -= caliParams.rightMidY;
+        stick->x -= caliParams.rightMidX + caliParams.rightDrift[0];
+        stick->y -= caliParams.rightMidY + caliParams.rightDrift[1];
         caliMags = caliParams.rightMag;
     }
 
@@ -401,23 +782,288 @@ void StickCorrect(Vector2 *stick, bool left)
 
     stick->x = stick->x / mag; // 计算x轴的值
     stick->y = stick->y / mag; // 计算y轴的值
-    if ((stick->x * stick->x + stick->y * stick->y) < 0.007f)
-    { // 死区
-        stick->x = 0;
-        stick->y = 0;
+
+    // float cos = Vector2_Cos(&vecOld, stick); // for test
+    // if (cos < 0.939f)
+    // {
+    //     SetPadLedStyle(PadLedStyle_Off);
+    // }
+}
+
+void StickCorrect(Vector2 *stick, bool left)
+{
+    StickNormalize(stick, left);
+    // 交叉耦合和线性校正
+    StickLin_Apply(&caliParams.linear[left ? StickLin_Left : StickLin_Right], stick);
+    // 死区和响应曲线, 换算成USB协议值
+    Shape_Stick(left ? ShapeIn_LeftStick : ShapeIn_RightStick, stick);
+}
+
+static bool paramSavePending = false;
+static uint32_t paramChangeTime = 0;
+
+CL_Result_t Cali_SetShape(ShapeInput_t in, const ShapeParams_t *params)
+{
+    if (in >= ShapeIn_Max || !Shape_IsValid(params))
+        return CL_ResFailed;
+    if (Cali_IsProfileSwitching())
+        return CL_ResBusy;
+
+    caliParams.shape[in] = *params;
+    BuildShape(in);
+    paramSavePending = true;
+    paramChangeTime = GetUsTime();
+    return CL_ResSuccess;
+}
+
+void Cali_ResetShape(ShapeInput_t in)
+{
+    ShapeParams_t params;
+    Shape_GetDefault(in, &params);
+    Cali_SetShape(in, &params);
+}
+
+CL_Result_t Cali_SetRapidTrig(RapidTrigIdx_t idx, const RapidTrigParams_t *params)
+{
+    if (idx >= RapidTrig_Max || !RapidTrig_IsValid(params))
+        return CL_ResFailed;
+    if (Cali_IsProfileSwitching())
+        return CL_ResBusy;
+
+    caliParams.rapidTrigger[idx] = *params;
+    ApplyRapidTrig(idx);
+    paramSavePending = true;
+    paramChangeTime = GetUsTime();
+    return CL_ResSuccess;
+}
+
+//**************线性校正引导采样****************
+#define LIN_CAPTURE_SAMPLES (64)
+
+static StickLinCapture_t linCaptures[StickLin_Max][STICK_LIN_MAX_CAPTURES];
+static uint8_t linCaptureCount[StickLin_Max];
+static int8_t linCapturing = -1; // 正在采集的摇杆, -1表示空闲
+static int16_t linTarget[2];
+static Vector2 linSum;
+static uint16_t linSamples;
+
+CL_Result_t Cali_LinCapture(StickLinIdx_t idx, int16_t targetX, int16_t targetY)
+{
+    if (idx >= StickLin_Max || caliStatus != CaliSta_None || linCapturing >= 0 ||
+        linCaptureCount[idx] >= STICK_LIN_MAX_CAPTURES)
+        return CL_ResFailed;
+    if (Cali_IsProfileSwitching())
+        return CL_ResBusy;
+
+    linTarget[0] = targetX;
+    linTarget[1] = targetY;
+    linSum.x = 0;
+    linSum.y = 0;
+    linSamples = 0;
+    linCapturing = idx;
+    return CL_ResSuccess;
+}
+
+bool Cali_IsLinCapturing(void)
+{
+    return linCapturing >= 0;
+}
+
+static void LinCaptureProc(void)
+{
+    bool left = linCapturing == StickLin_Left;
+    Vector2 stick;
+    stick.x = GetAdcResult(left ? AdcChan_LeftX : AdcChan_RightX);
+    stick.y = GetAdcResult(left ? AdcChan_LeftY : AdcChan_RightY);
+    StickNormalize(&stick, left);
+    linSum.x += stick.x;
+    linSum.y += stick.y;
+    if (++linSamples < LIN_CAPTURE_SAMPLES)
+        return;
+
+    StickLinCapture_t *capture = &linCaptures[linCapturing][linCaptureCount[linCapturing]++];
+    capture->target[0] = linTarget[0];
+    capture->target[1] = linTarget[1];
+    capture->measured[0] = lroundf(linSum.x * 1000 / LIN_CAPTURE_SAMPLES);
+    capture->measured[1] = lroundf(linSum.y * 1000 / LIN_CAPTURE_SAMPLES);
+    CL_LOG_INFO("lin capture %d: target %d, %d, measured %d, %d", linCapturing,
+                capture->target[0], capture->target[1], capture->measured[0], capture->measured[1]);
+    linCapturing = -1;
+}
+
+CL_Result_t Cali_LinSolve(StickLinIdx_t idx)
+{
+    StickLinParams_t params;
+    if (idx >= StickLin_Max || linCapturing >= 0)
+        return CL_ResFailed;
+    if (Cali_IsProfileSwitching())
+        return CL_ResBusy;
+    if (StickLin_Solve(linCaptures[idx], linCaptureCount[idx], &params) != CL_ResSuccess)
+    {
+        CL_LOG_INFO("lin %d solve failed, %d captures", idx, linCaptureCount[idx]);
+        return CL_ResFailed;
     }
-    else
+
+    caliParams.linear[idx] = params;
+    linCaptureCount[idx] = 0;
+    paramSavePending = true;
+    paramChangeTime = GetUsTime();
+    CL_LOG_INFO("lin %d: matrix %d %d %d %d", idx,
+                params.matrix[0][0], params.matrix[0][1], params.matrix[1][0], params.matrix[1][1]);
+    return CL_ResSuccess;
+}
+
+void Cali_LinReset(StickLinIdx_t idx)
+{
+    if (idx >= StickLin_Max || Cali_IsProfileSwitching())
+        return;
+
+    linCaptureCount[idx] = 0;
+    StickLin_GetDefault(&caliParams.linear[idx]);
+    paramSavePending = true;
+    paramChangeTime = GetUsTime();
+}
+
+static void ParamSaveIfNeeded(void)
+{
+    if (!paramSavePending || UsTimeSpan(paramChangeTime) < PARAM_SAVE_DELAY)
+        return;
+
+    paramSavePending = false;
+    SaveCalibration();
+    CL_LOG_INFO("params saved");
+}
+
+CL_Result_t Cali_SetButtonMap(const ButtonMapParams_t *params)
+{
+    if (!ButtonMap_IsValid(params))
+        return CL_ResFailed;
+    if (Cali_IsProfileSwitching())
+        return CL_ResBusy;
+
+    caliParams.buttonMap = *params;
+    ButtonMap_Build(&caliParams.buttonMap);
+    paramSavePending = true;
+    paramChangeTime = GetUsTime();
+    return CL_ResSuccess;
+}
+
+//**************配置档案切换****************
+// 每次调度只做一步: 保存当前档案未保存的修改, 读取新档案参数到暂存区, 在备用组中分段生成查找表
+// 全部完成后同一次调度内替换参数、切换查找表、更新快速触发和按键映射, 上报任务看到的始终是完整的一份
+#define PROFILE_STAGE_STEP (64) // 每1ms生成的查找表项数
+
+typedef enum
+{
+    ProfileStage_Save,  // 擦写flash, 与读取分开, 单次调度的停顿不叠加
+    ProfileStage_Load,
+    ProfileStage_Build,
+} ProfileStage_t;
+
+static CaliParams_t stagedParams;
+static int8_t stagingProfile = -1; // 正在切换到的档案, -1表示空闲
+static ProfileStage_t stagingStage;
+static uint8_t stagingInput;
+static uint32_t stagingStartTime;
+
+// 切换完成提示: 短震档案序号+1次
+static const HapticsEffect_t profileEffect = {
+    .level = 120, .pulses = 1, .attack = 0, .sustain = 40, .decay = 10, .gap = 80};
+
+uint8_t Cali_GetProfile(void)
+{
+    return activeProfile;
+}
+
+bool Cali_IsProfileSwitching(void)
+{
+    return stagingProfile >= 0;
+}
+
+static void StageShape(ShapeInput_t in)
+{
+    Shape_StageBegin(in, &stagedParams.shape[in], MinInnerDeadzone(&stagedParams, in));
+}
+
+CL_Result_t Cali_SelectProfile(uint8_t profile)
+{
+    if (profile >= PAD_PROFILE_COUNT || caliStatus != CaliSta_None || linCapturing >= 0)
+        return CL_ResFailed;
+    if (Cali_IsProfileSwitching())
+        return CL_ResBusy;
+    if (profile == activeProfile)
+        return CL_ResSuccess;
+
+    // 切换期间参数修改返回忙, 未保存的修改在校准任务中先写入当前档案
+    stagingProfile = profile;
+    stagingStage = ProfileStage_Save;
+    stagingStartTime = GetUsTime();
+    return CL_ResSuccess;
+}
+
+static void ProfileSwitchProc(void)
+{
+    if (stagingStage == ProfileStage_Save)
+    {
+        if (paramSavePending)
+        {
+            paramSavePending = false;
+            SaveCalibration();
+            CL_LOG_INFO("params saved before profile switch");
+        }
+        stagingStage = ProfileStage_Load;
+        return;
+    }
+    if (stagingStage == ProfileStage_Load)
+    {
+        LoadCalibration(stagingProfile, &stagedParams);
+        stagingInput = 0;
+        StageShape((ShapeInput_t)stagingInput);
+        stagingStage = ProfileStage_Build;
+        return;
+    }
+
+    if (!Shape_StageStep(PROFILE_STAGE_STEP))
+        return;
+    if (++stagingInput < ShapeIn_Max)
     {
-        stick->x = stick->x * 33000.0f;                     // 换算成USB协议值
-        stick->x = CL_CLAMP(stick->x, -32767.0f, 32767.0f); // x值范围限制
+        StageShape((ShapeInput_t)stagingInput);
+        return;
+    }
+
+    // 查找表已全部生成, 整体生效
+    caliParams = stagedParams;
+    Shape_StageCommit();
+    ApplyRapidTrig(RapidTrig_Left);
+    ApplyRapidTrig(RapidTrig_Right);
+    ButtonMap_Build(&caliParams.buttonMap);
+    DriftReset();
+    memset(linCaptureCount, 0, sizeof(linCaptureCount));
+    activeProfile = stagingProfile;
+    stagingProfile = -1;
+    CL_LOG_INFO("profile %d active, built in %u ms", activeProfile, UsTimeSpan(stagingStartTime) / 1000);
 
-        stick->y = stick->y * 33000.0f;                     // 换算成USB协议值
-        stick->y = CL_CLAMP(stick->y, -32767.0f, 32767.0f); // y值范围限制
+    SaveProfileSelection(activeProfile);
 
-        // float cos = Vector2_Cos(&vecOld, stick); // for test
-        // if (cos < 0.939f)
-        // {
-        //     SetPadLedStyle(PadLedStyle_Off);
-        // }
+    HapticsEffect_t effect = profileEffect;
+    effect.pulses = activeProfile + 1;
+    Haptics_Play(HapticsMotor_Right, &effect);
+}
+
+static void ProfileSwitchAbort(void)
+{ // 进入校准时放弃切换, 备用查找表不会生效
+    if (stagingProfile >= 0)
+        CL_LOG_INFO("profile %d switch aborted", stagingProfile);
+    stagingProfile = -1;
+}
+
+static bool OnProfileChord(uint8_t profile, void *eventArg)
+{ // 按住XBOX再按方向键, 切换档案
+    ButtonEvent_t *pEvt = (ButtonEvent_t *)eventArg;
+    if (pEvt[0] == ButtonEvent_Down && Button_IsPressed(BtnIdx_Xbox))
+    {
+        if (Cali_SelectProfile(profile) == CL_ResSuccess)
+            CL_LOG_INFO("select profile %d", profile);
     }
+    return true;
 }
@@ -2,6 +2,10 @@
 
 #include "cl_common.h"
 #include "vector2.h"
+#include "shape.h"
+#include "rapid_trigger.h"
+#include "stick_lin.h"
+#include "button_map.h"
 
 typedef enum
 {
@@ -10,11 +14,24 @@ typedef enum
     CaliSta_Margin, // 校准边界值
 } CaliStatus_t;
 
+#define CALI_PARAMS_VERSION (6)
+#define CALI_SIGMA_SCALE (16) // 保存的噪声标准差单位: 1/16 ADC值
+
+// 新增字段只能加在crc之前, 旧版本保存的数据缺少的字段使用默认值
 typedef struct
 {
     uint16_t leftMag[60], leftMidX, leftMidY;    // 30个角度长度; 中间值
     uint16_t rightMag[60], rightMidX, rightMidY; // 30个角度长度; 中间值
     uint16_t leftTrigger[2], rightTrigger[2];       // min,max
+    // ---- 以上为v0格式, 其后直接为crc ----
+    uint16_t version;
+    uint16_t size;                       // 含crc的总长度
+    int16_t leftDrift[2], rightDrift[2]; // v1: 中心漂移补偿x,y, 叠加在中间值上
+    uint16_t leftSigma[2], rightSigma[2]; // v2: 中心噪声标准差x,y, 0表示未知
+    ShapeParams_t shape[ShapeIn_Max];     // v3: 死区和响应曲线
+    RapidTrigParams_t rapidTrigger[RapidTrig_Max]; // v4: 扳机快速触发
+    StickLinParams_t linear[StickLin_Max];         // v5: 交叉耦合和线性校正, 边界校准后复位
+    ButtonMapParams_t buttonMap;                   // v6: 按键重映射
     uint32_t crc;
 } CaliParams_t;
 
@@ -25,7 +42,32 @@ const CaliParams_t *GetCaliParams(void);
 CaliStatus_t GetCaliStatus(void);
 void StickCorrect(Vector2 *stick, bool left);
 
+// 修改整形参数, 立即生效, 参数稳定一段时间后再写flash
+CL_Result_t Cali_SetShape(ShapeInput_t in, const ShapeParams_t *params);
+void Cali_ResetShape(ShapeInput_t in);
+CL_Result_t Cali_SetRapidTrig(RapidTrigIdx_t idx, const RapidTrigParams_t *params);
+
+// 线性校正引导采样: 主机提示用户把摇杆推到目标位置(1/1000满量程)并保持, 采集约64ms的平均值
+// 采集完所有点后求解, 成功后立即生效
+CL_Result_t Cali_LinCapture(StickLinIdx_t idx, int16_t targetX, int16_t targetY);
+bool Cali_IsLinCapturing(void);
+CL_Result_t Cali_LinSolve(StickLinIdx_t idx);
+void Cali_LinReset(StickLinIdx_t idx);
+
+CL_Result_t Cali_SetButtonMap(const ButtonMapParams_t *params);
+
+// 配置档案: 每个档案为一份完整的参数, 保存在各自的flash页, 修改参数只保存当前档案
+// 切换时在后台先保存当前档案未保存的修改, 再读取新档案并生成查找表, 完成后在一次任务调度内整体生效,
+// 上报不会用到新旧混合的参数
+// 切换期间修改参数的接口返回CL_ResBusy
+uint8_t Cali_GetProfile(void);
+bool Cali_IsProfileSwitching(void);
+CL_Result_t Cali_SelectProfile(uint8_t profile);
+
 // 校准流程
 // 1.长按pair键,进入校准中间值状态,led改为呼吸灯效果
 // 2.松开摇杆和扳机,过几秒后,自动记录中间值,并进入校准边界值黄台,led改为0.5s闪烁效果
 // 3,摇杆搓圈,按住扳机,过几秒后,按A结束校准,led改为常亮
+// 校准结果保存到当前档案
+
+// 切换档案: 按住XBOX键再按方向键, 上/右/下/左对应档案0~3, 切换完成后短震档案序号+1次
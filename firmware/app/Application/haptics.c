@@ -0,0 +1,215 @@
+#include "haptics.h"
+#include "main.h"
+#include "tim.h"
+
+typedef struct
+{
+    volatile uint32_t seq; // 奇数: 写入中
+    volatile uint8_t level[HapticsMotor_Max];
+} HapticsMailbox_t;
+
+// 效果队列: 任务写head, 中断写tail
+typedef struct
+{
+    HapticsEffect_t effect[HAPTICS_QUEUE_LEN];
+    volatile uint8_t head;
+    volatile uint8_t tail;
+} HapticsQueue_t;
+
+typedef struct
+{
+    uint8_t host;        // 主机直接强度
+    uint32_t effectTime; // 当前效果已播放时间, ms
+    uint16_t duty;       // 目标占空比
+    uint16_t out;        // 实际输出
+    uint16_t kick;       // 剩余加速时间, ms
+    uint16_t brake;      // 剩余断开时间, ms
+    uint16_t idle;       // 已停止输出时间, ms
+} HapticsMotorState_t;
+
+static HapticsMailbox_t mailbox = {0};
+static uint32_t appliedSeq = 0;
+static HapticsQueue_t queue[HapticsMotor_Max];
+static HapticsMotorState_t motorState[HapticsMotor_Max];
+static uint8_t tickDiv = 0;
+
+bool Haptics_EffectIsValid(const HapticsEffect_t *effect)
+{
+    return effect->pulses > 0 && (uint32_t)effect->attack + effect->sustain + effect->decay > 0 &&
+           Haptics_EffectLength(effect) <= 60000;
+}
+
+uint32_t Haptics_EffectLength(const HapticsEffect_t *effect)
+{
+    uint32_t pulse = (uint32_t)effect->attack + effect->sustain + effect->decay;
+    if (effect->pulses == 0)
+        return 0;
+    return pulse * effect->pulses + (uint32_t)effect->gap * (effect->pulses - 1);
+}
+
+uint8_t Haptics_EffectLevel(const HapticsEffect_t *effect, uint32_t t)
+{
+    uint32_t pulse = (uint32_t)effect->attack + effect->sustain + effect->decay;
+    uint32_t period = pulse + effect->gap;
+    if (period == 0 || t >= Haptics_EffectLength(effect))
+        return 0;
+
+    t %= period;
+    if (t < effect->attack)
+        return (t + 1) * effect->level / effect->attack; // 第1ms即有输出
+    t -= effect->attack;
+    if (t < effect->sustain)
+        return effect->level;
+    t -= effect->sustain;
+    if (t < effect->decay)
+        return (effect->decay - t) * effect->level / (effect->decay + 1); // 最后1ms不为满值
+    return 0; // 脉冲间隔
+}
+
+uint16_t Haptics_LevelToDuty(uint8_t level)
+{
+    if (level == 0)
+        return 0;
+    return HAPTICS_DUTY_MIN + (uint32_t)(HAPTICS_DUTY_FULL - HAPTICS_DUTY_MIN) * level / 255;
+}
+
+void Haptics_Init(void)
+{
+    // 与USB中断同优先级, 主机命令在USB中断返回后的下一个PWM周期内生效
+    NVIC_SetPriority(TIM3_IRQn, NVIC_EncodePriority(NVIC_GetPriorityGrouping(), 1, 0));
+    NVIC_EnableIRQ(TIM3_IRQn);
+    for (int i = 0; i < HapticsMotor_Max; i++)
+        motorState[i].idle = HAPTICS_SPIN_DOWN;
+    __HAL_TIM_ENABLE_IT(&htim3, TIM_IT_UPDATE);
+}
+
+void Haptics_Post(uint8_t left, uint8_t right)
+{
+    mailbox.seq++;
+    __DMB();
+    mailbox.level[HapticsMotor_Left] = left;
+    mailbox.level[HapticsMotor_Right] = right;
+    __DMB();
+    mailbox.seq++;
+}
+
+CL_Result_t Haptics_Play(HapticsMotor_t motor, const HapticsEffect_t *effect)
+{
+    HapticsQueue_t *q = &queue[motor];
+    if (!Haptics_EffectIsValid(effect))
+        return CL_ResFailed;
+
+    uint8_t head = q->head;
+    if ((uint8_t)(head - q->tail) >= HAPTICS_QUEUE_LEN)
+        return CL_ResBusy;
+
+    q->effect[head % HAPTICS_QUEUE_LEN] = *effect;
+    __DMB();
+    q->head = head + 1;
+    return CL_ResSuccess;
+}
+
+void Haptics_Stop(HapticsMotor_t motor)
+{
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    queue[motor].tail = queue[motor].head;
+    motorState[motor].effectTime = 0;
+    __set_PRIMASK(primask);
+}
+
+// 读取主机强度, 有更新返回true
+static bool ReadMailbox(void)
+{
+    uint32_t seq = mailbox.seq;
+    if (seq == appliedSeq)
+        return false;
+
+    __DMB();
+    uint8_t left = mailbox.level[HapticsMotor_Left];
+    uint8_t right = mailbox.level[HapticsMotor_Right];
+    __DMB();
+    if ((seq & 1) != 0 || seq != mailbox.seq)
+        return false; // 读到写了一半的数据, 不能在中断里等待生产者
+
+    appliedSeq = seq;
+    motorState[HapticsMotor_Left].host = left;
+    motorState[HapticsMotor_Right].host = right;
+    return true;
+}
+
+// 当前效果强度, advance为true时推进1ms
+static uint8_t EffectStep(HapticsMotor_t motor, bool advance)
+{
+    HapticsQueue_t *q = &queue[motor];
+    HapticsMotorState_t *m = &motorState[motor];
+
+    while (q->tail != q->head)
+    {
+        const HapticsEffect_t *effect = &q->effect[q->tail % HAPTICS_QUEUE_LEN];
+        if (m->effectTime < Haptics_EffectLength(effect))
+        {
+            uint8_t level = Haptics_EffectLevel(effect, m->effectTime);
+            if (advance)
+                m->effectTime++;
+            return level;
+        }
+        // 播放完毕, 下一个
+        q->tail++;
+        m->effectTime = 0;
+    }
+    return 0;
+}
+
+static uint16_t MotorStep(HapticsMotor_t motor, bool advance)
+{
+    HapticsMotorState_t *m = &motorState[motor];
+    uint8_t effectLevel = EffectStep(motor, advance);
+    uint16_t duty = Haptics_LevelToDuty(CL_MAX(m->host, effectLevel));
+
+    if (duty > 0 && m->out == 0 && m->brake == 0 && m->idle >= HAPTICS_SPIN_DOWN)
+        m->kick = HAPTICS_KICK_TIME * duty / HAPTICS_DUTY_FULL; // 已停转, 满占空比起转, 弱效果加速时间短
+    else if (duty == 0)
+        m->kick = 0;
+    else if (m->duty > duty + HAPTICS_BRAKE_DROP && m->brake == 0)
+    { // 大幅减弱, 没有反向驱动, 断开输出让电机尽快减速
+        m->brake = HAPTICS_BRAKE_TIME;
+        m->kick = 0;
+    }
+    m->duty = duty;
+
+    if (m->kick > 0)
+        m->out = HAPTICS_DUTY_FULL;
+    else if (m->brake > 0)
+        m->out = 0;
+    else
+        m->out = duty;
+
+    if (advance)
+    {
+        if (m->kick > 0)
+            m->kick--;
+        if (m->brake > 0)
+            m->brake--;
+        if (m->out == 0)
+            m->idle = CL_MIN(m->idle + 1, HAPTICS_SPIN_DOWN);
+        else
+            m->idle = 0;
+    }
+    return m->out;
+}
+
+void Haptics_OnPwmUpdate(void)
+{
+    bool advance = ++tickDiv >= HAPTICS_TICK_DIV;
+    if (advance)
+        tickDiv = 0;
+
+    // 主机强度变化立即处理, 不等1ms节拍
+    if (!ReadMailbox() && !advance)
+        return;
+
+    uint16_t left = MotorStep(HapticsMotor_Left, advance);
+    uint16_t right = MotorStep(HapticsMotor_Right, advance);
+    PwmSetMotorDuty(left, right);
+}
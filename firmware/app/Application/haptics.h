@@ -0,0 +1,55 @@
+#pragma once
+
+#include "cl_common.h"
+
+// 震动合成: TIM3更新中断(24kHz)中运行, 每24次推进1ms,
+// 电机输出 = max(主机直接强度, 效果队列当前包络), 强度0~255映射到全分辨率占空比
+// 起转时满占空比短暂加速, 大幅减弱时先断开输出再稳定到目标值
+//
+// 主机强度邮箱: USB OUT中断写入(单生产者), TIM3中断读取(单消费者)
+// 序号为奇数表示正在写入, 读取前后序号不一致时放弃本次读取, 下个PWM周期重试
+
+#define HAPTICS_TICK_DIV (24)    // TIM3更新次数/ms
+#define HAPTICS_QUEUE_LEN (4)    // 每个电机的效果队列长度
+#define HAPTICS_DUTY_FULL (1000) // TIM3周期计数
+#define HAPTICS_DUTY_MIN (250)   // 强度1对应的占空比, 低于此电机不转
+#define HAPTICS_KICK_TIME (20)   // ms, 起转满占空比时间
+#define HAPTICS_BRAKE_TIME (10)  // ms, 减弱时断开输出的时间
+#define HAPTICS_BRAKE_DROP (300) // 占空比下降超过此值时断开
+#define HAPTICS_SPIN_DOWN (60)   // ms, 停止输出超过此时间认为已停转, 再启动需要加速
+
+typedef enum
+{
+    HapticsMotor_Left,
+    HapticsMotor_Right,
+    HapticsMotor_Max,
+} HapticsMotor_t;
+
+// 单个效果: pulses个脉冲, 每个脉冲为 attack上升-sustain保持-decay下降, 脉冲间隔gap
+typedef struct
+{
+    uint8_t level;    // 峰值强度0~255
+    uint8_t pulses;   // 脉冲个数, 至少1
+    uint16_t attack;  // ms
+    uint16_t sustain; // ms
+    uint16_t decay;   // ms
+    uint16_t gap;     // ms
+} HapticsEffect_t;
+
+void Haptics_Init(void);
+
+// USB OUT中断中调用, 主机下发的原始强度0~255
+void Haptics_Post(uint8_t left, uint8_t right);
+
+// 任务中调用, 队列满或参数无效返回失败
+CL_Result_t Haptics_Play(HapticsMotor_t motor, const HapticsEffect_t *effect);
+void Haptics_Stop(HapticsMotor_t motor); // 清空效果队列
+
+// TIM3更新中断中调用
+void Haptics_OnPwmUpdate(void);
+
+// 包络计算, 不依赖硬件
+bool Haptics_EffectIsValid(const HapticsEffect_t *effect);
+uint32_t Haptics_EffectLength(const HapticsEffect_t *effect); // ms
+uint8_t Haptics_EffectLevel(const HapticsEffect_t *effect, uint32_t t); // t: ms, 超出长度返回0
+uint16_t Haptics_LevelToDuty(uint8_t level);
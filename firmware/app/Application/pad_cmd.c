@@ -0,0 +1,301 @@
+#include "pad_cmd.h"
+#include "main.h"
+#include "cl_log.h"
+#include "string.h"
+#include "flash_layout.h"
+#include "cali.h"
+#include "shape.h"
+#include "rapid_trigger.h"
+#include "haptics.h"
+
+static ShapeParams_t pendingShape[ShapeIn_Max];
+static volatile uint8_t pendingSet = 0;   // 待设置的输入, 按位
+static volatile uint8_t pendingReset = 0; // 待复位的输入, 按位
+static RapidTrigParams_t pendingRapidTrig[RapidTrig_Max];
+static volatile uint8_t pendingRapidTrigSet = 0; // 按位
+static HapticsEffect_t pendingEffect[HapticsMotor_Max];
+static volatile uint8_t pendingEffectSet = 0; // 按位
+
+// 线性校正命令, 每个摇杆缓存一条, 未执行完时新命令返回忙, 不覆盖
+typedef struct
+{
+    uint8_t cmd; // 0: 无
+    int16_t target[2];
+} PendingLin_t;
+static volatile PendingLin_t pendingLin[StickLin_Max];
+
+#define NO_PENDING_PROFILE (0xff)
+static volatile uint8_t pendingProfile = NO_PENDING_PROFILE;
+static ButtonMapParams_t pendingButtonMap;
+static volatile bool pendingButtonMapSet = false;
+
+int PadCmd_OnRead(uint16_t value, uint8_t *buff, uint16_t size)
+{
+    uint8_t cmd = value >> 8;
+    uint8_t arg = value & 0xff;
+    switch (cmd)
+    {
+    case PadCmd_GetShape:
+        if (arg >= ShapeIn_Max || size < sizeof(ShapeParams_t))
+            return -1;
+        memcpy(buff, &GetCaliParams()->shape[arg], sizeof(ShapeParams_t));
+        return sizeof(ShapeParams_t);
+    case PadCmd_GetRapidTrig:
+        if (arg >= RapidTrig_Max || size < sizeof(RapidTrigParams_t))
+            return -1;
+        memcpy(buff, &GetCaliParams()->rapidTrigger[arg], sizeof(RapidTrigParams_t));
+        return sizeof(RapidTrigParams_t);
+    case PadCmd_GetLin:
+        if (arg >= StickLin_Max || size < sizeof(StickLinParams_t))
+            return -1;
+        memcpy(buff, &GetCaliParams()->linear[arg], sizeof(StickLinParams_t));
+        return sizeof(StickLinParams_t);
+    case PadCmd_GetProfile:
+        if (size < 3)
+            return -1;
+        buff[0] = Cali_GetProfile();
+        buff[1] = PAD_PROFILE_COUNT;
+        buff[2] = Cali_IsProfileSwitching() || pendingProfile != NO_PENDING_PROFILE;
+        return 3;
+    case PadCmd_GetButtonMap:
+        if (size < sizeof(ButtonMapParams_t))
+            return -1;
+        memcpy(buff, &GetCaliParams()->buttonMap, sizeof(ButtonMapParams_t));
+        return sizeof(ButtonMapParams_t);
+    default:
+        return -1;
+    }
+}
+
+CL_Result_t PadCmd_OnWrite(uint16_t value, const uint8_t *data, uint16_t len)
+{
+    uint8_t cmd = value >> 8;
+    uint8_t arg = value & 0xff;
+    switch (cmd)
+    {
+    case PadCmd_SetShape:
+        if (arg >= ShapeIn_Max || len != sizeof(ShapeParams_t))
+            return CL_ResFailed;
+        if (!Shape_IsValid((const ShapeParams_t *)data))
+            return CL_ResFailed;
+        memcpy(&pendingShape[arg], data, sizeof(ShapeParams_t));
+        pendingSet |= 1 << arg;
+        pendingReset &= ~(1 << arg); // 以最后一条命令为准
+        return CL_ResSuccess;
+    case PadCmd_ResetShape:
+        if (arg >= ShapeIn_Max || len != 0)
+            return CL_ResFailed;
+        pendingReset |= 1 << arg;
+        pendingSet &= ~(1 << arg);
+        return CL_ResSuccess;
+    case PadCmd_SetRapidTrig:
+        if (arg >= RapidTrig_Max || len != sizeof(RapidTrigParams_t))
+            return CL_ResFailed;
+        if (!RapidTrig_IsValid((const RapidTrigParams_t *)data))
+            return CL_ResFailed;
+        memcpy(&pendingRapidTrig[arg], data, sizeof(RapidTrigParams_t));
+        pendingRapidTrigSet |= 1 << arg;
+        return CL_ResSuccess;
+    case PadCmd_PlayEffect:
+        if (arg >= HapticsMotor_Max || len != sizeof(HapticsEffect_t))
+            return CL_ResFailed;
+        if (!Haptics_EffectIsValid((const HapticsEffect_t *)data))
+            return CL_ResFailed;
+        memcpy(&pendingEffect[arg], data, sizeof(HapticsEffect_t));
+        pendingEffectSet |= 1 << arg;
+        return CL_ResSuccess;
+    case PadCmd_LinCapture:
+        if (arg >= StickLin_Max || len != sizeof(int16_t) * 2)
+            return CL_ResFailed;
+        if (pendingLin[arg].cmd != 0 || Cali_IsLinCapturing())
+            return CL_ResBusy;
+        memcpy((void *)pendingLin[arg].target, data, sizeof(int16_t) * 2);
+        pendingLin[arg].cmd = cmd;
+        return CL_ResSuccess;
+    case PadCmd_LinSolve:
+    case PadCmd_LinReset:
+        if (arg >= StickLin_Max || len != 0)
+            return CL_ResFailed;
+        if (pendingLin[arg].cmd != 0 || Cali_IsLinCapturing())
+            return CL_ResBusy;
+        pendingLin[arg].cmd = cmd;
+        return CL_ResSuccess;
+    case PadCmd_SelectProfile:
+        if (arg >= PAD_PROFILE_COUNT || len != 0)
+            return CL_ResFailed;
+        pendingProfile = arg;
+        return CL_ResSuccess;
+    case PadCmd_SetButtonMap:
+        if (len != sizeof(ButtonMapParams_t) || !ButtonMap_IsValid((const ButtonMapParams_t *)data))
+            return CL_ResFailed;
+        memcpy(&pendingButtonMap, data, sizeof(ButtonMapParams_t));
+        pendingButtonMapSet = true;
+        return CL_ResSuccess;
+    default:
+        return CL_ResFailed;
+    }
+}
+
+static void ProcessRapidTrig(void)
+{
+    for (int i = 0; i < RapidTrig_Max; i++)
+    {
+        RapidTrigParams_t params;
+        bool set = false;
+
+        __disable_irq();
+        if (pendingRapidTrigSet & (1 << i))
+        {
+            params = pendingRapidTrig[i];
+            pendingRapidTrigSet &= ~(1 << i);
+            set = true;
+        }
+        __enable_irq();
+
+        if (set && Cali_SetRapidTrig((RapidTrigIdx_t)i, &params) == CL_ResSuccess)
+            CL_LOG_INFO("rapid trigger %d set", i);
+    }
+}
+
+static void ProcessEffect(void)
+{
+    for (int i = 0; i < HapticsMotor_Max; i++)
+    {
+        HapticsEffect_t effect;
+        bool set = false;
+
+        __disable_irq();
+        if (pendingEffectSet & (1 << i))
+        {
+            effect = pendingEffect[i];
+            pendingEffectSet &= ~(1 << i);
+            set = true;
+        }
+        __enable_irq();
+
+        if (set && Haptics_Play((HapticsMotor_t)i, &effect) != CL_ResSuccess)
+            CL_LOG_INFO("effect queue %d full", i);
+    }
+}
+
+static void ProcessLin(void)
+{
+    for (int i = 0; i < StickLin_Max; i++)
+    {
+        PendingLin_t lin;
+
+        // 采集中其它摇杆的命令保持缓存, 采集完成后再执行
+        if (Cali_IsLinCapturing())
+            return;
+
+        __disable_irq();
+        lin = pendingLin[i];
+        pendingLin[i].cmd = 0;
+        __enable_irq();
+
+        StickLinIdx_t idx = (StickLinIdx_t)i;
+        switch (lin.cmd)
+        {
+        case PadCmd_LinCapture:
+            if (Cali_LinCapture(idx, lin.target[0], lin.target[1]) != CL_ResSuccess)
+                CL_LOG_INFO("lin %d capture rejected", i);
+            break;
+        case PadCmd_LinSolve:
+            Cali_LinSolve(idx);
+            break;
+        case PadCmd_LinReset:
+            Cali_LinReset(idx);
+            CL_LOG_INFO("lin %d reset", i);
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+static void ProcessButtonMap(void)
+{
+    ButtonMapParams_t params;
+
+    __disable_irq();
+    params = pendingButtonMap;
+    pendingButtonMapSet = false;
+    __enable_irq();
+
+    if (Cali_SetButtonMap(&params) == CL_ResSuccess)
+        CL_LOG_INFO("button map set");
+}
+
+static void ProcessProfile(void)
+{
+    uint8_t profile;
+
+    __disable_irq();
+    profile = pendingProfile;
+    pendingProfile = NO_PENDING_PROFILE;
+    __enable_irq();
+
+    if (Cali_SelectProfile(profile) == CL_ResSuccess)
+        CL_LOG_INFO("select profile %d", profile);
+    else
+        CL_LOG_INFO("select profile %d rejected", profile);
+}
+
+static void ProcessShape(void)
+{
+    for (int i = 0; i < ShapeIn_Max; i++)
+    {
+        ShapeParams_t params;
+        bool set = false, reset = false;
+
+        __disable_irq();
+        if (pendingSet & (1 << i))
+        {
+            params = pendingShape[i];
+            pendingSet &= ~(1 << i);
+            set = true;
+        }
+        if (pendingReset & (1 << i))
+        {
+            pendingReset &= ~(1 << i);
+            reset = true;
+        }
+        __enable_irq();
+
+        if (reset)
+        {
+            Cali_ResetShape((ShapeInput_t)i);
+            CL_LOG_INFO("shape %d reset", i);
+        }
+        else if (set)
+        {
+            if (Cali_SetShape((ShapeInput_t)i, &params) == CL_ResSuccess)
+                CL_LOG_INFO("shape %d set", i);
+        }
+    }
+}
+
+void PadCmd_Process(void)
+{
+    if (pendingEffectSet != 0)
+        ProcessEffect();
+
+    // 切换档案期间参数命令保持缓存, 切换完成后作用于新档案
+    if (Cali_IsProfileSwitching())
+        return;
+
+    if (pendingRapidTrigSet != 0)
+        ProcessRapidTrig();
+
+    ProcessLin();
+
+    if (pendingButtonMapSet)
+        ProcessButtonMap();
+
+    if (pendingSet != 0 || pendingReset != 0)
+        ProcessShape();
+
+    // 最后处理档案切换, 同一批的参数命令作用于原档案
+    if (pendingProfile != NO_PENDING_PROFILE)
+        ProcessProfile();
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "cl_common.h"
+
+// 配置命令通道: USB控制传输厂商请求, 接收者为接口0
+// bmRequest: 0xC1(读) / 0x41(写), bRequest: PAD_CMD_REQUEST
+// wValue: 高字节为命令, 低字节为参数(如ShapeInput_t), wIndex: 0
+// 写命令在USB中断中只缓存, 由PadCmd_Process在任务中执行
+// 线性校正命令每个摇杆缓存一条, 上一条未执行完或正在采集时返回忙(STALL), 主机稍后重试
+
+#define PAD_CMD_REQUEST (0x50)
+#define PAD_CMD_MAX_LEN (64)
+
+typedef enum
+{
+    PadCmd_GetShape = 0x01,   // 读, 参数: ShapeInput_t, 返回ShapeParams_t
+    PadCmd_SetShape = 0x02,   // 写, 参数: ShapeInput_t, 数据: ShapeParams_t
+    PadCmd_ResetShape = 0x03, // 写, 参数: ShapeInput_t, 无数据, 恢复默认值
+    PadCmd_GetRapidTrig = 0x04, // 读, 参数: RapidTrigIdx_t, 返回RapidTrigParams_t
+    PadCmd_SetRapidTrig = 0x05, // 写, 参数: RapidTrigIdx_t, 数据: RapidTrigParams_t
+    PadCmd_PlayEffect = 0x06,   // 写, 参数: HapticsMotor_t, 数据: HapticsEffect_t, 加入效果队列
+    PadCmd_LinCapture = 0x07,   // 写, 参数: StickLinIdx_t, 数据: int16 目标x, y(1/1000), 采集一个引导点
+    PadCmd_LinSolve = 0x08,     // 写, 参数: StickLinIdx_t, 无数据, 用已采集的点求解并生效
+    PadCmd_LinReset = 0x09,     // 写, 参数: StickLinIdx_t, 无数据, 恢复默认值
+    PadCmd_GetLin = 0x0A,       // 读, 参数: StickLinIdx_t, 返回StickLinParams_t
+    PadCmd_GetProfile = 0x0B,   // 读, 参数: 0, 返回u8 当前档案 + u8 档案数 + u8 是否切换中
+    PadCmd_SelectProfile = 0x0C, // 写, 参数: 档案序号, 无数据, 切换完成前其它参数命令暂缓执行
+    PadCmd_GetButtonMap = 0x0D, // 读, 参数: 0, 返回ButtonMapParams_t
+    PadCmd_SetButtonMap = 0x0E, // 写, 参数: 0, 数据: ButtonMapParams_t
+} PadCmd_t;
+
+// USB中断上下文调用, 返回数据长度, 失败返回-1
+int PadCmd_OnRead(uint16_t value, uint8_t *buff, uint16_t size);
+// USB中断上下文调用, 失败时主机收到STALL
+CL_Result_t PadCmd_OnWrite(uint16_t value, const uint8_t *data, uint16_t len);
+
+void PadCmd_Process(void);
@@ -2,16 +2,26 @@
 #include "main.h"
 #include "cl_log.h"
 #include "adc.h"
-#include "systime.h"
+#include "sched.h"
+#include "ustime.h"
 #include "cl_serialize.h"
 #include "tim.h"
 #include "led.h"
 #include "cali.h"
+#include "shape.h"
+#include "rapid_trigger.h"
+#include "button_map.h"
 #include "usb_device.h"
 #include "usbd_hid.h"
 #include "math.h"
 #include "board.h"
 #include "vector2.h"
+#include "profile.h"
+#include "trace.h"
+
+#if PAD_CAPTURE_ENABLE && !TRACE_ENABLE
+#error "PAD_CAPTURE_ENABLE requires TRACE_ENABLE"
+#endif
 
 static PadReport_t padReport = {
     .leftX = 0, // -32767 ~ 32767
@@ -27,8 +37,6 @@ static PadReport_t padReport = {
     .button[1] = 0,
 };
 
-uint8_t vibration[PadVbrtIdx_Max] = {0};
-
 void PadFunc_Init(void)
 {
     Cali_Init();
@@ -67,106 +75,98 @@ static inline bool IsButtonPressed(GPIO_TypeDef *port, uint32_t pin)
     return LL_GPIO_IsInputPinSet(port, pin);
 }
 
-static uint8_t HallAdcToHid(uint16_t adc, uint16_t min, uint16_t max)
-{ // uint8_t
-    if (adc < min)
+void PadFunc_Process(void)
+{ // 2ms周期任务, 端点忙时稍后重试
+    if (!USBD_UploadIdle(&hUsbDeviceFS))
     {
-        return 0;
+        Sched_DelayCurrent(PAD_REPORT_RETRY_TIME);
+        return;
     }
-    else if (adc < max)
-    { // 平方根插值
-        uint16_t total = max - min;
-        float ratio = (float)(adc - min) / total;
-        if (ratio < 0.025f)
-            return 0;
-
-        ratio = sqrtf(ratio);
-        return ratio * 255;
-    }
-    else
+
+    // button0
+    padReport.button[0] = 0;
+    for (int i = 0; i < 8; i++)
     {
-        return 255;
+        if (IsButtonPressed(btn0PinDef[i].port, btn0PinDef[i].pin))
+            padReport.button[0] |= 1 << i;
     }
-}
 
-void PadFunc_Process(void)
-{
-    static uint32_t lastTime = 0;
-    if (USBD_UploadIdle(&hUsbDeviceFS) && SysTimeSpan(lastTime) >= 2)
+    // button1
+    padReport.button[1] = 0;
+    for (int i = 0; i < 8; i++)
     {
-        lastTime = GetSysTime();
-
-        // button0
-        padReport.button[0] = 0;
-        for (int i = 0; i < 8; i++)
-        {
-            if (IsButtonPressed(btn0PinDef[i].port, btn0PinDef[i].pin))
-                padReport.button[0] |= 1 << i;
-        }
-
-        // button1
-        padReport.button[1] = 0;
-        for (int i = 0; i < 8; i++)
-        {
-            if (IsButtonPressed(btn1PinDef[i].port, btn1PinDef[i].pin))
-                padReport.button[1] |= 1 << i;
-        }
-
-        // CL_LOG_INFO("button: %02x, %02x", padReport.button[0], padReport.button[1]);
-
-        if (GetCaliStatus() == CaliSta_None)
-        {
-            const CaliParams_t *caliParams = GetCaliParams();
-            // sticks
-            Vector2 leftStick, rightStick;
-            leftStick.x = GetAdcResult(AdcChan_LeftX);
-            leftStick.y = GetAdcResult(AdcChan_LeftY);
-            StickCorrect(&leftStick, true);
-
-            padReport.leftX = leftStick.x;
-            padReport.leftY = leftStick.y;
-
-            rightStick.x = GetAdcResult(AdcChan_RightX);
-            rightStick.y = GetAdcResult(AdcChan_RightY);
-            StickCorrect(&rightStick, false);
-
-            padReport.rightX = rightStick.x;
-            padReport.rightY = rightStick.y;
-            // hall
-            padReport.leftTrigger = HallAdcToHid(GetAdcResult(AdcChan_LeftHall),
-                                                 caliParams->leftTrigger[0], caliParams->leftTrigger[1]);
-            padReport.rightTrigger = HallAdcToHid(GetAdcResult(AdcChan_RightHall),
-                                                  caliParams->rightTrigger[0], caliParams->rightTrigger[1]);
-        }
-        else
-        {
-            padReport.leftX = ((int16_t)GetAdcResult(AdcChan_LeftX) - 2048) / 2048.0f * 32768;
-            padReport.leftY = ((int16_t)GetAdcResult(AdcChan_LeftY) - 2048) / 2048.0f * 32768;
-            padReport.rightX = ((int16_t)GetAdcResult(AdcChan_RightX) - 2048) / 2048.0f * 32768;
-            padReport.rightY = ((int16_t)GetAdcResult(AdcChan_RightY) - 2048) / 2048.0f * 32768;
-            padReport.leftTrigger = GetAdcResult(AdcChan_LeftHall) / 16;
-            padReport.rightTrigger = GetAdcResult(AdcChan_RightHall) / 16;
-        }
-
-        USBD_SendPadReport(&hUsbDeviceFS, &padReport);
-
-        PwmSetDuty(PwmChan_MotorLeft, vibration[PadVbrtIdx_LeftBottom]);
-        PwmSetDuty(PwmChan_MotorRight, vibration[PadVbrtIdx_RightBottom]);
+        if (IsButtonPressed(btn1PinDef[i].port, btn1PinDef[i].pin))
+            padReport.button[1] |= 1 << i;
     }
 
-    Cali_Process();
-}
+    // CL_LOG_INFO("button: %02x, %02x", padReport.button[0], padReport.button[1]);
 
-void SetPadVibration(PadVbrtIdx_t idx, uint8_t vbrt)
-{
-    // 原始值0~255,不要超100
-    if (vbrt > 0)
+    // 同一帧使用同一组ADC值
+    uint16_t adc[6];
+    for (int i = 0; i < CL_ARRAY_LENGTH(adc); i++)
+        adc[i] = GetAdcResult((AdcChannel_t)i);
+
+#if PAD_CAPTURE_ENABLE
+    TRACE4("cap in: %08x %08x %08x %08x",
+           adc[AdcChan_RightHall] | (adc[AdcChan_RightX] << 16),
+           adc[AdcChan_RightY] | (adc[AdcChan_LeftHall] << 16),
+           adc[AdcChan_LeftX] | (adc[AdcChan_LeftY] << 16),
+           padReport.button[0] | (padReport.button[1] << 8));
+#endif
+
+    if (GetCaliStatus() == CaliSta_None)
     {
-        vbrt = CL_CLAMP(vbrt, 0, 250);
-        vibration[idx] = vbrt / 5 + 50;
+        const CaliParams_t *caliParams = GetCaliParams();
+        // sticks
+        Vector2 leftStick, rightStick;
+        leftStick.x = adc[AdcChan_LeftX];
+        leftStick.y = adc[AdcChan_LeftY];
+        PROFILE_RUN(StickCorrect, StickCorrect(&leftStick, true));
+
+        padReport.leftX = leftStick.x;
+        padReport.leftY = leftStick.y;
+
+        rightStick.x = adc[AdcChan_RightX];
+        rightStick.y = adc[AdcChan_RightY];
+        PROFILE_RUN(StickCorrect, StickCorrect(&rightStick, false));
+
+        padReport.rightX = rightStick.x;
+        padReport.rightY = rightStick.y;
+        // hall, 死区和响应曲线查表
+        PROFILE_RUN(HallAdcToHid,
+                    padReport.leftTrigger = Shape_Trigger(ShapeIn_LeftTrigger, adc[AdcChan_LeftHall],
+                                                          caliParams->leftTrigger[0], caliParams->leftTrigger[1]));
+        PROFILE_RUN(HallAdcToHid,
+                    padReport.rightTrigger = Shape_Trigger(ShapeIn_RightTrigger, adc[AdcChan_RightHall],
+                                                           caliParams->rightTrigger[0], caliParams->rightTrigger[1]));
+        // 当前档案的按键重映射, 扳机快速触发的按键已是上报位, 不参与重映射
+        uint16_t buttons = ButtonMap_Apply(padReport.button[0] | (padReport.button[1] << 8));
+        // 扳机快速触发映射的按键, 在ADC中断中判定
+        buttons |= RapidTrig_GetButtons();
+        padReport.button[0] = buttons & 0xff;
+        padReport.button[1] = buttons >> 8;
     }
     else
     {
-        vibration[idx] = 0;
+        padReport.leftX = ((int16_t)adc[AdcChan_LeftX] - 2048) / 2048.0f * 32768;
+        padReport.leftY = ((int16_t)adc[AdcChan_LeftY] - 2048) / 2048.0f * 32768;
+        padReport.rightX = ((int16_t)adc[AdcChan_RightX] - 2048) / 2048.0f * 32768;
+        padReport.rightY = ((int16_t)adc[AdcChan_RightY] - 2048) / 2048.0f * 32768;
+        padReport.leftTrigger = adc[AdcChan_LeftHall] / 16;
+        padReport.rightTrigger = adc[AdcChan_RightHall] / 16;
     }
+
+#if PAD_CAPTURE_ENABLE
+    TRACE3("cap out: %08x %08x %08x",
+           (uint16_t)padReport.leftX | ((uint32_t)(uint16_t)padReport.leftY << 16),
+           (uint16_t)padReport.rightX | ((uint32_t)(uint16_t)padReport.rightY << 16),
+           padReport.leftTrigger | (padReport.rightTrigger << 8));
+#endif
+
+    USBD_SendPadReport(&hUsbDeviceFS, &padReport);
+}
+
+bool PadFunc_IsAnyButtonPressed(void)
+{
+    return padReport.button[0] != 0 || padReport.button[1] != 0;
 }
@@ -2,15 +2,17 @@
 
 #include "cl_common.h"
 
+#define PAD_REPORT_INTERVAL (2000)    // us
+#define PAD_REPORT_RETRY_TIME (250)   // us
+
+// 输入采集: 每次上报输出ADC/按键原始值和上报结果两条trace记录(48字节/2ms),
+// 串口需1Mbaud以上, 用trace_decode.py --csv导出; 需同时打开TRACE_ENABLE
+#ifndef PAD_CAPTURE_ENABLE
+#define PAD_CAPTURE_ENABLE (0)
+#endif
+
 void PadFunc_Init(void);
 void PadFunc_Process(void);
-
-typedef enum
-{
-    PadVbrtIdx_LeftBottom,
-    PadVbrtIdx_RightBottom,
-    PadVbrtIdx_Max,
-} PadVbrtIdx_t;
-void SetPadVibration(PadVbrtIdx_t idx, uint8_t vbrt);
+bool PadFunc_IsAnyButtonPressed(void); // 最近一次上报中是否有按键按下
 
 
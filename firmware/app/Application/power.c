@@ -0,0 +1,134 @@
+#include "power.h"
+#include "main.h"
+#include "adc.h"
+#include "tim.h"
+#include "usb_device.h"
+#include "usbd_core.h"
+#include "cl_log.h"
+
+extern PCD_HandleTypeDef hpcd_USB_FS;
+
+#define WAKE_BTN_EXTI_LINE (LL_EXTI_LINE_4) // XBOX键 PB4
+#define WAKE_EXTI_LINES (WAKE_BTN_EXTI_LINE | USB_WAKEUP_EXTI_LINE)
+
+#define REMOTE_WAKEUP_TIME (10) // ms, USB规范要求1~15ms
+
+static volatile bool usbSuspended = false;
+static volatile bool btnWakeup = false;
+static PowerStat_t powerStat = {0};
+
+void Power_Init(void)
+{
+    LL_GPIO_AF_SetEXTISource(LL_GPIO_AF_EXTI_PORTB, LL_GPIO_AF_EXTI_LINE4);
+    LL_EXTI_EnableRisingTrig_0_31(WAKE_EXTI_LINES);
+    LL_EXTI_DisableIT_0_31(WAKE_EXTI_LINES); // 仅在STOP期间打开
+
+    NVIC_SetPriority(EXTI4_IRQn, NVIC_EncodePriority(NVIC_GetPriorityGrouping(), 1, 0));
+    NVIC_EnableIRQ(EXTI4_IRQn);
+    NVIC_SetPriority(USBWakeUp_IRQn, NVIC_EncodePriority(NVIC_GetPriorityGrouping(), 1, 0));
+    NVIC_EnableIRQ(USBWakeUp_IRQn);
+}
+
+void Power_OnUsbSuspend(void)
+{
+    powerStat.suspendCount++;
+    // 枚举完成前的挂起(上电时总线空闲)不进入STOP
+    if (hUsbDeviceFS.dev_old_state == USBD_STATE_CONFIGURED)
+        usbSuspended = true;
+}
+
+void Power_OnUsbResume(void)
+{
+    usbSuspended = false;
+}
+
+void Power_OnUsbWakeup(void)
+{
+    LL_EXTI_ClearFlag_0_31(USB_WAKEUP_EXTI_LINE);
+    powerStat.usbWakeCount++;
+}
+
+void Power_OnWakeButton(void)
+{
+    LL_EXTI_ClearFlag_0_31(WAKE_BTN_EXTI_LINE);
+    powerStat.btnWakeCount++;
+    btnWakeup = true;
+}
+
+static void EnterStop(void)
+{
+    __disable_irq();
+    if (!usbSuspended)
+    { // 关中断前已恢复
+        __enable_irq();
+        return;
+    }
+
+    LL_EXTI_ClearFlag_0_31(WAKE_EXTI_LINES);
+    LL_EXTI_EnableIT_0_31(WAKE_EXTI_LINES);
+    powerStat.stopCount++;
+
+    HAL_SuspendTick();
+    // PRIMASK置位时挂起的中断仍可唤醒WFI, 唤醒后先恢复时钟再处理中断
+    HAL_PWR_EnterSTOPMode(PWR_LOWPOWERREGULATOR_ON, PWR_STOPENTRY_WFI);
+    SystemClock_Config(); // STOP唤醒后系统时钟为HSI
+    HAL_ResumeTick();
+
+    LL_EXTI_DisableIT_0_31(WAKE_EXTI_LINES);
+    __enable_irq();
+}
+
+static void RemoteWakeup(void)
+{
+    powerStat.remoteWakeCount++;
+
+    hpcd_USB_FS.Instance->CNTR &= (uint16_t) ~(USB_CNTR_LP_MODE | USB_CNTR_FSUSP);
+    HAL_PCD_ActivateRemoteWakeup(&hpcd_USB_FS);
+    HAL_Delay(REMOTE_WAKEUP_TIME);
+    HAL_PCD_DeActivateRemoteWakeup(&hpcd_USB_FS);
+
+    // 主机恢复总线时不一定产生WKUP中断, 直接恢复状态
+    USBD_LL_Resume(&hUsbDeviceFS);
+    usbSuspended = false;
+}
+
+void Power_Process(void)
+{
+    if (!usbSuspended)
+        return;
+
+    AdcStop();
+    PwmSuspend();
+
+    // 挂起期间不返回调度器, 其余任务无事可做
+    btnWakeup = false;
+    while (usbSuspended)
+    {
+        EnterStop();
+
+        if (btnWakeup)
+        {
+            btnWakeup = false;
+            if (usbSuspended && hUsbDeviceFS.dev_remote_wakeup)
+                RemoteWakeup();
+        }
+    }
+
+    PwmResume();
+    AdcResume();
+}
+
+const PowerStat_t *GetPowerStat(void)
+{
+    return &powerStat;
+}
+
+void Power_PrintStat(void)
+{
+    CL_LOG_INFO("power: suspend %u, stop %u, usb wake %u, btn wake %u, remote wake %u",
+                powerStat.suspendCount,
+                powerStat.stopCount,
+                powerStat.usbWakeCount,
+                powerStat.btnWakeCount,
+                powerStat.remoteWakeCount);
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "cl_common.h"
+
+typedef struct
+{
+    uint32_t suspendCount;    // USB挂起次数
+    uint32_t stopCount;       // 进入STOP模式次数
+    uint32_t usbWakeCount;    // 主机唤醒次数
+    uint32_t btnWakeCount;    // 按键唤醒次数
+    uint32_t remoteWakeCount; // 发出远程唤醒次数
+} PowerStat_t;
+
+void Power_Init(void);
+void Power_Process(void);
+
+// USB中断上下文调用
+void Power_OnUsbSuspend(void);
+void Power_OnUsbResume(void);
+
+// EXTI中断上下文调用
+void Power_OnUsbWakeup(void);
+void Power_OnWakeButton(void);
+
+const PowerStat_t *GetPowerStat(void);
+void Power_PrintStat(void);
+
+// USB挂起低功耗流程
+// 1.主机挂起总线, 关闭ADC/PWM, 进入STOP模式
+// 2.主机恢复总线(EXTI18) 或 按下XBOX键(EXTI4)唤醒, 重新配置时钟
+// 3.按键唤醒且主机允许时发出远程唤醒信号, 否则继续STOP
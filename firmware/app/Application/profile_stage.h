@@ -0,0 +1,9 @@
+#pragma once
+
+// 耗时统计阶段, 见profile.h
+#define PROFILE_STAGE_LIST(X) \
+    X(StickCorrect)           \
+    X(HallAdcToHid)           \
+    X(ReportSerialize)        \
+    X(CaliProcess)            \
+    X(ButtonProcess)
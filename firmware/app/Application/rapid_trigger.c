@@ -0,0 +1,106 @@
+#include "rapid_trigger.h"
+#include "main.h"
+#include "ustime.h"
+#include "trace.h"
+
+typedef struct
+{
+    RapidTrigParams_t params;
+    uint16_t restLevel; // 强制释放位置
+    uint16_t extremum;  // 释放时为局部最低点, 按下时为局部最高点
+    bool pressed;
+} RapidTrig_t;
+
+static RapidTrig_t rapidTrig[RapidTrig_Max];
+static volatile uint16_t rtButtons = 0; // 当前按下
+static volatile uint16_t rtLatched = 0; // 上次读取后出现过的按下
+
+void RapidTrig_GetDefault(RapidTrigIdx_t idx, RapidTrigParams_t *params)
+{
+    params->enable = 0;
+    params->buttonBit = idx == RapidTrig_Left ? 8 : 9; // LB, RB
+    params->pressDelta = 80;
+    params->releaseDelta = 80;
+    params->topDz = 60;
+}
+
+bool RapidTrig_IsValid(const RapidTrigParams_t *params)
+{
+    return (params->buttonBit < 16 || params->buttonBit == RAPID_TRIG_NO_BUTTON) &&
+           params->pressDelta > 0 && params->pressDelta < 4096 &&
+           params->releaseDelta > 0 && params->releaseDelta < 4096 &&
+           params->topDz < 4096;
+}
+
+void RapidTrig_Config(RapidTrigIdx_t idx, const RapidTrigParams_t *params, uint16_t min)
+{
+    RapidTrig_t *rt = &rapidTrig[idx];
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    rt->params = *params;
+    rt->restLevel = min + params->topDz;
+    rt->extremum = 0xffff;
+    rt->pressed = false;
+    if (params->buttonBit != RAPID_TRIG_NO_BUTTON)
+        rtButtons &= ~(1 << params->buttonBit);
+
+    __set_PRIMASK(primask);
+}
+
+static void RapidTrigUpdate(RapidTrigIdx_t idx, RapidTrig_t *rt, uint16_t adc)
+{
+    bool pressed = rt->pressed;
+    if (pressed)
+    {
+        if (adc > rt->extremum)
+            rt->extremum = adc;
+        else if (rt->extremum - adc >= rt->params.releaseDelta || adc <= rt->restLevel)
+            pressed = false;
+    }
+    else
+    {
+        if (adc < rt->extremum)
+            rt->extremum = adc;
+        else if (adc - rt->extremum >= rt->params.pressDelta && adc > rt->restLevel)
+            pressed = true;
+    }
+
+    if (pressed == rt->pressed)
+        return;
+
+    // 方向改变, 从当前点重新跟踪极值
+    rt->pressed = pressed;
+    rt->extremum = adc;
+    TRACE3("rt %d %d at %u us", idx, pressed, GetUsTime());
+
+    if (rt->params.buttonBit == RAPID_TRIG_NO_BUTTON)
+        return;
+    uint16_t mask = 1 << rt->params.buttonBit;
+    if (pressed)
+    {
+        rtButtons |= mask;
+        rtLatched |= mask;
+    }
+    else
+    {
+        rtButtons &= ~mask;
+    }
+}
+
+void RapidTrig_OnAdcFrame(uint16_t leftHall, uint16_t rightHall)
+{
+    if (rapidTrig[RapidTrig_Left].params.enable)
+        RapidTrigUpdate(RapidTrig_Left, &rapidTrig[RapidTrig_Left], leftHall);
+    if (rapidTrig[RapidTrig_Right].params.enable)
+        RapidTrigUpdate(RapidTrig_Right, &rapidTrig[RapidTrig_Right], rightHall);
+}
+
+uint16_t RapidTrig_GetButtons(void)
+{
+    __disable_irq();
+    uint16_t buttons = rtButtons | rtLatched;
+    rtLatched = 0;
+    __enable_irq();
+    return buttons;
+}
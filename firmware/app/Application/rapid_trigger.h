@@ -0,0 +1,38 @@
+#pragma once
+
+#include "cl_common.h"
+
+// 扳机快速触发: 跟踪行程方向, 从局部最高点下压pressDelta判定按下,
+// 从局部最低点回弹releaseDelta判定释放, 与行程中的绝对位置无关
+// 在ADC注入组中断中逐个采样运行(24kHz, 42us), 结果映射到上报按键位
+
+#define RAPID_TRIG_NO_BUTTON (0xff)
+
+typedef enum
+{
+    RapidTrig_Left,
+    RapidTrig_Right,
+    RapidTrig_Max,
+} RapidTrigIdx_t;
+
+typedef struct
+{
+    uint8_t enable;
+    uint8_t buttonBit;     // 上报按键位0~15, button[0]为0~7, button[1]为8~15
+    uint16_t pressDelta;   // 按下判定的下压量, ADC值
+    uint16_t releaseDelta; // 释放判定的回弹量, ADC值
+    uint16_t topDz;        // 回到 最小值+topDz 以内时强制释放, ADC值
+} RapidTrigParams_t;
+
+void RapidTrig_GetDefault(RapidTrigIdx_t idx, RapidTrigParams_t *params);
+bool RapidTrig_IsValid(const RapidTrigParams_t *params);
+
+// 任务中调用, min为扳机校准的最小值
+void RapidTrig_Config(RapidTrigIdx_t idx, const RapidTrigParams_t *params, uint16_t min);
+
+// ADC注入组中断中调用
+void RapidTrig_OnAdcFrame(uint16_t leftHall, uint16_t rightHall);
+
+// 返回需要置位的上报按键(button[1] << 8 | button[0]),
+// 上次读取后出现过的按下也会置位一次, 不会因上报间隔漏掉
+uint16_t RapidTrig_GetButtons(void);
@@ -0,0 +1,213 @@
+#include "shape.h"
+#include "cl_log.h"
+#include "math.h"
+
+#define SHAPE_STICK_MAX (32767)
+#define SHAPE_TRIGGER_MAX (255)
+
+// 两组表, 切换配置时在备用组中生成; 摇杆表多一项作为插值的右端点, 半径>=1时取最后一项
+// 摇杆表内死区以内的项填死区边缘的输出, 插值不会跨过内死区的跳变, 死区按stickInnerDz判断
+static uint16_t stickLut[2][2][SHAPE_STICK_LUT_SIZE + 1];
+static uint8_t triggerLut[2][2][SHAPE_TRIGGER_LUT_SIZE];
+static uint16_t stickAxialDz[2][2]; // 1/1000
+static float stickInnerDz[2][2];
+static uint8_t activeBank = 0;
+
+// 备用组的生成进度
+static struct
+{
+    ShapeInput_t in;
+    ShapeParams_t params;
+    float innerDz;
+    uint16_t pos;
+} stage;
+
+static const ShapeParams_t defaultStick = {
+    .innerDz = 0, // 使用噪声死区
+    .outerDz = 7, // 与原来的33000/32767缩放一致
+    .antiDz = 0,
+    .axialDz = 0,
+    .curve = ShapeCurve_Power,
+    .exponent = 10,
+    .point = {0, 64, 128, 191, 255},
+};
+
+static const ShapeParams_t defaultTrigger = {
+    .innerDz = 25, // 原来的2.5%死区
+    .outerDz = 0,
+    .antiDz = 0,
+    .axialDz = 0,
+    .curve = ShapeCurve_Power,
+    .exponent = 5, // 平方根
+    .point = {0, 64, 128, 191, 255},
+};
+
+void Shape_GetDefault(ShapeInput_t in, ShapeParams_t *params)
+{
+    if (in == ShapeIn_LeftStick || in == ShapeIn_RightStick)
+        *params = defaultStick;
+    else
+        *params = defaultTrigger;
+}
+
+bool Shape_IsValid(const ShapeParams_t *params)
+{
+    return params->innerDz + params->outerDz < 900 &&
+           params->antiDz < 1000 &&
+           params->axialDz < 500 &&
+           params->curve < ShapeCurve_Max &&
+           params->exponent >= 1 && params->exponent <= 50;
+}
+
+static float ShapeEval(const ShapeParams_t *params, float innerDz, float in)
+{
+    float outer = 1.0f - params->outerDz / 1000.0f;
+    if (in < innerDz)
+        return 0;
+    if (in >= outer)
+        return 1.0f;
+
+    float x = (in - innerDz) / (outer - innerDz);
+    float y;
+    if (params->curve == ShapeCurve_Points)
+    {
+        float pos = x * (SHAPE_POINT_COUNT - 1);
+        int i = CL_MIN((int)pos, SHAPE_POINT_COUNT - 2);
+        y = (params->point[i] + (pos - i) * (params->point[i + 1] - params->point[i])) / 255.0f;
+    }
+    else
+    {
+        y = powf(x, params->exponent / 10.0f);
+    }
+
+    float anti = params->antiDz / 1000.0f;
+    return anti + (1.0f - anti) * y;
+}
+
+static bool IsStick(ShapeInput_t in)
+{
+    return in == ShapeIn_LeftStick || in == ShapeIn_RightStick;
+}
+
+static float InnerDeadzone(ShapeInput_t in, const ShapeParams_t *params, float minInnerDz)
+{
+    float innerDz = params->innerDz / 1000.0f;
+    return IsStick(in) ? CL_MAX(innerDz, minInnerDz) : innerDz;
+}
+
+static uint16_t LutLength(ShapeInput_t in)
+{
+    return IsStick(in) ? SHAPE_STICK_LUT_SIZE + 1 : SHAPE_TRIGGER_LUT_SIZE;
+}
+
+// 生成[begin, end)范围内的表项
+static void BuildRange(uint8_t bank, ShapeInput_t in, const ShapeParams_t *params, float innerDz,
+                       uint16_t begin, uint16_t end)
+{
+    if (IsStick(in))
+    {
+        uint16_t *lut = stickLut[bank][in - ShapeIn_LeftStick];
+        for (int i = begin; i < end; i++)
+        {
+            float r = CL_MAX((float)i / SHAPE_STICK_LUT_SIZE, innerDz);
+            lut[i] = ShapeEval(params, innerDz, r) * SHAPE_STICK_MAX + 0.5f;
+        }
+    }
+    else if (in == ShapeIn_LeftTrigger || in == ShapeIn_RightTrigger)
+    {
+        // 行程不超过内死区时为0, 内死区为0时松开(第0项)也不输出反死区
+        uint8_t *lut = triggerLut[bank][in - ShapeIn_LeftTrigger];
+        for (int i = begin; i < end; i++)
+        {
+            float x = (float)i / SHAPE_TRIGGER_LUT_SIZE;
+            lut[i] = x <= innerDz ? 0 : ShapeEval(params, innerDz, x) * SHAPE_TRIGGER_MAX + 0.5f;
+        }
+    }
+}
+
+void Shape_Build(ShapeInput_t in, const ShapeParams_t *params, float minInnerDz)
+{
+    float innerDz = InnerDeadzone(in, params, minInnerDz);
+    BuildRange(activeBank, in, params, innerDz, 0, LutLength(in));
+    if (IsStick(in))
+    {
+        stickAxialDz[activeBank][in - ShapeIn_LeftStick] = params->axialDz;
+        stickInnerDz[activeBank][in - ShapeIn_LeftStick] = innerDz;
+    }
+}
+
+void Shape_StageBegin(ShapeInput_t in, const ShapeParams_t *params, float minInnerDz)
+{
+    stage.in = in;
+    stage.params = *params;
+    stage.innerDz = InnerDeadzone(in, params, minInnerDz);
+    stage.pos = 0;
+    if (IsStick(in))
+    {
+        stickAxialDz[activeBank ^ 1][in - ShapeIn_LeftStick] = params->axialDz;
+        stickInnerDz[activeBank ^ 1][in - ShapeIn_LeftStick] = stage.innerDz;
+    }
+}
+
+bool Shape_StageStep(uint16_t count)
+{
+    uint16_t len = LutLength(stage.in);
+    uint16_t end = CL_MIN(stage.pos + count, len);
+    BuildRange(activeBank ^ 1, stage.in, &stage.params, stage.innerDz, stage.pos, end);
+    stage.pos = end;
+    return stage.pos >= len;
+}
+
+void Shape_StageCommit(void)
+{
+    activeBank ^= 1;
+}
+
+void Shape_Stick(ShapeInput_t in, Vector2 *stick)
+{
+    int idx = in - ShapeIn_LeftStick;
+    uint8_t bank = activeBank;
+
+    float axialDz = stickAxialDz[bank][idx] / 1000.0f;
+    if (fabsf(stick->x) < axialDz)
+        stick->x = 0;
+    if (fabsf(stick->y) < axialDz)
+        stick->y = 0;
+
+    float r = sqrtf(stick->x * stick->x + stick->y * stick->y);
+    const uint16_t *lut = stickLut[bank][idx];
+    uint32_t out;
+    if (r >= 1.0f)
+    {
+        out = lut[SHAPE_STICK_LUT_SIZE];
+    }
+    else
+    { // 8位小数的定点位置, 插值只用整数运算
+        uint32_t pos = r * (SHAPE_STICK_LUT_SIZE << 8);
+        uint32_t i = pos >> 8;
+        out = (lut[i] * (256 - (pos & 0xff)) + lut[i + 1] * (pos & 0xff)) >> 8;
+    }
+    if (out == 0 || r <= 0 || r < stickInnerDz[bank][idx])
+    { // 死区
+        stick->x = 0;
+        stick->y = 0;
+        return;
+    }
+
+    // 保持方向, 半径替换为查表结果
+    float scale = out / r;
+    stick->x = CL_CLAMP(stick->x * scale, -32767.0f, 32767.0f);
+    stick->y = CL_CLAMP(stick->y * scale, -32767.0f, 32767.0f);
+}
+
+uint8_t Shape_Trigger(ShapeInput_t in, uint16_t adc, uint16_t min, uint16_t max)
+{
+    const uint8_t *lut = triggerLut[activeBank][in - ShapeIn_LeftTrigger];
+    if (adc <= min)
+        return lut[0];
+    if (adc >= max)
+        return SHAPE_TRIGGER_MAX;
+
+    uint32_t pos = (uint32_t)(adc - min) * SHAPE_TRIGGER_LUT_SIZE / (max - min);
+    return lut[pos];
+}
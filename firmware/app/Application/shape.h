@@ -0,0 +1,58 @@
+#pragma once
+
+#include "cl_common.h"
+#include "vector2.h"
+
+// 输入整形: 死区 + 响应曲线, 参数变化时编译成整数查找表, 上报时只查表
+// 摇杆: 先轴向死区, 再按半径查表(外死区/反死区/曲线), 相邻两项线性插值, 内死区单独比较
+// 扳机: 按行程比例查表
+// 参数中比例值单位均为1/1000满量程
+
+typedef enum
+{
+    ShapeIn_LeftStick,
+    ShapeIn_RightStick,
+    ShapeIn_LeftTrigger,
+    ShapeIn_RightTrigger,
+    ShapeIn_Max,
+} ShapeInput_t;
+
+typedef enum
+{
+    ShapeCurve_Power,  // out = in^(exponent/10), exponent=10为线性
+    ShapeCurve_Points, // 分段线性, 输入等分点处的输出值
+    ShapeCurve_Max,
+} ShapeCurve_t;
+
+#define SHAPE_POINT_COUNT (5)          // 输入0, 1/4, 1/2, 3/4, 1
+#define SHAPE_STICK_LUT_SIZE (512)     // 摇杆半径0~1, 表项间插值
+#define SHAPE_TRIGGER_LUT_SIZE (256)   // 扳机行程0~1
+
+typedef struct
+{
+    uint16_t innerDz; // 内死区, 摇杆取该值与噪声死区的较大值
+    uint16_t outerDz; // 外死区, 输入超过1-outerDz即满量程
+    uint16_t antiDz;  // 反死区, 离开内死区后的输出起点
+    uint16_t axialDz; // 轴向死区, 仅摇杆, 单轴小于该值时置0
+    uint8_t curve;    // ShapeCurve_t
+    uint8_t exponent; // ShapeCurve_Power指数, 1/10, 1~50
+    uint8_t point[SHAPE_POINT_COUNT]; // ShapeCurve_Points输出, 0~255
+    uint8_t reserved;
+} ShapeParams_t;
+
+void Shape_GetDefault(ShapeInput_t in, ShapeParams_t *params);
+bool Shape_IsValid(const ShapeParams_t *params);
+
+// 重新生成查找表, minInnerDz为摇杆噪声决定的最小内死区半径(0~1)
+void Shape_Build(ShapeInput_t in, const ShapeParams_t *params, float minInnerDz);
+
+// 切换配置: 查找表有两组, 在备用组中逐个输入分段生成, 全部完成后一次切换,
+// 上报始终使用完整的一组表; 生成期间不能调用Shape_Build
+void Shape_StageBegin(ShapeInput_t in, const ShapeParams_t *params, float minInnerDz);
+bool Shape_StageStep(uint16_t count); // 生成最多count项, 当前输入完成返回true
+void Shape_StageCommit(void);
+
+// stick为按边界归一化后的值(半径约0~1), 输出换算成USB协议值-32767~32767
+void Shape_Stick(ShapeInput_t in, Vector2 *stick);
+// 输出0~255
+uint8_t Shape_Trigger(ShapeInput_t in, uint16_t adc, uint16_t min, uint16_t max);
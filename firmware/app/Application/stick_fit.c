@@ -0,0 +1,185 @@
+#include "stick_fit.h"
+#include "string.h"
+#include "stdlib.h"
+#include "math.h"
+
+#define TAN_30 (0.57735f)
+#define TAN_60 (1.73205f)
+
+// 不用反三角函数, 比较斜率得到30度扇区
+static int GetSector(float x, float y)
+{
+    float ax = fabsf(x), ay = fabsf(y);
+    int sub = ay < ax * TAN_30 ? 0 : (ay < ax * TAN_60 ? 1 : 2);
+    if (x >= 0 && y >= 0)
+        return sub;
+    if (x < 0 && y >= 0)
+        return 5 - sub;
+    if (x < 0)
+        return 6 + sub;
+    return 11 - sub;
+}
+
+// 基函数: 0为常数, 2k-1为cos kθ, 2k为sin kθ
+static inline int BasisOrder(int i) { return (i + 1) / 2; }
+static inline bool BasisIsSin(int i) { return i != 0 && (i & 1) == 0; }
+
+static float SinMoment(const StickFit_t *fit, int j)
+{
+    return j >= 0 ? fit->sinSum[j] : -fit->sinSum[-j];
+}
+
+// Σφa*φb, 积化和差
+static float BasisProduct(const StickFit_t *fit, int a, int b)
+{
+    int ka = BasisOrder(a), kb = BasisOrder(b);
+    bool sa = BasisIsSin(a), sb = BasisIsSin(b);
+    int diff = ka - kb, sum = ka + kb;
+    if (!sa && !sb)
+        return (fit->cosSum[abs(diff)] + fit->cosSum[sum]) / 2;
+    if (sa && sb)
+        return (fit->cosSum[abs(diff)] - fit->cosSum[sum]) / 2;
+    if (!sa && sb) // cos ka * sin kb
+        return (fit->sinSum[sum] - SinMoment(fit, diff)) / 2;
+    return (fit->sinSum[sum] + SinMoment(fit, diff)) / 2; // sin ka * cos kb
+}
+
+void StickFit_Reset(StickFit_t *fit)
+{
+    memset(fit, 0, sizeof(StickFit_t));
+}
+
+void StickFit_Add(StickFit_t *fit, float x, float y)
+{
+    // 先用平方比较, 中心附近的采样不开方
+    float sqrMag = x * x + y * y;
+    float prevRadius = fit->lastRadius;
+    fit->sampleIndex++;
+    if (sqrMag < STICK_FIT_MIN_RADIUS * STICK_FIT_MIN_RADIUS)
+    {
+        fit->lastRadius = 0;
+        return;
+    }
+    float r = sqrtf(sqrMag);
+    fit->lastRadius = r;
+
+    int sector = GetSector(x, y);
+    float peak = CL_MIN(r, prevRadius);
+    if (peak > fit->envelope[sector])
+    {
+        if (peak > fit->envelope[sector] + STICK_FIT_MAX_STEP)
+            fit->envRiseAt[sector] = fit->sampleIndex;
+        fit->envelope[sector] = peak;
+    }
+    if (fit->sampleIndex - fit->envRiseAt[sector] < STICK_FIT_SETTLE)
+        return;
+    if (r < fit->envelope[sector] * STICK_FIT_ENV_RATIO || fabsf(r - prevRadius) > STICK_FIT_MAX_STEP)
+        return;
+    if (fit->sectorCount[sector] >= STICK_FIT_SECTOR_SAMPLES)
+        return;
+    if (++fit->sectorCount[sector] == STICK_FIT_SECTOR_MIN)
+        fit->coveredMask |= 1 << sector;
+
+    if (fit->cosSum[0] == 0)
+        fit->refRadius = r;
+    float d = r - fit->refRadius;
+
+    // cos jθ, sin jθ 递推
+    float invR = 1 / r;
+    float c1 = x * invR, s1 = y * invR;
+    float c = 1, s = 0;
+    fit->cosSum[0] += 1;
+    fit->rhs[0] += d;
+    for (int j = 1; j <= STICK_FIT_ORDER * 2; j++)
+    {
+        float cn = c * c1 - s * s1;
+        s = s * c1 + c * s1;
+        c = cn;
+        fit->cosSum[j] += c;
+        fit->sinSum[j] += s;
+        if (j <= STICK_FIT_ORDER)
+        {
+            fit->rhs[j * 2 - 1] += d * c;
+            fit->rhs[j * 2] += d * s;
+        }
+    }
+    fit->sqrSum += d * d;
+}
+
+bool StickFit_IsCovered(const StickFit_t *fit)
+{
+    return fit->coveredMask == (1 << STICK_FIT_SECTORS) - 1;
+}
+
+CL_Result_t StickFit_Solve(const StickFit_t *fit, uint16_t *mags, uint8_t len)
+{
+    if (!StickFit_IsCovered(fit))
+        return CL_ResFailed;
+
+    // 法方程 M*coef = rhs, 列主元高斯消元
+    float m[STICK_FIT_COEFS][STICK_FIT_COEFS + 1];
+    for (int a = 0; a < STICK_FIT_COEFS; a++)
+    {
+        for (int b = 0; b < STICK_FIT_COEFS; b++)
+            m[a][b] = BasisProduct(fit, a, b);
+        m[a][STICK_FIT_COEFS] = fit->rhs[a];
+    }
+
+    float n = fit->cosSum[0];
+    for (int col = 0; col < STICK_FIT_COEFS; col++)
+    {
+        int pivot = col;
+        for (int row = col + 1; row < STICK_FIT_COEFS; row++)
+        {
+            if (fabsf(m[row][col]) > fabsf(m[pivot][col]))
+                pivot = row;
+        }
+        if (fabsf(m[pivot][col]) < n * 1e-4f)
+            return CL_ResFailed;
+
+        if (pivot != col)
+        {
+            for (int k = col; k <= STICK_FIT_COEFS; k++)
+            {
+                float t = m[col][k];
+                m[col][k] = m[pivot][k];
+                m[pivot][k] = t;
+            }
+        }
+
+        for (int row = col + 1; row < STICK_FIT_COEFS; row++)
+        {
+            float f = m[row][col] / m[col][col];
+            for (int k = col; k <= STICK_FIT_COEFS; k++)
+                m[row][k] -= f * m[col][k];
+        }
+    }
+
+    float coef[STICK_FIT_COEFS];
+    for (int row = STICK_FIT_COEFS - 1; row >= 0; row--)
+    {
+        float v = m[row][STICK_FIT_COEFS];
+        for (int k = row + 1; k < STICK_FIT_COEFS; k++)
+            v -= m[row][k] * coef[k];
+        coef[row] = v / m[row][row];
+    }
+
+    // 残差平方和 = Σd^2 - coef·rhs, 边界取拟合值减1倍标准差, 保证推到边缘能达到满值
+    float sse = fit->sqrSum;
+    for (int i = 0; i < STICK_FIT_COEFS; i++)
+        sse -= coef[i] * fit->rhs[i];
+    float sigma = sqrtf(CL_MAX(sse, 0) / n);
+
+    for (int i = 0; i < len; i++)
+    {
+        // 查找表角度从+y轴起顺时针(与StickCorrect一致), 换算为从+x轴起逆时针
+        float rad = M_PI / 2 - M_PI * 2 * i / len;
+        float r = fit->refRadius + coef[0] - sigma;
+        for (int k = 1; k <= STICK_FIT_ORDER; k++)
+            r += coef[k * 2 - 1] * cosf(k * rad) + coef[k * 2] * sinf(k * rad);
+        if (r < STICK_FIT_MIN_RADIUS)
+            return CL_ResFailed;
+        mags[i] = (uint16_t)(r + 0.5f);
+    }
+    return CL_ResSuccess;
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "cl_common.h"
+
+// 摇杆边界最小二乘拟合: 半径r(θ) = a0 + Σ(ak*cos kθ + bk*sin kθ), k=1~STICK_FIT_ORDER
+// 法方程中的基函数乘积都可化为cos jθ, sin jθ (j=0~2K)之和, 每个采样只累加这些矩,
+// 确认时求解系数, 减去1倍残差标准差后展开为边界查找表
+// 采样门限跟随各扇区的包络(两次连续采样的较小值), 单个噪声尖峰不会抬高门限,
+// 相邻采样半径变化大(推拉过程)的采样, 以及扇区包络刚抬高(首次推到边缘)后的采样也不计入
+
+#define STICK_FIT_ORDER (3)
+#define STICK_FIT_COEFS (STICK_FIT_ORDER * 2 + 1)
+#define STICK_FIT_SECTORS (12)          // 30度一个扇区, 用于覆盖判定和均衡权重
+#define STICK_FIT_SECTOR_SAMPLES (400)  // 每个扇区最多累加的采样数
+#define STICK_FIT_SECTOR_MIN (20)       // 每个扇区至少的采样数
+#define STICK_FIT_MIN_RADIUS (300.0f)   // ADC值, 低于此不采样
+#define STICK_FIT_ENV_RATIO (0.9f)      // 低于扇区包络此比例的采样不计入
+// 以下按每个摇杆2kHz采样设定(校准任务逐帧处理摇杆采样流)
+#define STICK_FIT_MAX_STEP (12.0f)      // ADC值, 与上一采样半径差超过此值不计入; 包络抬高超过此值重新等待稳定
+#define STICK_FIT_SETTLE (60)           // 包络抬高后等待的采样数, 30ms
+
+typedef struct
+{
+    float cosSum[STICK_FIT_ORDER * 2 + 1]; // Σcos jθ, cosSum[0]为采样数
+    float sinSum[STICK_FIT_ORDER * 2 + 1]; // Σsin jθ, sinSum[0]恒为0
+    float rhs[STICK_FIT_COEFS];            // Σd*φi, d = r - refRadius
+    float sqrSum;                          // Σd^2
+    float refRadius;                       // 第一个采样的半径, 减小float累加的抵消误差
+    float envelope[STICK_FIT_SECTORS];
+    uint32_t envRiseAt[STICK_FIT_SECTORS]; // 包络最近一次明显抬高时的采样序号
+    uint32_t sampleIndex;
+    float lastRadius;
+    uint16_t sectorCount[STICK_FIT_SECTORS];
+    uint16_t coveredMask; // 采样数达到STICK_FIT_SECTOR_MIN的扇区, 按位
+} StickFit_t;
+
+void StickFit_Reset(StickFit_t *fit);
+// x, y: 减去中心后的ADC值
+void StickFit_Add(StickFit_t *fit, float x, float y);
+bool StickFit_IsCovered(const StickFit_t *fit);
+// 求解并生成len个等分角度(从+y轴起顺时针)的边界长度, 覆盖不足或矩阵奇异返回失败
+CL_Result_t StickFit_Solve(const StickFit_t *fit, uint16_t *mags, uint8_t len);
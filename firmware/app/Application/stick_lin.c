@@ -0,0 +1,149 @@
+#include "stick_lin.h"
+#include "math.h"
+#include "stdlib.h"
+
+#define NODE_SHIFT (STICK_LIN_Q - 2) // 节点间隔0.25
+#define COUPLING_MAX (0.3f)          // 交叉耦合系数上限
+#define INPUT_LIMIT (STICK_LIN_ONE * 3 / 2)
+
+void StickLin_GetDefault(StickLinParams_t *params)
+{
+    params->matrix[0][0] = STICK_LIN_ONE;
+    params->matrix[0][1] = 0;
+    params->matrix[1][0] = 0;
+    params->matrix[1][1] = STICK_LIN_ONE;
+    for (int axis = 0; axis < 2; axis++)
+    {
+        for (int i = 0; i < STICK_LIN_POINTS; i++)
+            params->table[axis][i] = (i - STICK_LIN_POINTS / 2) << NODE_SHIFT;
+    }
+}
+
+bool StickLin_IsValid(const StickLinParams_t *params)
+{
+    for (int i = 0; i < 2; i++)
+    {
+        if (params->matrix[i][i] < STICK_LIN_ONE / 2 || params->matrix[i][i] > STICK_LIN_ONE * 3 / 2)
+            return false;
+        if (abs(params->matrix[i][1 - i]) > STICK_LIN_ONE / 2)
+            return false;
+    }
+
+    for (int axis = 0; axis < 2; axis++)
+    {
+        const int16_t *table = params->table[axis];
+        for (int i = 1; i < STICK_LIN_POINTS; i++)
+        {
+            if (table[i] <= table[i - 1])
+                return false;
+        }
+        if (abs(table[STICK_LIN_POINTS / 2]) > STICK_LIN_ONE / 4)
+            return false;
+    }
+    return true;
+}
+
+// 超出±1时沿端点段外推
+static int32_t LinAxis(const int16_t *table, int32_t u)
+{
+    int32_t pos = u + STICK_LIN_ONE;
+    int32_t idx = CL_CLAMP(pos >> NODE_SHIFT, 0, STICK_LIN_POINTS - 2);
+    int32_t frac = pos - (idx << NODE_SHIFT);
+    return table[idx] + (((int32_t)(table[idx + 1] - table[idx]) * frac) >> NODE_SHIFT);
+}
+
+void StickLin_Apply(const StickLinParams_t *params, Vector2 *stick)
+{
+    int32_t x = CL_CLAMP((int32_t)(stick->x * STICK_LIN_ONE), -INPUT_LIMIT, INPUT_LIMIT);
+    int32_t y = CL_CLAMP((int32_t)(stick->y * STICK_LIN_ONE), -INPUT_LIMIT, INPUT_LIMIT);
+    int32_t ux = (params->matrix[0][0] * x + params->matrix[0][1] * y) >> STICK_LIN_Q;
+    int32_t uy = (params->matrix[1][0] * x + params->matrix[1][1] * y) >> STICK_LIN_Q;
+    stick->x = LinAxis(params->table[0], ux) * (1.0f / STICK_LIN_ONE);
+    stick->y = LinAxis(params->table[1], uy) * (1.0f / STICK_LIN_ONE);
+}
+
+// 由(输入, 输出)点对插值出节点值, 点对按输入升序, 端点外按斜率1延伸
+static void BuildTable(const float *in, const float *out, int n, int16_t *table)
+{
+    for (int i = 0; i < STICK_LIN_POINTS; i++)
+    {
+        float node = (float)(i - STICK_LIN_POINTS / 2) / (STICK_LIN_POINTS / 2);
+        float v;
+        if (node <= in[0])
+            v = out[0] + node - in[0];
+        else if (node >= in[n - 1])
+            v = out[n - 1] + node - in[n - 1];
+        else
+        {
+            int k = 1;
+            while (in[k] < node)
+                k++;
+            v = out[k - 1] + (out[k] - out[k - 1]) * (node - in[k - 1]) / (in[k] - in[k - 1]);
+        }
+        table[i] = (int16_t)CL_CLAMP(lroundf(v * STICK_LIN_ONE), -32767, 32767);
+    }
+}
+
+CL_Result_t StickLin_Solve(const StickLinCapture_t *captures, int count, StickLinParams_t *params)
+{
+    // 测量值 m = [[1, b], [a, 1]] * t', 轴向推动时另一轴的读数即为耦合
+    float sxy[2] = {0}, sxx[2] = {0};
+    uint8_t halfAxes = 0; // bit0~3: +x -x +y -y
+    for (int i = 0; i < count; i++)
+    {
+        const StickLinCapture_t *c = &captures[i];
+        for (int axis = 0; axis < 2; axis++)
+        {
+            if (c->target[axis] == 0 || c->target[1 - axis] != 0)
+                continue;
+            float m = c->measured[axis], cross = c->measured[1 - axis];
+            sxx[axis] += m * m;
+            sxy[axis] += m * cross;
+            halfAxes |= 1 << (axis * 2 + (c->target[axis] < 0));
+        }
+    }
+    if (halfAxes != 0x0f)
+        return CL_ResFailed;
+
+    float a = sxy[0] / sxx[0]; // x轴推动时y的读数比例
+    float b = sxy[1] / sxx[1]; // y轴推动时x的读数比例
+    if (fabsf(a) > COUPLING_MAX || fabsf(b) > COUPLING_MAX)
+        return CL_ResFailed;
+
+    float det = 1 - a * b;
+    float inv[2][2] = {{1 / det, -b / det}, {-a / det, 1 / det}};
+    for (int r = 0; r < 2; r++)
+    {
+        for (int c = 0; c < 2; c++)
+            params->matrix[r][c] = (int16_t)lroundf(inv[r][c] * STICK_LIN_ONE);
+    }
+
+    // 解耦后的轴向值与目标值配对, 加上原点, 插入排序
+    for (int axis = 0; axis < 2; axis++)
+    {
+        float in[STICK_LIN_MAX_CAPTURES + 1], out[STICK_LIN_MAX_CAPTURES + 1];
+        int n = 0;
+        in[n] = 0;
+        out[n++] = 0;
+        for (int i = 0; i < count && n <= STICK_LIN_MAX_CAPTURES; i++)
+        {
+            const StickLinCapture_t *c = &captures[i];
+            if (c->target[axis] == 0 || c->target[1 - axis] != 0)
+                continue;
+            float u = (inv[axis][0] * c->measured[0] + inv[axis][1] * c->measured[1]) / 1000;
+            float t = c->target[axis] / 1000.0f;
+            int k = n++;
+            while (k > 0 && in[k - 1] > u)
+            {
+                in[k] = in[k - 1];
+                out[k] = out[k - 1];
+                k--;
+            }
+            in[k] = u;
+            out[k] = t;
+        }
+        BuildTable(in, out, n, params->table[axis]);
+    }
+
+    return StickLin_IsValid(params) ? CL_ResSuccess : CL_ResFailed;
+}
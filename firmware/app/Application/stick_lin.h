@@ -0,0 +1,41 @@
+#pragma once
+
+#include "cl_common.h"
+#include "vector2.h"
+
+// 摇杆交叉耦合和单轴线性校正, 作用在边界归一化之后、死区和响应曲线之前
+// u = M * v (2x2解耦矩阵), 再对u的每个轴按等间隔节点的分段线性表查表
+// 运行时为Q14定点运算, 节点间隔0.25, 下标由移位得到
+// 参数由引导采样求解: 主机提示用户把摇杆推到指定位置, 逐点采集归一化后的测量值
+
+#define STICK_LIN_Q (14)
+#define STICK_LIN_ONE (1 << STICK_LIN_Q)
+#define STICK_LIN_POINTS (9)        // 输入-1, -0.75, ... 1
+#define STICK_LIN_MAX_CAPTURES (16) // 每个摇杆最多的采样点
+
+typedef enum
+{
+    StickLin_Left,
+    StickLin_Right,
+    StickLin_Max,
+} StickLinIdx_t;
+
+typedef struct
+{
+    int16_t matrix[2][2];               // Q14
+    int16_t table[2][STICK_LIN_POINTS]; // Q14, x/y轴在各节点处的输出
+} StickLinParams_t;
+
+// 一个引导采样点, 单位均为1/1000满量程
+typedef struct
+{
+    int16_t target[2];   // 目标位置, 只使用轴向的点(另一轴为0)
+    int16_t measured[2]; // 边界归一化后的测量值
+} StickLinCapture_t;
+
+void StickLin_GetDefault(StickLinParams_t *params);
+bool StickLin_IsValid(const StickLinParams_t *params);
+void StickLin_Apply(const StickLinParams_t *params, Vector2 *stick);
+
+// 四个半轴上至少各有一个采样点, 耦合系数过大或结果不单调时返回失败
+CL_Result_t StickLin_Solve(const StickLinCapture_t *captures, int count, StickLinParams_t *params);
@@ -30,6 +30,7 @@ extern "C" {
 
 /* USER CODE BEGIN Includes */
 #include "cl_common.h"
+#include "adc_ring.h"
 /* USER CODE END Includes */
 
 /* USER CODE BEGIN Private defines */
@@ -41,13 +42,30 @@ typedef enum
   AdcChan_LeftHall,
   AdcChan_LeftX,
   AdcChan_LeftY,
+  AdcChan_Max,
 } AdcChannel_t;
+
+// 采样流, 每个流一个带时间戳的环形缓冲
+typedef enum
+{
+  AdcStream_Stick, // 2kHz, 每半个DMA缓冲的平均值, value: LeftX, LeftY, RightX, RightY
+  AdcStream_Hall,  // 24kHz, 每个原始采样, value: LeftHall, RightHall
+  AdcStream_Max,
+} AdcStream_t;
 /* USER CODE END Private defines */
 
 void MX_ADC1_Init(void);
 
 /* USER CODE BEGIN Prototypes */
-uint16_t GetAdcResult(AdcChannel_t chan);
+uint16_t GetAdcResult(AdcChannel_t chan); // 滤波后的最新值
+// 读取readCount之后的新采样, 返回读取个数, readCount由调用者保存
+uint32_t AdcStream_Read(AdcStream_t stream, uint32_t *readCount, AdcSample_t *out, uint32_t max);
+uint32_t AdcStream_Count(AdcStream_t stream); // 已写入的采样数, 作为只读新采样的读计数
+uint32_t AdcGetStickFrame(void); // 摇杆帧计数, 滤波值每更新一次加1(2kHz)
+void AdcOnDmaTransfer(bool secondHalf);
+void AdcOnInjectedDone(void);
+void AdcStop(void);
+void AdcResume(void);
 /* USER CODE END Prototypes */
 
 #ifdef __cplusplus
@@ -53,6 +53,10 @@ typedef enum
   PwmChan_PadLed,
 } PwmChannel_t;
 void PwmSetDuty(PwmChannel_t chan, uint16_t duty);
+void PwmSetMotorDuty(uint16_t left, uint16_t right);
+void PwmPlayPadLedWave(const uint16_t *wave, uint16_t len, uint8_t stepMs);
+void PwmSuspend(void);
+void PwmResume(void);
 /* USER CODE END Prototypes */
 
 #ifdef __cplusplus
@@ -21,8 +21,131 @@
 #include "adc.h"
 
 /* USER CODE BEGIN 0 */
+#include "ustime.h"
+#include "rapid_trigger.h"
+
+// 多速率采集: ADC1/ADC2双ADC, 规则组与注入组各自同步采样, 触发源和采样时间见adcPlan
+// 摇杆: 规则组, DMA搬运, 每半个DMA缓冲平均一次
+// 扳机: 注入组, 可打断规则组, JEOC中断读取后逐个采样交给快速触发判定
+// 两组都由TIM3触发: 规则组在更新事件, 注入组在周期中点的CC4, 两组转换错开不会互相打断
+// ADCCLK 12MHz, ADC1_DR高16位为ADC2结果
+#define ADC_STICK_RANKS (2)
+#define ADC_STICK_DMA_FRAMES (24) // 半传输/传输完成中断各处理12帧, 0.5ms一次
+#define ADC_STICK_HALF_TIME (500) // us, 半个DMA缓冲的采样时长
+#define ADC_HALL_FILTER (24)      // 扳机输出最近24个采样(1ms)的平均值
+#define ADC_STICK_STREAM_LEN (32) // 16ms
+#define ADC_HALL_STREAM_LEN (64)  // 2.7ms
+
+typedef struct
+{
+  uint32_t adc1Chan;
+  uint32_t adc2Chan;
+  AdcChannel_t adc1Idx;
+  AdcChannel_t adc2Idx;
+} AdcDualRank_t;
+
+// 规则组: 每个摇杆的X/Y同时采样
+static const AdcDualRank_t adcStickRank[ADC_STICK_RANKS] = {
+  {LL_ADC_CHANNEL_1, LL_ADC_CHANNEL_2, AdcChan_RightX, AdcChan_RightY},
+  {LL_ADC_CHANNEL_4, LL_ADC_CHANNEL_5, AdcChan_LeftX, AdcChan_LeftY},
+};
+static const uint32_t adcStickRankDef[ADC_STICK_RANKS] = {LL_ADC_REG_RANK_1, LL_ADC_REG_RANK_2};
+// 注入组: 两个扳机同时采样
+static const AdcDualRank_t adcHallRank = {LL_ADC_CHANNEL_0, LL_ADC_CHANNEL_3, AdcChan_RightHall, AdcChan_LeftHall};
+
+typedef struct
+{
+  uint32_t trigger;      // 主ADC的外部触发, 采样率由对应定时器决定
+  uint32_t samplingTime; // 组内每个通道的采样周期
+} AdcGroupPlan_t;
+
+// 采集计划: 改采样率或采样时间只改这里
+static const struct
+{
+  AdcGroupPlan_t stick; // 规则组
+  AdcGroupPlan_t hall;  // 注入组
+} adcPlan = {
+  // TIM3_TRGO(更新), 24kHz; 71.5周期, 一帧2个rank 14us
+  .stick = {LL_ADC_REG_TRIG_EXT_TIM3_TRGO, LL_ADC_SAMPLINGTIME_71CYCLES_5},
+  // TIM3_CC4, 24kHz, 更新后20.8us; 71.5周期 7us
+  .hall = {LL_ADC_INJ_TRIG_EXT_TIM3_CH4, LL_ADC_SAMPLINGTIME_71CYCLES_5},
+};
+
+static volatile uint32_t adcStickDma[ADC_STICK_DMA_FRAMES][ADC_STICK_RANKS];
+static volatile uint16_t adcResult[AdcChan_Max]; // 滤波后的最新值
+static volatile uint32_t adcStickFrame = 0;
+static AdcSample_t adcStickStream[ADC_STICK_STREAM_LEN];
+static AdcSample_t adcHallStream[ADC_HALL_STREAM_LEN];
+static AdcRing_t adcStream[AdcStream_Max];
+
+static void AdcGroupConfig(ADC_TypeDef *adc, bool master)
+{
+  LL_ADC_InitTypeDef ADC_InitStruct = {0};
+  LL_ADC_REG_InitTypeDef ADC_REG_InitStruct = {0};
+  LL_ADC_INJ_InitTypeDef ADC_INJ_InitStruct = {0};
+
+  // 从ADC不使用外部触发, 由主ADC同步启动
+  ADC_InitStruct.DataAlignment = LL_ADC_DATA_ALIGN_RIGHT;
+  ADC_InitStruct.SequencersScanMode = LL_ADC_SEQ_SCAN_ENABLE;
+  LL_ADC_Init(adc, &ADC_InitStruct);
+
+  ADC_REG_InitStruct.TriggerSource = master ? adcPlan.stick.trigger : LL_ADC_REG_TRIG_SOFTWARE;
+  ADC_REG_InitStruct.SequencerLength = LL_ADC_REG_SEQ_SCAN_ENABLE_2RANKS;
+  ADC_REG_InitStruct.SequencerDiscont = LL_ADC_REG_SEQ_DISCONT_DISABLE;
+  ADC_REG_InitStruct.ContinuousMode = LL_ADC_REG_CONV_SINGLE;
+  ADC_REG_InitStruct.DMATransfer = master ? LL_ADC_REG_DMA_TRANSFER_UNLIMITED : LL_ADC_REG_DMA_TRANSFER_NONE;
+  LL_ADC_REG_Init(adc, &ADC_REG_InitStruct);
+
+  ADC_INJ_InitStruct.TriggerSource = master ? adcPlan.hall.trigger : LL_ADC_INJ_TRIG_SOFTWARE;
+  ADC_INJ_InitStruct.SequencerLength = LL_ADC_INJ_SEQ_SCAN_DISABLE;
+  ADC_INJ_InitStruct.SequencerDiscont = LL_ADC_INJ_SEQ_DISCONT_DISABLE;
+  ADC_INJ_InitStruct.TrigAuto = LL_ADC_INJ_TRIG_INDEPENDENT;
+  LL_ADC_INJ_Init(adc, &ADC_INJ_InitStruct);
+
+  for (int i = 0; i < ADC_STICK_RANKS; i++)
+  {
+    uint32_t chan = master ? adcStickRank[i].adc1Chan : adcStickRank[i].adc2Chan;
+    LL_ADC_REG_SetSequencerRanks(adc, adcStickRankDef[i], chan);
+    LL_ADC_SetChannelSamplingTime(adc, chan, adcPlan.stick.samplingTime);
+  }
 
-volatile uint16_t adcResult[6];
+  uint32_t hallChan = master ? adcHallRank.adc1Chan : adcHallRank.adc2Chan;
+  LL_ADC_INJ_SetSequencerRanks(adc, LL_ADC_INJ_RANK_1, hallChan);
+  LL_ADC_SetChannelSamplingTime(adc, hallChan, adcPlan.hall.samplingTime);
+}
+
+static void AdcMultiRateConfig(void)
+{
+  LL_APB2_GRP1_EnableClock(LL_APB2_GRP1_PERIPH_ADC2);
+
+  AdcGroupConfig(ADC1, true);
+  AdcGroupConfig(ADC2, false);
+  LL_ADC_SetMultimode(__LL_ADC_COMMON_INSTANCE(ADC1), LL_ADC_MULTI_DUAL_REG_SIM_INJ_SIM);
+
+  LL_DMA_SetPeriphSize(DMA1, LL_DMA_CHANNEL_1, LL_DMA_PDATAALIGN_WORD);
+  LL_DMA_SetMemorySize(DMA1, LL_DMA_CHANNEL_1, LL_DMA_MDATAALIGN_WORD);
+
+  LL_ADC_EnableIT_JEOS(ADC1);
+  NVIC_SetPriority(ADC1_2_IRQn, NVIC_EncodePriority(NVIC_GetPriorityGrouping(), 0, 0));
+  NVIC_EnableIRQ(ADC1_2_IRQn);
+}
+
+static void AdcCalibrate(ADC_TypeDef *adc)
+{
+  LL_ADC_StartCalibration(adc);
+  while (LL_ADC_IsCalibrationOnGoing(adc) != 0)
+  {
+  }
+}
+
+static void AdcStart(void)
+{
+  // 从ADC触发源为软件, 只打开EXTTRIG位, 转换由主ADC同步启动
+  LL_ADC_REG_StartConversionExtTrig(ADC2, LL_ADC_REG_TRIG_EXT_RISING);
+  LL_ADC_INJ_StartConversionExtTrig(ADC2, LL_ADC_INJ_TRIG_EXT_RISING);
+  LL_ADC_REG_StartConversionExtTrig(ADC1, LL_ADC_REG_TRIG_EXT_RISING);
+  LL_ADC_INJ_StartConversionExtTrig(ADC1, LL_ADC_INJ_TRIG_EXT_RISING);
+}
 /* USER CODE END 0 */
 
 /* ADC1 init function */
@@ -94,50 +217,54 @@ void MX_ADC1_Init(void)
   /** Configure Regular Channel
   */
   LL_ADC_REG_SetSequencerRanks(ADC1, LL_ADC_REG_RANK_1, LL_ADC_CHANNEL_0);
-  LL_ADC_SetChannelSamplingTime(ADC1, LL_ADC_CHANNEL_0, LL_ADC_SAMPLINGTIME_239CYCLES_5);
+  LL_ADC_SetChannelSamplingTime(ADC1, LL_ADC_CHANNEL_0, LL_ADC_SAMPLINGTIME_71CYCLES_5);
 
   /** Configure Regular Channel
   */
   LL_ADC_REG_SetSequencerRanks(ADC1, LL_ADC_REG_RANK_2, LL_ADC_CHANNEL_1);
-  LL_ADC_SetChannelSamplingTime(ADC1, LL_ADC_CHANNEL_1, LL_ADC_SAMPLINGTIME_239CYCLES_5);
+  LL_ADC_SetChannelSamplingTime(ADC1, LL_ADC_CHANNEL_1, LL_ADC_SAMPLINGTIME_71CYCLES_5);
 
   /** Configure Regular Channel
   */
   LL_ADC_REG_SetSequencerRanks(ADC1, LL_ADC_REG_RANK_3, LL_ADC_CHANNEL_2);
-  LL_ADC_SetChannelSamplingTime(ADC1, LL_ADC_CHANNEL_2, LL_ADC_SAMPLINGTIME_239CYCLES_5);
+  LL_ADC_SetChannelSamplingTime(ADC1, LL_ADC_CHANNEL_2, LL_ADC_SAMPLINGTIME_71CYCLES_5);
 
   /** Configure Regular Channel
   */
   LL_ADC_REG_SetSequencerRanks(ADC1, LL_ADC_REG_RANK_4, LL_ADC_CHANNEL_3);
-  LL_ADC_SetChannelSamplingTime(ADC1, LL_ADC_CHANNEL_3, LL_ADC_SAMPLINGTIME_239CYCLES_5);
+  LL_ADC_SetChannelSamplingTime(ADC1, LL_ADC_CHANNEL_3, LL_ADC_SAMPLINGTIME_71CYCLES_5);
 
   /** Configure Regular Channel
   */
   LL_ADC_REG_SetSequencerRanks(ADC1, LL_ADC_REG_RANK_5, LL_ADC_CHANNEL_4);
-  LL_ADC_SetChannelSamplingTime(ADC1, LL_ADC_CHANNEL_4, LL_ADC_SAMPLINGTIME_239CYCLES_5);
+  LL_ADC_SetChannelSamplingTime(ADC1, LL_ADC_CHANNEL_4, LL_ADC_SAMPLINGTIME_71CYCLES_5);
 
   /** Configure Regular Channel
   */
   LL_ADC_REG_SetSequencerRanks(ADC1, LL_ADC_REG_RANK_6, LL_ADC_CHANNEL_5);
-  LL_ADC_SetChannelSamplingTime(ADC1, LL_ADC_CHANNEL_5, LL_ADC_SAMPLINGTIME_239CYCLES_5);
+  LL_ADC_SetChannelSamplingTime(ADC1, LL_ADC_CHANNEL_5, LL_ADC_SAMPLINGTIME_71CYCLES_5);
   /* USER CODE BEGIN ADC1_Init 2 */
-
+  // 以上为单ADC顺序扫描的配置, 在此改为多速率双ADC采集
+  AdcRing_Init(&adcStream[AdcStream_Stick], adcStickStream, ADC_STICK_STREAM_LEN);
+  AdcRing_Init(&adcStream[AdcStream_Hall], adcHallStream, ADC_HALL_STREAM_LEN);
+  AdcMultiRateConfig();
 
   LL_DMA_ConfigAddresses(DMA1, LL_DMA_CHANNEL_1,
-  LL_ADC_DMA_GetRegAddr(ADC1, LL_ADC_DMA_REG_REGULAR_DATA), (uint32_t)adcResult, LL_DMA_DIRECTION_PERIPH_TO_MEMORY);
-  LL_DMA_SetDataLength(DMA1, LL_DMA_CHANNEL_1, CL_ARRAY_LENGTH(adcResult));
+  LL_ADC_DMA_GetRegAddr(ADC1, LL_ADC_DMA_REG_REGULAR_DATA), (uint32_t)adcStickDma, LL_DMA_DIRECTION_PERIPH_TO_MEMORY);
+  LL_DMA_SetDataLength(DMA1, LL_DMA_CHANNEL_1, ADC_STICK_DMA_FRAMES * ADC_STICK_RANKS);
 
-  // LL_DMA_EnableIT_TC(DMA1, LL_DMA_CHANNEL_1);
+  LL_DMA_EnableIT_HT(DMA1, LL_DMA_CHANNEL_1);
+  LL_DMA_EnableIT_TC(DMA1, LL_DMA_CHANNEL_1);
   LL_DMA_EnableChannel(DMA1, LL_DMA_CHANNEL_1); 
 
+  LL_ADC_Enable(ADC2);
   LL_ADC_Enable(ADC1);
   HAL_Delay(2);
-  LL_ADC_StartCalibration(ADC1);
-  while (LL_ADC_IsCalibrationOnGoing(ADC1) != 0)  
-  {
-  }
+  AdcCalibrate(ADC2);
+  AdcCalibrate(ADC1);
 
-  LL_ADC_REG_StartConversionSWStart(ADC1);
+  // 等待定时器触发, TIM3在PWM启动后开始计数
+  AdcStart();
   /* USER CODE END ADC1_Init 2 */
 
 }
@@ -147,4 +274,96 @@ uint16_t GetAdcResult(AdcChannel_t chan)
 {
   return adcResult[chan];
 }
+
+uint32_t AdcGetStickFrame(void)
+{
+  return adcStickFrame;
+}
+
+uint32_t AdcStream_Read(AdcStream_t stream, uint32_t *readCount, AdcSample_t *out, uint32_t max)
+{
+  return AdcRing_Read(&adcStream[stream], readCount, out, max);
+}
+
+uint32_t AdcStream_Count(AdcStream_t stream)
+{
+  return adcStream[stream].writeCount;
+}
+
+// DMA半传输/传输完成中断中调用, 处理刚写完的一半摇杆缓冲
+void AdcOnDmaTransfer(bool secondHalf)
+{
+  const int frames = ADC_STICK_DMA_FRAMES / 2;
+  uint32_t sum[AdcChan_Max] = {0};
+  int first = secondHalf ? frames : 0;
+  for (int f = 0; f < frames; f++)
+  {
+    uint16_t frame[AdcChan_Max];
+    for (int i = 0; i < ADC_STICK_RANKS; i++)
+    {
+      uint32_t data = adcStickDma[first + f][i];
+      frame[adcStickRank[i].adc1Idx] = data & 0xffff;
+      frame[adcStickRank[i].adc2Idx] = data >> 16;
+    }
+
+    sum[AdcChan_LeftX] += frame[AdcChan_LeftX];
+    sum[AdcChan_LeftY] += frame[AdcChan_LeftY];
+    sum[AdcChan_RightX] += frame[AdcChan_RightX];
+    sum[AdcChan_RightY] += frame[AdcChan_RightY];
+  }
+
+  adcResult[AdcChan_LeftX] = sum[AdcChan_LeftX] / frames;
+  adcResult[AdcChan_LeftY] = sum[AdcChan_LeftY] / frames;
+  adcResult[AdcChan_RightX] = sum[AdcChan_RightX] / frames;
+  adcResult[AdcChan_RightY] = sum[AdcChan_RightY] / frames;
+  adcStickFrame++;
+
+  // 时间取平均窗口的中点
+  AdcRing_Push(&adcStream[AdcStream_Stick], GetUsTime() - ADC_STICK_HALF_TIME / 2,
+               adcResult[AdcChan_LeftX], adcResult[AdcChan_LeftY], adcResult[AdcChan_RightX], adcResult[AdcChan_RightY]);
+}
+
+// 注入组转换完成中断中调用
+void AdcOnInjectedDone(void)
+{
+  static uint16_t hallHistory[ADC_HALL_FILTER][2];
+  static uint32_t hallSum[2];
+  static uint8_t hallPos = 0;
+
+  uint16_t right = LL_ADC_INJ_ReadConversionData12(ADC1, LL_ADC_INJ_RANK_1);
+  uint16_t left = LL_ADC_INJ_ReadConversionData12(ADC2, LL_ADC_INJ_RANK_1);
+
+  // 快速触发需要每个采样判定
+  RapidTrig_OnAdcFrame(left, right);
+  AdcRing_Push(&adcStream[AdcStream_Hall], GetUsTime(), left, right, 0, 0);
+
+  // 滑动平均
+  hallSum[0] += left - hallHistory[hallPos][0];
+  hallSum[1] += right - hallHistory[hallPos][1];
+  hallHistory[hallPos][0] = left;
+  hallHistory[hallPos][1] = right;
+  hallPos = (hallPos + 1) % ADC_HALL_FILTER;
+
+  adcResult[AdcChan_LeftHall] = hallSum[0] / ADC_HALL_FILTER;
+  adcResult[AdcChan_RightHall] = hallSum[1] / ADC_HALL_FILTER;
+}
+
+// 停止采集, 重新启动时从第一个rank开始, 与DMA对齐
+void AdcStop(void)
+{
+  LL_ADC_Disable(ADC1);
+  LL_ADC_Disable(ADC2);
+  LL_DMA_DisableChannel(DMA1, LL_DMA_CHANNEL_1);
+}
+
+void AdcResume(void)
+{
+  LL_DMA_SetDataLength(DMA1, LL_DMA_CHANNEL_1, ADC_STICK_DMA_FRAMES * ADC_STICK_RANKS);
+  LL_DMA_EnableChannel(DMA1, LL_DMA_CHANNEL_1);
+
+  LL_ADC_Enable(ADC2);
+  LL_ADC_Enable(ADC1);
+  HAL_Delay(1);
+  AdcStart();
+}
 /* USER CODE END 1 */
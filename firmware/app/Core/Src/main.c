@@ -28,11 +28,19 @@
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
 #include "systime.h"
+#include "ustime.h"
 #include "cl_log.h"
 #include "cl_event_system.h"
 #include "pad_func.h"
 #include "led.h"
 #include "button.h"
+#include "cali.h"
+#include "sched.h"
+#include "power.h"
+#include "trace.h"
+#include "profile.h"
+#include "pad_cmd.h"
+#include "haptics.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -42,6 +50,10 @@
 
 /* Private define ------------------------------------------------------------*/
 /* USER CODE BEGIN PD */
+// 调试构建: 每10s打印调度/电源/分段耗时统计(分段耗时还需PROFILE_ENABLE), 默认关闭
+#ifndef STAT_PRINT_ENABLE
+#define STAT_PRINT_ENABLE (0)
+#endif
 
 /* USER CODE END PD */
 
@@ -81,6 +93,15 @@ static void UsbFakePlug(void)
   HAL_Delay(100);
   LL_GPIO_SetOutputPin(GPIOA, LL_GPIO_PIN_12);
 }
+
+#if STAT_PRINT_ENABLE
+static void StatProc(void)
+{
+  Sched_PrintStat();
+  Power_PrintStat();
+  Profile_PrintStat();
+}
+#endif
 /* USER CODE END 0 */
 
 /**
@@ -90,6 +111,8 @@ static void UsbFakePlug(void)
 int main(void)
 {
   /* USER CODE BEGIN 1 */
+  // DWT不随复位和跳转清零, boot入口已开启计数, 此处为boot入口到app的周期数
+  uint32_t startupCycles = (DWT->CTRL & DWT_CTRL_CYCCNTENA_Msk) ? DWT->CYCCNT : 0;
   CL_EventSysInit();
   /* USER CODE END 1 */
 
@@ -106,6 +129,8 @@ int main(void)
   SystemClock_Config();
 
   /* USER CODE BEGIN SysInit */
+  UsTime_Init();
+  Profile_Init();
   UsbFakePlug();
   /* USER CODE END SysInit */
 
@@ -121,6 +146,8 @@ int main(void)
   HAL_TIM_PWM_Start(&htim3, TIM_CHANNEL_1);
   HAL_TIM_PWM_Start(&htim3, TIM_CHANNEL_2);
   HAL_TIM_PWM_Start(&htim1, TIM_CHANNEL_1);
+  HAL_TIM_PWM_Start(&htim3, TIM_CHANNEL_4); // ADC注入组触发, 规则组由TIM3_TRGO触发
+  CL_LOG_INFO("startup: %u cycles", startupCycles);
   /* USER CODE END 2 */
 
   /* Infinite loop */
@@ -128,20 +155,26 @@ int main(void)
   Button_Init();
   Led_Init();
   PadFunc_Init();
+  Haptics_Init();
+  Power_Init();
+
+  Sched_AddTask(PadFunc_Process, PAD_REPORT_INTERVAL, SchedPrio_High, "report");
+  Sched_AddTask(Button_Process, USTIME_MS(1), SchedPrio_Normal, "button");
+  Sched_AddTask(Cali_Process, USTIME_MS(1), SchedPrio_Normal, "cali");
+  Sched_AddTask(PadLedProc, USTIME_MS(10), SchedPrio_Low, "pad led");
+  Sched_AddTask(McuLedProc, USTIME_MS(100), SchedPrio_Low, "mcu led");
+  Sched_AddTask(Power_Process, USTIME_MS(5), SchedPrio_Low, "power");
+  Sched_AddTask(Trace_Process, USTIME_MS(1), SchedPrio_Low, "trace");
+#if STAT_PRINT_ENABLE
+  Sched_AddTask(StatProc, USTIME_SECOND(10), SchedPrio_Low, "stat");
+#endif
+  Sched_AddTask(PadCmd_Process, USTIME_MS(10), SchedPrio_Low, "pad cmd");
   while (1)
   {
-    Button_Process();
-    Led_Process();
-    PadFunc_Process();
     /* USER CODE END WHILE */
 
     /* USER CODE BEGIN 3 */
-    static uint32_t lastTime = 0;
-    if (SysTimeSpan(lastTime) >= 1000)
-    {
-      lastTime = GetSysTime();
-      // CL_LOG_INFO("app2: %us", lastTime / 1000);
-    }
+    Sched_Run();
   }
   /* USER CODE END 3 */
 }
@@ -185,7 +218,7 @@ void SystemClock_Config(void)
     Error_Handler();
   }
   PeriphClkInit.PeriphClockSelection = RCC_PERIPHCLK_ADC|RCC_PERIPHCLK_USB;
-  PeriphClkInit.AdcClockSelection = RCC_ADCPCLK2_DIV8;
+  PeriphClkInit.AdcClockSelection = RCC_ADCPCLK2_DIV6;
   PeriphClkInit.UsbClockSelection = RCC_USBCLKSOURCE_PLL_DIV1_5;
   if (HAL_RCCEx_PeriphCLKConfig(&PeriphClkInit) != HAL_OK)
   {
@@ -23,8 +23,12 @@
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
 #include "systime.h"
+#include "ustime.h"
 #include "usart.h"
 #include "adc.h"
+#include "power.h"
+#include "tim.h"
+#include "haptics.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -191,6 +195,7 @@ void SysTick_Handler(void)
   HAL_IncTick();
   /* USER CODE BEGIN SysTick_IRQn 1 */
   SysTimeInc(1);
+  UsTimeUpdate();
   /* USER CODE END SysTick_IRQn 1 */
 }
 
@@ -211,9 +216,15 @@ void DMA1_Channel1_IRQHandler(void)
   /* USER CODE END DMA1_Channel1_IRQn 0 */
 
   /* USER CODE BEGIN DMA1_Channel1_IRQn 1 */
+  if(LL_DMA_IsActiveFlag_HT1(DMA1))
+  {
+    LL_DMA_ClearFlag_HT1(DMA1);
+    AdcOnDmaTransfer(false);
+  }
   if(LL_DMA_IsActiveFlag_TC1(DMA1))
   {
     LL_DMA_ClearFlag_TC1(DMA1);
+    AdcOnDmaTransfer(true);
   }
   /* USER CODE END DMA1_Channel1_IRQn 1 */
 }
@@ -232,26 +243,64 @@ void USB_LP_CAN1_RX0_IRQHandler(void)
   /* USER CODE END USB_LP_CAN1_RX0_IRQn 1 */
 }
 
+/* USER CODE BEGIN 1 */
 /**
-  * @brief This function handles USART1 global interrupt.
+  * @brief This function handles DMA1 channel4 global interrupt (USART1_TX).
   */
-void USART1_IRQHandler(void)
+void DMA1_Channel4_IRQHandler(void)
 {
-  /* USER CODE BEGIN USART1_IRQn 0 */
+  if (LL_DMA_IsActiveFlag_TC4(DMA1))
+  {
+    LL_DMA_ClearFlag_TC4(DMA1);
+    Usart1_OnDmaDone();
+  }
+}
 
-  /* USER CODE END USART1_IRQn 0 */
-  /* USER CODE BEGIN USART1_IRQn 1 */
-  volatile uint8_t data;
-  if (LL_USART_IsActiveFlag_TXE(USART1))
+/**
+  * @brief This function handles ADC1 and ADC2 global interrupts (injected group, hall triggers).
+  */
+void ADC1_2_IRQHandler(void)
+{
+  if (LL_ADC_IsActiveFlag_JEOS(ADC1))
   {
-    if(Usart1_PollSendByte(&data) == CL_ResSuccess)
-      LL_USART_TransmitData8(USART1, data);
-    else
-      LL_USART_DisableIT_TXE(USART1);
+    LL_ADC_ClearFlag_JEOS(ADC1);
+    AdcOnInjectedDone();
   }
-  /* USER CODE END USART1_IRQn 1 */
 }
 
-/* USER CODE BEGIN 1 */
+/**
+  * @brief This function handles TIM3 global interrupt (motor PWM update, haptics mailbox).
+  */
+void TIM3_IRQHandler(void)
+{
+  if (__HAL_TIM_GET_FLAG(&htim3, TIM_FLAG_UPDATE))
+  {
+    __HAL_TIM_CLEAR_FLAG(&htim3, TIM_FLAG_UPDATE);
+    Haptics_OnPwmUpdate();
+  }
+}
+
+/**
+  * @brief This function handles TIM2 global interrupt (scheduler wakeup alarm).
+  */
+void TIM2_IRQHandler(void)
+{
+  UsTime_OnAlarm();
+}
 
+/**
+  * @brief This function handles EXTI line4 interrupt (XBOX button wakeup).
+  */
+void EXTI4_IRQHandler(void)
+{
+  Power_OnWakeButton();
+}
+
+/**
+  * @brief This function handles USB wake-up interrupt through EXTI line 18.
+  */
+void USBWakeUp_IRQHandler(void)
+{
+  Power_OnUsbWakeup();
+}
 /* USER CODE END 1 */
@@ -21,7 +21,7 @@
 #include "tim.h"
 
 /* USER CODE BEGIN 0 */
-
+static uint32_t pwmSavedCompare[3];
 /* USER CODE END 0 */
 
 TIM_HandleTypeDef htim1;
@@ -93,6 +93,18 @@ void MX_TIM1_Init(void)
   }
   /* USER CODE BEGIN TIM1_Init 2 */
   PwmSetDuty(PwmChan_PadLed, 0);
+
+  // DMA1通道5: TIM1_UP, 更新事件时把LED波形的下一个点写入CCR1
+  LL_DMA_DisableChannel(DMA1, LL_DMA_CHANNEL_5);
+  LL_DMA_SetDataTransferDirection(DMA1, LL_DMA_CHANNEL_5, LL_DMA_DIRECTION_MEMORY_TO_PERIPH);
+  LL_DMA_SetChannelPriorityLevel(DMA1, LL_DMA_CHANNEL_5, LL_DMA_PRIORITY_LOW);
+  LL_DMA_SetMode(DMA1, LL_DMA_CHANNEL_5, LL_DMA_MODE_CIRCULAR);
+  LL_DMA_SetPeriphIncMode(DMA1, LL_DMA_CHANNEL_5, LL_DMA_PERIPH_NOINCREMENT);
+  LL_DMA_SetMemoryIncMode(DMA1, LL_DMA_CHANNEL_5, LL_DMA_MEMORY_INCREMENT);
+  LL_DMA_SetPeriphSize(DMA1, LL_DMA_CHANNEL_5, LL_DMA_PDATAALIGN_HALFWORD);
+  LL_DMA_SetMemorySize(DMA1, LL_DMA_CHANNEL_5, LL_DMA_MDATAALIGN_HALFWORD);
+  LL_DMA_SetPeriphAddress(DMA1, LL_DMA_CHANNEL_5, (uint32_t)&htim1.Instance->CCR1);
+  __HAL_TIM_ENABLE_DMA(&htim1, TIM_DMA_UPDATE);
   /* USER CODE END TIM1_Init 2 */
   HAL_TIM_MspPostInit(&htim1);
 
@@ -113,7 +125,7 @@ void MX_TIM3_Init(void)
 
   /* USER CODE END TIM3_Init 1 */
   htim3.Instance = TIM3;
-  htim3.Init.Prescaler = 8;
+  htim3.Init.Prescaler = 2;
   htim3.Init.CounterMode = TIM_COUNTERMODE_UP;
   htim3.Init.Period = 999;
   htim3.Init.ClockDivision = TIM_CLOCKDIVISION_DIV1;
@@ -150,6 +162,18 @@ void MX_TIM3_Init(void)
     Error_Handler();
   }
   /* USER CODE BEGIN TIM3_Init 2 */
+  // 24kHz, 电机PWM在听觉范围外; 更新事件经TRGO作为ADC规则组(摇杆)触发
+  sMasterConfig.MasterOutputTrigger = TIM_TRGO_UPDATE;
+  if (HAL_TIMEx_MasterConfigSynchronization(&htim3, &sMasterConfig) != HAL_OK)
+  {
+    Error_Handler();
+  }
+  // CH4无输出引脚, 比较事件作为ADC注入组(扳机)触发, 与规则组错开半个周期
+  sConfigOC.Pulse = (htim3.Init.Period + 1) / 2;
+  if (HAL_TIM_PWM_ConfigChannel(&htim3, &sConfigOC, TIM_CHANNEL_4) != HAL_OK)
+  {
+    Error_Handler();
+  }
   PwmSetDuty(PwmChan_MotorLeft, 0);
   PwmSetDuty(PwmChan_MotorRight, 0);
   /* USER CODE END TIM3_Init 2 */
@@ -275,4 +299,69 @@ void PwmSetDuty(PwmChannel_t chan, uint16_t duty)
     break;
   }
 }
+
+// 占空比为计数值0~1000(全分辨率), 两路电机的比较值在同一个更新事件生效
+void PwmSetMotorDuty(uint16_t left, uint16_t right)
+{
+  uint16_t full = htim3.Init.Period + 1;
+  if(left > full)
+    left = full;
+  if(right > full)
+    right = full;
+
+  SET_BIT(htim3.Instance->CR1, TIM_CR1_UDIS);
+  __HAL_TIM_SET_COMPARE(&htim3, TIM_CHANNEL_2, left);
+  __HAL_TIM_SET_COMPARE(&htim3, TIM_CHANNEL_1, right);
+  CLEAR_BIT(htim3.Instance->CR1, TIM_CR1_UDIS);
+}
+
+// 循环播放LED波形, 每点持续stepMs(1~64ms), 波形缓冲在播放期间不能修改, len为0时停止
+// 重复计数器使TIM1更新事件(和DMA请求)每stepMs产生一次, CH3的ADC触发不受影响
+void PwmPlayPadLedWave(const uint16_t *wave, uint16_t len, uint8_t stepMs)
+{
+  uint32_t updatePerMs = SystemCoreClock / (htim1.Init.Prescaler + 1) / (htim1.Init.Period + 1) / 1000;
+  uint32_t rep = stepMs * updatePerMs;
+  if(rep == 0)
+    rep = 1;
+  if(rep > 256)
+    rep = 256;
+
+  LL_DMA_DisableChannel(DMA1, LL_DMA_CHANNEL_5);
+  if(len == 0)
+    return;
+
+  htim1.Instance->RCR = rep - 1;
+  LL_DMA_SetMemoryAddress(DMA1, LL_DMA_CHANNEL_5, (uint32_t)wave);
+  LL_DMA_SetDataLength(DMA1, LL_DMA_CHANNEL_5, len);
+  LL_DMA_EnableChannel(DMA1, LL_DMA_CHANNEL_5);
+}
+
+// 输出置为无效电平后停止计数器, 比较值保存至恢复
+void PwmSuspend(void)
+{
+  pwmSavedCompare[PwmChan_MotorLeft] = __HAL_TIM_GET_COMPARE(&htim3, TIM_CHANNEL_2);
+  pwmSavedCompare[PwmChan_MotorRight] = __HAL_TIM_GET_COMPARE(&htim3, TIM_CHANNEL_1);
+  pwmSavedCompare[PwmChan_PadLed] = __HAL_TIM_GET_COMPARE(&htim1, TIM_CHANNEL_1);
+
+  __HAL_TIM_SET_COMPARE(&htim3, TIM_CHANNEL_1, 0);
+  __HAL_TIM_SET_COMPARE(&htim3, TIM_CHANNEL_2, 0);
+  __HAL_TIM_SET_COMPARE(&htim1, TIM_CHANNEL_1, 0);
+  // 比较寄存器带预装载, 产生更新事件立即生效
+  htim3.Instance->EGR = TIM_EGR_UG;
+  htim1.Instance->EGR = TIM_EGR_UG;
+
+  // __HAL_TIM_DISABLE在通道使能时不会关闭计数器
+  CLEAR_BIT(htim3.Instance->CR1, TIM_CR1_CEN);
+  CLEAR_BIT(htim1.Instance->CR1, TIM_CR1_CEN);
+}
+
+void PwmResume(void)
+{
+  __HAL_TIM_SET_COMPARE(&htim3, TIM_CHANNEL_2, pwmSavedCompare[PwmChan_MotorLeft]);
+  __HAL_TIM_SET_COMPARE(&htim3, TIM_CHANNEL_1, pwmSavedCompare[PwmChan_MotorRight]);
+  __HAL_TIM_SET_COMPARE(&htim1, TIM_CHANNEL_1, pwmSavedCompare[PwmChan_PadLed]);
+
+  SET_BIT(htim3.Instance->CR1, TIM_CR1_CEN);
+  SET_BIT(htim1.Instance->CR1, TIM_CR1_CEN);
+}
 /* USER CODE END 1 */
@@ -55,10 +55,6 @@ void MX_USART1_UART_Init(void)
   GPIO_InitStruct.Mode = LL_GPIO_MODE_FLOATING;
   LL_GPIO_Init(GPIOA, &GPIO_InitStruct);
 
-  /* USART1 interrupt Init */
-  NVIC_SetPriority(USART1_IRQn, NVIC_EncodePriority(NVIC_GetPriorityGrouping(),3, 0));
-  NVIC_EnableIRQ(USART1_IRQn);
-
   /* USER CODE BEGIN USART1_Init 1 */
 
   /* USER CODE END USART1_Init 1 */
@@ -73,30 +69,11 @@ void MX_USART1_UART_Init(void)
   LL_USART_ConfigAsyncMode(USART1);
   LL_USART_Enable(USART1);
   /* USER CODE BEGIN USART1_Init 2 */
-
+  Usart1Tx_Init(3);
   /* USER CODE END USART1_Init 2 */
 
 }
 
 /* USER CODE BEGIN 1 */
-#include "stdio.h"
-
-CL_QUEUE_DEF_INIT(usart1SendQueue, 1024, uint8_t, );
-
-
-FILE __stdout;
-
-void _sys_exit(int x)
-{
-    x = x;
-}
-
-int fputc(int ch, FILE *f)
-{
-    uint8_t data = ch;
-    CL_QueueAdd(&usart1SendQueue, &data);
-    LL_USART_EnableIT_TXE(USART1);
-    return ch;
-}
 
 /* USER CODE END 1 */
@@ -49,6 +49,10 @@ EndBSPDependencies */
 #include "cl_serialize.h"
 #include "cl_log.h"
 #include "pad_func.h"
+#include "profile.h"
+#include "pad_cmd.h"
+#include "haptics.h"
+#include "led.h"
 
 /** @addtogroup STM32_USB_DEVICE_LIBRARY
   * @{
@@ -112,6 +116,8 @@ static uint8_t  *USBD_HID_GetDeviceQualifierDesc(uint16_t *length);
 static uint8_t  USBD_HID_DataIn(USBD_HandleTypeDef *pdev, uint8_t epnum);
 
 static uint8_t USBD_HID_DataOut(struct _USBD_HandleTypeDef *pdev, uint8_t epnum);
+
+static uint8_t USBD_HID_EP0_RxReady(USBD_HandleTypeDef *pdev);
 /**
   * @}
   */
@@ -126,7 +132,7 @@ USBD_ClassTypeDef  USBD_HID =
   USBD_HID_DeInit,
   USBD_HID_Setup,
   NULL, /*EP0_TxSent*/
-  NULL, /*EP0_RxReady*/
+  USBD_HID_EP0_RxReady, /*EP0_RxReady*/
   USBD_HID_DataIn, /*DataIn*/
   USBD_HID_DataOut, /*DataOut*/
   NULL, /*SOF */
@@ -141,7 +147,7 @@ USBD_ClassTypeDef  USBD_HID =
 /* USB HID device FS Configuration Descriptor */
 __ALIGN_BEGIN static uint8_t USBD_HID_CfgFSDesc[]  __ALIGN_END =
 {
-    0x09, 0x02, 0x8B, 0x00, 0x04, 0x01, 0x00, 0xA0, 0xFA, //todo remote wakeup
+    0x09, 0x02, 0x8B, 0x00, 0x04, 0x01, 0x00, 0xA0, 0xFA, // 总线供电, 支持远程唤醒(XBOX键, 见power.c)
     0x09, 0x04, 0x00, 0x00, 0x02, 0xFF, 0x5D, 0x01, 0x00,
     0x11, 0x21, 0x10, 0x01, 0x01, 0x25, 0x81, 0x14, 0x03, 0x03, 0x03, 0x04, 0x13, 0x02, 0x08, 0x03, 0x03,
     0x07, 0x05, 0x81, 0x03, 0x20, 0x00, 0x04,
@@ -257,6 +263,58 @@ static uint8_t  USBD_HID_DeInit(USBD_HandleTypeDef *pdev,
   return USBD_OK;
 }
 
+// 配置命令, 写命令的数据阶段在EP0_RxReady中处理
+static uint32_t padCmdBuff[PAD_CMD_MAX_LEN / 4];
+static uint16_t padCmdValue = 0;
+static uint16_t padCmdLen = 0;
+
+static USBD_StatusTypeDef USBD_HID_PadCmdSetup(USBD_HandleTypeDef *pdev, USBD_SetupReqTypedef *req)
+{
+  if (req->bmRequest & 0x80U)
+  {
+    int len = PadCmd_OnRead(req->wValue, (uint8_t *)padCmdBuff, sizeof(padCmdBuff));
+    if (len < 0)
+    {
+      USBD_CtlError(pdev, req);
+      return USBD_FAIL;
+    }
+    USBD_CtlSendData(pdev, (uint8_t *)padCmdBuff, MIN((uint16_t)len, req->wLength));
+  }
+  else if (req->wLength == 0U)
+  { // 无数据阶段, 接收者为接口时状态阶段由协议栈发送
+    if (PadCmd_OnWrite(req->wValue, NULL, 0) != CL_ResSuccess)
+    {
+      USBD_CtlError(pdev, req);
+      return USBD_FAIL;
+    }
+    if ((req->bmRequest & USB_REQ_RECIPIENT_MASK) == USB_REQ_RECIPIENT_DEVICE)
+      USBD_CtlSendStatus(pdev);
+  }
+  else if (req->wLength <= sizeof(padCmdBuff))
+  {
+    padCmdValue = req->wValue;
+    padCmdLen = req->wLength;
+    USBD_CtlPrepareRx(pdev, (uint8_t *)padCmdBuff, req->wLength);
+  }
+  else
+  {
+    USBD_CtlError(pdev, req);
+    return USBD_FAIL;
+  }
+  return USBD_OK;
+}
+
+static uint8_t USBD_HID_EP0_RxReady(USBD_HandleTypeDef *pdev)
+{
+  if (padCmdLen > 0)
+  {
+    // 状态阶段已无法返回STALL, 数据无效时丢弃
+    PadCmd_OnWrite(padCmdValue, (const uint8_t *)padCmdBuff, padCmdLen);
+    padCmdLen = 0;
+  }
+  return USBD_OK;
+}
+
 /**
   * @brief  USBD_HID_Setup
   *         Handle the HID specific requests
@@ -276,7 +334,11 @@ static uint8_t  USBD_HID_Setup(USBD_HandleTypeDef *pdev,
   switch (req->bmRequest & USB_REQ_TYPE_MASK)
   {
     case USB_REQ_TYPE_VENDOR:
-      if (req->bmRequest == 0xc1 && req->bRequest == 0x01)
+      if (req->bRequest == PAD_CMD_REQUEST)
+      {
+        ret = USBD_HID_PadCmdSetup(pdev, req);
+      }
+      else if (req->bmRequest == 0xc1 && req->bRequest == 0x01)
       {
         if (req->wValue >> 8 == 1)
         {
@@ -410,7 +472,7 @@ CL_Result_t USBD_SendPadReport(USBD_HandleTypeDef *pdev, const PadReport_t* repo
                                   0x00, 0x00, 0x00, 0x00, 0x00, 
                                   0x00, 0x00, 0x00, 0x00, 0x00, 
                                   0x00, 0x00, 0x00, 0x00, 0x00};
-      PadHidReportSerialize(inputReportData, report);
+      PROFILE_RUN(ReportSerialize, PadHidReportSerialize(inputReportData, report));
 
       hhid->state = HID_BUSY;
       USBD_LL_Transmit(pdev, 0x81, inputReportData, sizeof(inputReportData));
@@ -501,13 +563,25 @@ static uint8_t USBD_HID_DataOut(struct _USBD_HandleTypeDef *pdev, uint8_t epnum)
 {
     //if([0] == 0x00 && [1] == 0x08)
     //  [3] = left motor, [4] = right motor
+    //if([0] == 0x01 && [1] == 0x03)
+    //  [2] = led pattern, 2~5: 玩家1~4闪烁后常亮, 6~9: 玩家1~4常亮
     if(epnum == 2)
     {
       uint32_t len = USBD_LL_GetRxDataSize(pdev, 0x02);
       if(ep2RecvBuff[0] == 0 && ep2RecvBuff[1] == 8)
       {
-        SetPadVibration(PadVbrtIdx_LeftBottom, ep2RecvBuff[3]);
-        SetPadVibration(PadVbrtIdx_RightBottom, ep2RecvBuff[4]);
+        // 投递到震动邮箱, 由TIM3更新中断写入比较寄存器, 不等待上报任务
+        Haptics_Post(ep2RecvBuff[3], ep2RecvBuff[4]);
+      }
+      else if(ep2RecvBuff[0] == 1 && ep2RecvBuff[1] == 3)
+      {
+        uint8_t pattern = ep2RecvBuff[2];
+        if(pattern >= 2 && pattern <= 5)
+          SetPadLedPlayer(pattern - 1);
+        else if(pattern >= 6 && pattern <= 9)
+          SetPadLedPlayer(pattern - 5);
+        else
+          SetPadLedPlayer(0);
       }
       // CL_LOG_INFO("len: %u---", len);
       // for(uint32_t i = 0; i < len; i++)
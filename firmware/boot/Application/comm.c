@@ -39,6 +39,11 @@ CL_Result_t SgpAcmSendFunc(const uint8_t *buff, uint16_t count)
 }
 //--------------------------------------------------------
 
+bool Comm_IsSendIdle(void)
+{
+    return CL_QueueLength(&sendQueue) == 0;
+}
+
 void Comm_Init(void)
 {
     SgpProtocol_AddChannel(SpgChannelHandle_Acm, SgpAcmSendFunc);
@@ -6,6 +6,7 @@
 
 void Comm_Init(void);
 void Comm_Process(void);
+bool Comm_IsSendIdle(void); // 发送队列已全部交给USB
 
 uint8_t *Comm_GetRecvBuff(void);
 bool Comm_RecvDone(uint32_t len);
@@ -1,6 +1,8 @@
 #include "dfu.h"
 #include "flash_layout.h"
 #include "cl_log.h"
+#include "trace.h"
+#include "profile.h"
 #include "systime.h"
 #include "cl_event_system.h"
 #include "sgp_protocol.h"
@@ -37,6 +39,7 @@ typedef struct
     uint32_t fileSize;
     uint32_t recvSize;
     uint32_t lastCommTime;
+    uint32_t jumpTime;
     uint16_t packCount;
 } DfuContext_t;
 
@@ -46,6 +49,7 @@ static DfuContext_t dfuContext = {
     .recvSize = 0,
     .packCount = 0,
     .lastCommTime = 0,
+    .jumpTime = 0,
 };
 
 static bool OnRecvSgpMsg(void *eventArg);
@@ -86,6 +90,7 @@ static void ToCheckApp(void)
 static void ToJump(void)
 {
     dfuContext.status = DfuStatus_Jump;
+    dfuContext.jumpTime = GetSysTime();
     HAL_FLASH_Lock();
 }
 
@@ -150,6 +155,9 @@ void Dfu_Process(void)
         }
         break;
     case DfuStatus_Jump:
+        // 等发送队列中的回复(校验结果)发出再复位, 最多等100ms
+        if (!Comm_IsSendIdle() && SysTimeSpan(dfuContext.jumpTime) < 100)
+            break;
         UnmarkDfu();
         DelayOnSysTime(100);
         NVIC_SystemReset();
@@ -195,7 +203,7 @@ static void OnRecvBootVerReq(void)
 
 static void OnRecvAppVerReq(void)
 {
-    const FirmwareInfo_t *pAppInfo = (const FirmwareInfo_t *)0x8013800;
+    const FirmwareInfo_t *pAppInfo = (const FirmwareInfo_t *)ReadFlash(APP_FW_INFO_ADDR);
     uint8_t data[14];
     memcpy(data, PRODUCT_APP_STR, 10);
     data[10] = pAppInfo->verMajor;
@@ -223,7 +231,11 @@ void OnRecvDfuRequest(const SgpPacket_t *pack)
             return;
         }
         HAL_FLASH_Unlock();
-        EraseAppSection();
+        if (InvalidateAppInfo() != CL_ResSuccess || EraseAppSection() != CL_ResSuccess)
+        {
+            ToError();
+            return;
+        }
         ToRecvFile(fileSize);
         SendDfuReady();
         SetLastCommTime();
@@ -245,7 +257,6 @@ static void OnRecvDfuData(const SgpPacket_t *pack)
         uint16_t packCount = CL_BytesToUint16(pack->data, CL_BigEndian);
         if (packCount == dfuContext.packCount)
         {
-            dfuContext.packCount++;
             uint16_t bytesInPack = pack->length - 2;
             if (dfuContext.recvSize + bytesInPack > dfuContext.fileSize)
             {
@@ -254,15 +265,25 @@ static void OnRecvDfuData(const SgpPacket_t *pack)
             }
 
             ToggleLed();
-            CL_Result_t res = WriteFlash(APP_START_ADDR + dfuContext.recvSize, pack->data + 2, bytesInPack);
+            CL_Result_t res;
+            PROFILE_RUN(DfuWrite, res = WriteFlash(APP_START_ADDR + dfuContext.recvSize, pack->data + 2, bytesInPack));
+            if (res != CL_ResSuccess)
+            { // 写入失败后偏移无法对齐, 放弃本次升级
+                SendDfuDataRsp(packCount, 0);
+                ToError();
+                return;
+            }
+
+            // 仅在写入成功后推进, 保证recvSize <= fileSize且已接收部分全部写入
+            dfuContext.packCount++;
             dfuContext.recvSize += bytesInPack;
-            CL_LOG_INFO("dfu pack: %hu--%hu, recv size: %u", packCount, bytesInPack, dfuContext.recvSize);
-            SendDfuDataRsp(packCount, res == CL_ResSuccess ? 1 : 0);
+            TRACE3("dfu pack: %hu--%hu, recv size: %u", packCount, bytesInPack, dfuContext.recvSize);
+            SendDfuDataRsp(packCount, 1);
             SetLastCommTime();
         }
         else if (dfuContext.packCount == (packCount + 1) && dfuContext.packCount > 0)
         {
-            CL_LOG_INFO("rsp last pack");
+            TRACE1("rsp last pack: %hu", packCount);
             SendDfuDataRsp(packCount, 1);
             SetLastCommTime();
         }
@@ -277,7 +298,7 @@ CL_Result_t VerifyApp(const SgpPacket_t *pack)
     if (pack->length != 64)
         return CL_ResFailed;
 
-    return SingCheck((const uint8_t *)APP_START_ADDR, dfuContext.recvSize, (const uint8_t *)pack->data, pack->length);
+    return SingCheck(ReadFlash(APP_START_ADDR), dfuContext.recvSize, (const uint8_t *)pack->data, pack->length);
 }
 
 static void OnRecvDfuVerify(const SgpPacket_t *pack)
@@ -290,11 +311,14 @@ static void OnRecvDfuVerify(const SgpPacket_t *pack)
             return;
         }
 
-        CL_Result_t res = VerifyApp(pack);
+        CL_Result_t res;
+        PROFILE_RUN(DfuVerify, res = VerifyApp(pack));
         uint8_t rsp = 1;
+        if (res == CL_ResSuccess)
+            res = SaveAppInfo(APP_START_ADDR, dfuContext.fileSize);
+
         if (res == CL_ResSuccess)
         {
-            SaveAppInfo(APP_START_ADDR, dfuContext.fileSize);
             CL_LOG_INFO("dfu verity ok");
         }
         else
@@ -303,6 +327,7 @@ static void OnRecvDfuVerify(const SgpPacket_t *pack)
             CL_LOG_INFO("dfu verity failed");
         }
         SendDfuVerifyRsp(rsp);
+        Profile_PrintStat();
         ToCheckApp();
     }
 }
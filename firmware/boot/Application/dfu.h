@@ -12,7 +12,11 @@ bool NeedDfu(void);
 CL_Result_t UnmarkDfu(void);
 CL_Result_t EraseAppSection(void);
 CL_Result_t SaveAppInfo(uint32_t addr, uint32_t size);
+CL_Result_t InvalidateAppInfo(void);
+bool IsAppValid(void);
+
+// 以下为flash底层接口, dfu.c只通过这些接口访问flash
 CL_Result_t EraseFlash(uint32_t addr, uint32_t pages);
 CL_Result_t WriteFlash(uint32_t addr, const uint8_t *buff, uint32_t length);
-bool IsAppValid(void);
+const uint8_t *ReadFlash(uint32_t addr);
 
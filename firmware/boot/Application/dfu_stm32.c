@@ -6,6 +6,7 @@
 #include "mmlib_config.h"
 #include "board.h"
 #include "iflash_stm32.h"
+#include "profile.h"
 
 typedef void (*pFunction)(void);
 pFunction JumpToAddrFunc;
@@ -29,43 +30,82 @@ typedef struct
 
 CL_Result_t EraseAppSection(void)
 {
-    return EraseFlash(APP_START_ADDR, APP_MAX_SIZE / FLASH_PAGE_SIZE);
+    CL_Result_t res;
+    PROFILE_RUN(DfuErase, res = EraseFlash(APP_START_ADDR, APP_MAX_SIZE / FLASH_PAGE_SIZE));
+    return res;
 }
 
 CL_Result_t SaveAppInfo(uint32_t addr, uint32_t size)
 {
     AppInfo_t info;
     info.size = size;
-    info.hash = Ethernet_CRC32((const uint8_t *)addr, size);
-    EraseFlash(DFU_APP_INFO_ADDR, 1);
-    WriteFlash(DFU_APP_INFO_ADDR, (const uint8_t *)&info, sizeof(info));
+    info.hash = Ethernet_CRC32(ReadFlash(addr), size);
+    if (EraseFlash(DFU_APP_INFO_ADDR, 1) != CL_ResSuccess)
+        return CL_ResFailed;
 
-    return CL_ResSuccess;
+    return WriteFlash(DFU_APP_INFO_ADDR, (const uint8_t *)&info, sizeof(info));
+}
+
+// 擦除app前先使信息页失效, 升级中途掉电后不会再校验旧的hash
+CL_Result_t InvalidateAppInfo(void)
+{
+    return EraseFlash(DFU_APP_INFO_ADDR, 1);
 }
 
 bool IsAppValid(void)
 {
-    const AppInfo_t *pInfo = (const AppInfo_t *)DFU_APP_INFO_ADDR;
+    const AppInfo_t *pInfo = (const AppInfo_t *)ReadFlash(DFU_APP_INFO_ADDR);
 
-    if (pInfo->size > APP_MAX_SIZE)
+    if (pInfo->size == 0 || pInfo->size > APP_MAX_SIZE)
         return false;
 
-    uint32_t hash = Ethernet_CRC32((const uint8_t *)APP_START_ADDR, pInfo->size);
+    uint32_t hash;
+    PROFILE_RUN(AppCheck, hash = Ethernet_CRC32(ReadFlash(APP_START_ADDR), pInfo->size));
 
     CL_LOG_INFO("check app, size: %u, calc %x, save: %x", pInfo->size, hash, pInfo->hash);
     return hash == pInfo->hash;
 }
 
+// boot只允许改写app区和app信息页, 地址和长度均来自上位机, 必须检查
+// 两者之间是档案选择记录页和配置档案页, 升级时保留
+static inline bool IsInRegion(uint32_t addr, uint32_t length, uint32_t start, uint32_t end)
+{
+    return addr >= start &&
+           addr <= end &&
+           length <= end - addr;
+}
+
+static inline bool IsInDfuRegion(uint32_t addr, uint32_t length)
+{
+    return IsInRegion(addr, length, APP_START_ADDR, APP_START_ADDR + APP_MAX_SIZE) ||
+           IsInRegion(addr, length, DFU_APP_INFO_ADDR, DFU_APP_INFO_ADDR + FLASH_PAGE_SIZE);
+}
+
 CL_Result_t EraseFlash(uint32_t addr, uint32_t pages)
 {
+    if ((addr - FLASH_BASE) % FLASH_PAGE_SIZE != 0 ||
+        pages > APP_MAX_SIZE / FLASH_PAGE_SIZE ||
+        !IsInDfuRegion(addr, pages * FLASH_PAGE_SIZE))
+    {
+        return CL_ResFailed;
+    }
+
     return IFlashStm32_ErasePages(addr, pages);
 }
 
 CL_Result_t WriteFlash(uint32_t addr, const uint8_t *buff, uint32_t length)
 {
+    if (addr % 2 != 0 || !IsInDfuRegion(addr, length)) // 按半字编程
+        return CL_ResFailed;
+
     return IFlashStm32_Write(addr, buff, length);
 }
 
+const uint8_t *ReadFlash(uint32_t addr)
+{ // 内部flash直接映射
+    return (const uint8_t *)addr;
+}
+
 bool NeedDfu(void)
 {
     LL_APB2_GRP1_EnableClock(GPIO_APB);
@@ -0,0 +1,8 @@
+#pragma once
+
+// 耗时统计阶段, 见profile.h
+#define PROFILE_STAGE_LIST(X) \
+    X(AppCheck)               \
+    X(DfuErase)               \
+    X(DfuWrite)               \
+    X(DfuVerify)
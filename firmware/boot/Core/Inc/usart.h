@@ -29,20 +29,17 @@ extern "C" {
 #include "main.h"
 
 /* USER CODE BEGIN Includes */
-#include "cl_queue.h"
+#include "usart1_tx.h"
 /* USER CODE END Includes */
 
 /* USER CODE BEGIN Private defines */
-CL_QUEUE_DECL(usart1SendQueue);
+
 /* USER CODE END Private defines */
 
 void MX_USART1_UART_Init(void);
 
 /* USER CODE BEGIN Prototypes */
-static inline CL_Result_t Usart1_PollSendByte(volatile uint8_t* out)
-{
-    return CL_QueuePoll(&usart1SendQueue, (void *)out);
-}
+
 /* USER CODE END Prototypes */
 
 #ifdef __cplusplus
@@ -29,6 +29,9 @@
 #include "dfu.h"
 #include "comm.h"
 #include "cl_event_system.h"
+#include "ustime.h"
+#include "trace.h"
+#include "profile.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -86,6 +89,7 @@ void SystemClock_Config(void);
 int main(void)
 {
   /* USER CODE BEGIN 1 */
+  Profile_Init(); // 从boot入口开始计数, app启动时读取
   if (!NeedDfu())
   {
     if (IsAppValid())
@@ -110,6 +114,7 @@ int main(void)
   SystemClock_Config();
 
   /* USER CODE BEGIN SysInit */
+  UsTime_Init();
   UsbFakePlug();
   /* USER CODE END SysInit */
 
@@ -131,6 +136,7 @@ int main(void)
     /* USER CODE BEGIN 3 */
     Comm_Process();
     Dfu_Process();
+    Trace_Process();
 
     static uint32_t lastTime = 0;
     if (SysTimeSpan(lastTime) >= SYSTIME_SECOND(1))
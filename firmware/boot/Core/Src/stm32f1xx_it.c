@@ -214,26 +214,17 @@ void USB_LP_CAN1_RX0_IRQHandler(void)
   /* USER CODE END USB_LP_CAN1_RX0_IRQn 1 */
 }
 
+/* USER CODE BEGIN 1 */
 /**
-  * @brief This function handles USART1 global interrupt.
+  * @brief This function handles DMA1 channel4 global interrupt (USART1_TX).
   */
-void USART1_IRQHandler(void)
+void DMA1_Channel4_IRQHandler(void)
 {
-  /* USER CODE BEGIN USART1_IRQn 0 */
-
-  /* USER CODE END USART1_IRQn 0 */
-  /* USER CODE BEGIN USART1_IRQn 1 */
-  volatile uint8_t data;
-  if (LL_USART_IsActiveFlag_TXE(USART1))
+  if (LL_DMA_IsActiveFlag_TC4(DMA1))
   {
-    if(Usart1_PollSendByte(&data) == CL_ResSuccess)
-      LL_USART_TransmitData8(USART1, data);
-    else
-      LL_USART_DisableIT_TXE(USART1);
+    LL_DMA_ClearFlag_TC4(DMA1);
+    Usart1_OnDmaDone();
   }
-  /* USER CODE END USART1_IRQn 1 */
 }
 
-/* USER CODE BEGIN 1 */
-
 /* USER CODE END 1 */
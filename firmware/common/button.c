@@ -3,7 +3,8 @@
 #include "main.h"
 #include "systime.h"
 #include "string.h"
-#include "cl_log.h"
+#include "trace.h"
+#include "profile.h"
 #include "cl_event_system.h"
 #include "pad_func.h"
 
@@ -31,6 +32,31 @@ static inline bool IsYPress(void)
     return LL_GPIO_IsInputPinSet(BTN_Y_PORT, BTN_Y_PIN);
 }
 
+static inline bool IsXboxPress(void)
+{
+    return LL_GPIO_IsInputPinSet(BTN_XBOX_PORT, BTN_XBOX_PIN);
+}
+
+static inline bool IsUpPress(void)
+{
+    return LL_GPIO_IsInputPinSet(BTN_UP_PORT, BTN_UP_PIN);
+}
+
+static inline bool IsRightPress(void)
+{
+    return LL_GPIO_IsInputPinSet(BTN_RIGHT_PORT, BTN_RIGHT_PIN);
+}
+
+static inline bool IsDownPress(void)
+{
+    return LL_GPIO_IsInputPinSet(BTN_DOWN_PORT, BTN_DOWN_PIN);
+}
+
+static inline bool IsLeftPress(void)
+{
+    return LL_GPIO_IsInputPinSet(BTN_LEFT_PORT, BTN_LEFT_PIN);
+}
+
 const ButtonDef_t buttonDef[BtnIdx_Max] =
     {
         [BtnIdx_Pair] = {
@@ -42,6 +68,21 @@ const ButtonDef_t buttonDef[BtnIdx_Max] =
         [BtnIdx_Y] = {
             .getPress = IsYPress,
         },
+        [BtnIdx_Xbox] = {
+            .getPress = IsXboxPress,
+        },
+        [BtnIdx_Up] = {
+            .getPress = IsUpPress,
+        },
+        [BtnIdx_Right] = {
+            .getPress = IsRightPress,
+        },
+        [BtnIdx_Down] = {
+            .getPress = IsDownPress,
+        },
+        [BtnIdx_Left] = {
+            .getPress = IsLeftPress,
+        },
 };
 
 //********************button context*************************
@@ -72,6 +113,7 @@ void Button_Init(void)
 
 void Button_Process(void)
 {
+    PROFILE_BEGIN(ButtonProcess);
     static uint32_t lastTime = 0;
     if (lastTime == 0)
     {
@@ -99,7 +141,7 @@ void Button_Process(void)
                 if (bc->downTime >= BUTTON_BOUNCE_TIME)
                 { // 持续超过去抖时间,按键改为按下状态
                     bc->status = BtnSta_Press;
-                    CL_LOG_INFO("button down");
+                    TRACE1("button %d down", i);
                     ButtonEvent_t arg = ButtonEvent_Down;
                     CL_EventSysRaise(CL_Event_Button, i, &arg);
                 }
@@ -115,7 +157,7 @@ void Button_Process(void)
                     bc->downTime = 0;
                     bc->status = BtnSta_Up;
                     // 短按事件
-                    CL_LOG_INFO("button %d click", i);
+                    TRACE1("button %d click", i);
                     
                     ButtonEvent_t arg = ButtonEvent_Click;
                     CL_EventSysRaise(CL_Event_Button, i, &arg);
@@ -124,7 +166,7 @@ void Button_Process(void)
                 if (bc->downTime >= BUTTON_LONG_PRESS_TIME)
                 {
                     bc->status = BtnSta_LongPress;
-                    CL_LOG_INFO("button %d long press", i);
+                    TRACE1("button %d long press", i);
 
                     // 长按事件
                     ButtonEvent_t arg = ButtonEvent_LongPress;
@@ -141,11 +183,17 @@ void Button_Process(void)
                 { // 长按松开
                     bc->downTime = 0;
                     bc->status = BtnSta_Up;
-                    CL_LOG_INFO("button up");
+                    TRACE1("button %d up", i);
                     ButtonEvent_t arg = ButtonEvent_LpUp;
                     CL_EventSysRaise(CL_Event_Button, i, &arg);
                 }
             }
         }
     }
+    PROFILE_END(ButtonProcess);
+}
+
+bool Button_IsPressed(ButtonIdx_t idx)
+{
+    return idx < BtnIdx_Max && buttonContext[idx].status != BtnSta_Up;
 }
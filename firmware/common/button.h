@@ -7,6 +7,11 @@ typedef enum
     BtnIdx_Pair = 0,
     BtnIdx_A,
     BtnIdx_Y,
+    BtnIdx_Xbox,
+    BtnIdx_Up,
+    BtnIdx_Right,
+    BtnIdx_Down,
+    BtnIdx_Left,
     BtnIdx_Max,
 } ButtonIdx_t;
 
@@ -25,3 +30,5 @@ void Button_Init(void);
 
 void Button_Process(void);
 
+bool Button_IsPressed(ButtonIdx_t idx); // 去抖后的按下状态, 用于组合键
+
@@ -2,10 +2,17 @@
 #include "main.h"
 
 #define BOOT_MAX_SIZE (68 * 1024ul)
-#define APP_MAX_SIZE (58 * 1024ul)
+#define APP_MAX_SIZE (54 * 1024ul)
 
 #define BOOT_START_ADDR (0x08000000UL)
 #define APP_START_ADDR (BOOT_START_ADDR + BOOT_MAX_SIZE)
+#define APP_FW_INFO_ADDR (APP_START_ADDR + 10 * 1024ul) // 与app_info.c中appFwInfo的段地址一致
 
-#define DFU_APP_INFO_ADDR (APP_START_ADDR + APP_MAX_SIZE)
+// app区之后为档案选择记录页和配置档案1~3, 信息页和档案0(原参数页)地址保持不变, 兼容已保存的参数
+#define DFU_APP_INFO_ADDR (APP_START_ADDR + 58 * 1024ul)
 #define PAD_PARAM_ADDR (DFU_APP_INFO_ADDR + FLASH_PAGE_SIZE)
+
+// 配置档案: 每个一页, 保存完整的校准和设置参数
+#define PAD_PROFILE_COUNT (4)
+#define PAD_PROFILE_SEL_ADDR (APP_START_ADDR + APP_MAX_SIZE) // 当前档案记录, 独占一页
+#define PAD_PROFILE_ADDR(n) ((n) == 0 ? PAD_PARAM_ADDR : PAD_PROFILE_SEL_ADDR + (n) * FLASH_PAGE_SIZE)
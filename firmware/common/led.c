@@ -1,14 +1,15 @@
 #include "led.h"
 #include "board.h"
-#include "systime.h"
-#include "cl_log.h"
+#include "sched.h"
+#include "ustime.h"
+#include "trace.h"
 #include "tim.h"
+#include "math.h"
 
 typedef void (*InitFunc)(void);
 typedef void (*SwitchFunc)(uint8_t brightness);
 
 static void McuStaLed_Switch(uint8_t brightness);
-static void PadLed_Switch(uint8_t brightness);
 
 typedef struct
 {
@@ -24,7 +25,7 @@ typedef enum
 } LedIndex_t;
 
 const LedContext_t ledContext[LedIdx_Max] = {
-    [LedIdx_Pad] = {.initFunc = NULL, .switchFunc = PadLed_Switch},
+    [LedIdx_Pad] = {.initFunc = NULL, .switchFunc = NULL}, // 波形由DMA输出
     [LedIdx_McuStatus] = {.initFunc = NULL, .switchFunc = McuStaLed_Switch},
 };
 
@@ -36,91 +37,123 @@ static void McuStaLed_Switch(uint8_t brightness)
         LL_GPIO_ResetOutputPin(STA_LED_PROT, STA_LED_PIN);
 }
 
-static void PadLed_Switch(uint8_t brightness)
+//----------------pad led-----------------------------
+// 所有样式都预先渲染成gamma校正后的占空比波形, 由TIM1更新事件触发DMA循环写入CCR1,
+// 播放过程不占用CPU, 只在切换样式时重新渲染
+#define PAD_LED_MAX_DUTY (800) // 计数值, 满量程1000
+#define PAD_LED_GAMMA (2.2f)
+#define PAD_LED_WAVE_LEN (250)
+
+static PadLedStyle_t padLedStyle = PadLedStyle_Off;
+static uint8_t padLedPlayer = 0;                   // 0: 未分配
+static volatile uint8_t padLedPendingPlayer = 0xff; // 0xff: 无更新
+static uint16_t padLedWave[PAD_LED_WAVE_LEN];
+
+// x: 感知亮度0~1
+static uint16_t PadLedGamma(float x)
 {
-    PwmSetDuty(PwmChan_PadLed, brightness);
+    return (uint16_t)(powf(x, PAD_LED_GAMMA) * PAD_LED_MAX_DUTY + 0.5f);
 }
 
-//----------------pad led-----------------------------
-static PadLedStyle_t padLedStyle = PadLedStyle_Off;
-static uint8_t padLedCurBn = 0;
-#define PAD_LED_MAX_BN (80)
-void PadLedProc(void)
+static uint16_t RenderFill(uint16_t pos, uint16_t count, uint16_t duty)
 {
-    static uint32_t lastTime = 0;
-    switch (padLedStyle)
+    for (uint16_t i = 0; i < count && pos < PAD_LED_WAVE_LEN; i++)
+        padLedWave[pos++] = duty;
+    return pos;
+}
+
+// 升余弦形状的一次亮灭
+static uint16_t RenderBump(uint16_t pos, uint16_t count)
+{
+    for (uint16_t i = 0; i < count && pos < PAD_LED_WAVE_LEN; i++)
+        padLedWave[pos++] = PadLedGamma((1 - cosf(2 * M_PI * (i + 1) / (count + 1))) / 2);
+    return pos;
+}
+
+// 渲染样式波形, 返回点数, *stepMs为每点时长
+static uint16_t RenderPadLedWave(PadLedStyle_t style, uint8_t player, uint8_t *stepMs)
+{
+    uint16_t len = 0;
+    switch (style)
     {
     case PadLedStyle_On:
-    case PadLedStyle_Off:
-        break;
-    case PadLedStyle_Blink:
-        if (SysTimeSpan(lastTime) >= 200)
+        if (player == 0)
         {
-            lastTime = GetSysTime();
-
-            if (padLedCurBn)
-                padLedCurBn = 0;
-            else
-                padLedCurBn = PAD_LED_MAX_BN;
-
-            ledContext[LedIdx_Pad].switchFunc(padLedCurBn);
+            *stepMs = 10;
+            len = RenderFill(0, 1, PAD_LED_MAX_DUTY);
+            break;
         }
-        break;
-    case PadLedStyle_Breath:
-    {
-        uint32_t breathDelay = 10;
-        if (padLedCurBn < 20)
-            breathDelay += 50;
-        if (SysTimeSpan(lastTime) >= breathDelay)
+        // 玩家编号: 闪烁player次后停顿, 2s一轮
+        *stepMs = 20;
+        for (int i = 0; i < player; i++)
         {
-            lastTime = GetSysTime();
-
-            static uint8_t dir = 1;
-            if (dir)
-            {
-                if (padLedCurBn < PAD_LED_MAX_BN)
-                    padLedCurBn++;
-                if (padLedCurBn >= PAD_LED_MAX_BN)
-                    dir = 0;
-            }
-            else
-            {
-                if (padLedCurBn > 0)
-                    padLedCurBn--;
-                if (padLedCurBn == 0)
-                    dir = 1;
-            }
-            ledContext[LedIdx_Pad].switchFunc(padLedCurBn);
+            len = RenderFill(len, 8, PAD_LED_MAX_DUTY);
+            len = RenderFill(len, 8, 0);
         }
-    }
-    break;
+        len = RenderFill(len, 100 - len, 0);
+        break;
+    case PadLedStyle_Blink: // 200ms亮, 200ms灭
+        *stepMs = 50;
+        len = RenderFill(len, 4, PAD_LED_MAX_DUTY);
+        len = RenderFill(len, 4, 0);
+        break;
+    case PadLedStyle_Breath: // 3s一次呼吸
+        *stepMs = 12;
+        len = RenderBump(0, PAD_LED_WAVE_LEN - 1);
+        len = RenderFill(len, 1, 0);
+        break;
+    case PadLedStyle_Pulse: // 心跳: 连续两次短亮, 1s一轮
+        *stepMs = 20;
+        len = RenderBump(len, 6);
+        len = RenderFill(len, 2, 0);
+        len = RenderBump(len, 6);
+        len = RenderFill(len, 50 - len, 0);
+        break;
+    case PadLedStyle_Off:
     default:
+        *stepMs = 10;
+        len = RenderFill(0, 1, 0);
         break;
     }
+    return len;
+}
+
+static void PlayPadLed(void)
+{
+    uint8_t stepMs;
+    // 先停止DMA再渲染, 渲染期间保持最后输出的亮度
+    PwmPlayPadLedWave(padLedWave, 0, 0);
+    uint16_t len = RenderPadLedWave(padLedStyle, padLedPlayer, &stepMs);
+    PwmPlayPadLedWave(padLedWave, len, stepMs);
 }
+
+void PadLedProc(void)
+{ // 周期任务, 只处理主机下发的玩家编号
+    uint8_t player = padLedPendingPlayer;
+    if (player == 0xff)
+        return;
+
+    padLedPendingPlayer = 0xff;
+    if (player == padLedPlayer)
+        return;
+
+    padLedPlayer = player;
+    if (padLedStyle == PadLedStyle_On)
+        PlayPadLed();
+}
+
 void SetPadLedStyle(PadLedStyle_t style)
 {
     if (padLedStyle == style)
         return;
-        
-    switch (style)
-    {
-    case PadLedStyle_On:
-        padLedCurBn = PAD_LED_MAX_BN;
-        ledContext[LedIdx_Pad].switchFunc(padLedCurBn);
-        break;
-    case PadLedStyle_Off:
-        padLedCurBn = 0;
-        ledContext[LedIdx_Pad].switchFunc(padLedCurBn);
-        break;
-    case PadLedStyle_Blink:
-        break;
-    case PadLedStyle_Breath:
-        break;
-    default:
-        break;
-    }
+
     padLedStyle = style;
+    PlayPadLed();
+}
+
+void SetPadLedPlayer(uint8_t player)
+{
+    padLedPendingPlayer = CL_MIN(player, PAD_LED_MAX_PLAYER);
 }
 //-----------------status led-------------------------
 static McuLedStyle_t mcuLedStyle = McuLedStyle_SlowBlink;
@@ -134,17 +167,12 @@ void McuLedProc(void)
     else if (mcuLedStyle == McuLedStyle_SlowBlink)
         blinkInterval = 1500;
 
-    static uint32_t lastTime = 0;
     static bool ledOn = false;
-    if (SysTimeSpan(lastTime) >= blinkInterval)
-    {
-        lastTime = GetSysTime();
-
-        ledOn = !ledOn;
-        ledContext[LedIdx_McuStatus].switchFunc(ledOn);
+    ledOn = !ledOn;
+    ledContext[LedIdx_McuStatus].switchFunc(ledOn);
 
-        CL_LOG_INFO("ble led: %d", ledOn);
-    }
+    TRACE1("ble led: %d", ledOn);
+    Sched_DelayCurrent(USTIME_MS(blinkInterval));
 }
 
 void SetMcuLedStyle(McuLedStyle_t style)
@@ -161,8 +189,3 @@ void Led_Init(void)
     }
 }
 
-void Led_Process(void)
-{
-    McuLedProc();
-    PadLedProc();
-}
@@ -5,7 +5,9 @@
 
 void Led_Init(void);
 
-void Led_Process(void);
+// 由调度器周期调用
+void McuLedProc(void);
+void PadLedProc(void);
 
 
 typedef enum
@@ -24,6 +26,11 @@ typedef enum
     PadLedStyle_On,
     PadLedStyle_Blink,
     PadLedStyle_Breath,
+    PadLedStyle_Pulse,
 } PadLedStyle_t;
 
+#define PAD_LED_MAX_PLAYER (4)
+
 void SetPadLedStyle(PadLedStyle_t style);
+// 主机分配的玩家编号1~4, 0为未分配; 常亮样式下闪烁编号次数, 可在中断中调用
+void SetPadLedPlayer(uint8_t player);
@@ -0,0 +1,93 @@
+#include "profile.h"
+
+#if PROFILE_ENABLE
+
+#include "cl_log.h"
+#include "stdio.h"
+#include "string.h"
+
+static const char *const stageName[ProfStage_Max] = {
+#define PROFILE_STAGE_NAME(name) #name,
+    PROFILE_STAGE_LIST(PROFILE_STAGE_NAME)
+#undef PROFILE_STAGE_NAME
+};
+
+static ProfStat_t profStat[ProfStage_Max];
+
+void Profile_Init(void)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    Profile_Reset();
+}
+
+void Profile_Record(ProfStage_t stage, uint32_t cycles)
+{
+    ProfStat_t *stat = &profStat[stage];
+    stat->count++;
+    stat->sum += cycles;
+    if (cycles < stat->min)
+        stat->min = cycles;
+    if (cycles > stat->max)
+        stat->max = cycles;
+
+    uint32_t bin = 32 - __CLZ(cycles); // 0周期为第0桶
+    if (bin >= PROFILE_HIST_BINS)
+        bin = PROFILE_HIST_BINS - 1;
+    stat->hist[bin]++;
+}
+
+const ProfStat_t *Profile_GetStat(ProfStage_t stage)
+{
+    if (stage >= ProfStage_Max)
+        return NULL;
+
+    return &profStat[stage];
+}
+
+void Profile_Reset(void)
+{
+    memset(profStat, 0, sizeof(profStat));
+    for (int i = 0; i < ProfStage_Max; i++)
+        profStat[i].min = UINT32_MAX;
+}
+
+void Profile_PrintStat(void)
+{
+    uint32_t cyclePerUs = SystemCoreClock / 1000000UL;
+    for (int i = 0; i < ProfStage_Max; i++)
+    {
+        const ProfStat_t *stat = &profStat[i];
+        if (stat->count == 0)
+            continue;
+
+        uint32_t mean = stat->sum / stat->count;
+        CL_LOG_INFO("%s: count %u, min %u, max %u, mean %u cycles (%u.%02u us)",
+                    stageName[i],
+                    stat->count,
+                    stat->min,
+                    stat->max,
+                    mean,
+                    mean / cyclePerUs,
+                    mean % cyclePerUs * 100 / cyclePerUs);
+
+        // 只打印非空桶, 格式: 桶上限位数:次数
+        char line[200] = {0};
+        int len = 0;
+        for (int bin = 0; bin < PROFILE_HIST_BINS && len < sizeof(line) - 16; bin++)
+        {
+            if (stat->hist[bin] == 0)
+                continue;
+
+            if (bin < PROFILE_HIST_BINS - 1)
+                len += snprintf(line + len, sizeof(line) - len, " <2^%d:%u", bin, stat->hist[bin]);
+            else
+                len += snprintf(line + len, sizeof(line) - len, " >=2^%d:%u", bin - 1, stat->hist[bin]);
+        }
+        CL_LOG_INFO("%s hist:%s", stageName[i], line);
+    }
+}
+
+#endif
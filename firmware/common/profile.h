@@ -0,0 +1,69 @@
+#pragma once
+
+#include "cl_common.h"
+#include "main.h"
+#include "profile_stage.h"
+
+// DWT周期计数器分段耗时统计, 记录次数/最小/最大/平均及log2直方图
+// 阶段列表由各工程的profile_stage.h定义, 仅在主循环上下文使用
+// PROFILE_ENABLE为0时宏展开为空或原语句, 不占用代码和RAM; 默认关闭, 调试时在工程中定义为1
+
+#ifndef PROFILE_ENABLE
+#define PROFILE_ENABLE (0)
+#endif
+
+#define PROFILE_HIST_BINS (20) // 第n桶: [2^(n-1), 2^n)周期, 最后一桶包含更大值
+
+typedef enum
+{
+#define PROFILE_STAGE_ENUM(name) ProfStage_##name,
+    PROFILE_STAGE_LIST(PROFILE_STAGE_ENUM)
+#undef PROFILE_STAGE_ENUM
+    ProfStage_Max,
+} ProfStage_t;
+
+typedef struct
+{
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint64_t sum;
+    uint32_t hist[PROFILE_HIST_BINS];
+} ProfStat_t;
+
+#if PROFILE_ENABLE
+#define PROFILE_BEGIN(stage) uint32_t profStart_##stage = Profile_Now()
+#define PROFILE_END(stage) Profile_Record(ProfStage_##stage, Profile_Now() - profStart_##stage)
+#define PROFILE_RUN(stage, ...)                                          \
+    do                                                                   \
+    {                                                                    \
+        uint32_t profStart = Profile_Now();                              \
+        __VA_ARGS__;                                                     \
+        Profile_Record(ProfStage_##stage, Profile_Now() - profStart);    \
+    } while (0)
+#else
+#define PROFILE_BEGIN(stage)
+#define PROFILE_END(stage)
+#define PROFILE_RUN(stage, ...) \
+    do                          \
+    {                           \
+        __VA_ARGS__;            \
+    } while (0)
+#endif
+
+static inline uint32_t Profile_Now(void)
+{
+    return DWT->CYCCNT;
+}
+
+#if PROFILE_ENABLE
+void Profile_Init(void);
+void Profile_Record(ProfStage_t stage, uint32_t cycles);
+const ProfStat_t *Profile_GetStat(ProfStage_t stage);
+void Profile_Reset(void);
+void Profile_PrintStat(void);
+#else
+static inline void Profile_Init(void) {}
+static inline void Profile_Reset(void) {}
+static inline void Profile_PrintStat(void) {}
+#endif
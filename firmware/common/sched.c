@@ -0,0 +1,211 @@
+#include "sched.h"
+#include "main.h"
+#include "ustime.h"
+#include "cl_log.h"
+#include "string.h"
+
+#define SCHED_SLEEP_MIN (20) // us, 距最近截止时间小于该值时不休眠, 覆盖设置闹钟和唤醒的开销
+
+typedef struct
+{
+    SchedTaskFunc func;
+    const char *name;
+    SchedPrio_t prio;
+    uint32_t period;
+    uint32_t deadline;
+    bool active;
+    bool delayOverride;
+    SchedTaskStat_t stat;
+} SchedTask_t;
+
+static SchedTask_t schedTask[SCHED_MAX_TASK];
+static uint8_t taskCount = 0;
+static SchedTaskId_t curTask = SCHED_INVALID_ID;
+static SchedIdleStat_t idleStat = {0};
+
+static inline bool IsValidId(SchedTaskId_t id)
+{
+    return id >= 0 && id < taskCount;
+}
+
+SchedTaskId_t Sched_AddTask(SchedTaskFunc func, uint32_t period, SchedPrio_t prio, const char *name)
+{
+    if (taskCount >= SCHED_MAX_TASK || func == NULL)
+        return SCHED_INVALID_ID;
+
+    SchedTask_t *task = &schedTask[taskCount];
+    memset(task, 0, sizeof(SchedTask_t));
+    task->func = func;
+    task->name = name;
+    task->prio = prio;
+    task->period = period;
+    task->deadline = GetUsTime();
+    task->active = period > 0; // 周期任务立即开始
+
+    return taskCount++;
+}
+
+void Sched_Start(SchedTaskId_t id, uint32_t delay)
+{
+    if (!IsValidId(id))
+        return;
+
+    schedTask[id].deadline = GetUsTime() + delay;
+    schedTask[id].active = true;
+    if (id == curTask)
+        schedTask[id].delayOverride = true;
+}
+
+void Sched_Stop(SchedTaskId_t id)
+{
+    if (!IsValidId(id))
+        return;
+
+    schedTask[id].active = false;
+    if (id == curTask)
+        schedTask[id].delayOverride = true;
+}
+
+void Sched_SetPeriod(SchedTaskId_t id, uint32_t period)
+{
+    if (!IsValidId(id))
+        return;
+
+    schedTask[id].period = period;
+}
+
+void Sched_DelayCurrent(uint32_t delay)
+{
+    Sched_Start(curTask, delay);
+}
+
+static SchedTaskId_t FindDueTask(uint32_t now)
+{
+    SchedTaskId_t due = SCHED_INVALID_ID;
+    for (SchedTaskId_t i = 0; i < taskCount; i++)
+    {
+        SchedTask_t *task = &schedTask[i];
+        if (!task->active)
+            continue;
+
+        if (UsTimeBefore(now, task->deadline))
+            continue; // 未到期
+
+        if (due == SCHED_INVALID_ID ||
+            task->prio < schedTask[due].prio ||
+            (task->prio == schedTask[due].prio && UsTimeBefore(task->deadline, schedTask[due].deadline)))
+        {
+            due = i;
+        }
+    }
+    return due;
+}
+
+// 最早的截止时间, 没有活动任务时返回false
+static bool NextDeadline(uint32_t *deadline)
+{
+    bool found = false;
+    for (SchedTaskId_t i = 0; i < taskCount; i++)
+    {
+        SchedTask_t *task = &schedTask[i];
+        if (!task->active)
+            continue;
+
+        if (!found || UsTimeBefore(task->deadline, *deadline))
+            *deadline = task->deadline;
+        found = true;
+    }
+    return found;
+}
+
+static void RunTask(SchedTaskId_t id, uint32_t now)
+{
+    SchedTask_t *task = &schedTask[id];
+    uint32_t deadline = task->deadline;
+
+    task->delayOverride = false;
+    curTask = id;
+    task->func();
+    curTask = SCHED_INVALID_ID;
+
+    uint32_t runTime = UsTimeSpan(now);
+    task->stat.runCount++;
+    task->stat.lastRunTime = runTime;
+    task->stat.totalRunTime += runTime;
+    if (runTime > task->stat.maxRunTime)
+        task->stat.maxRunTime = runTime;
+
+    if (task->delayOverride)
+        return; // 任务自己指定了下次运行时间
+
+    if (task->period == 0)
+    { // 单次任务
+        task->active = false;
+    }
+    else if (UsTimeDiff(deadline, now) >= task->period)
+    { // 错过了整个周期, 不补跑
+        task->stat.overrunCount++;
+        task->deadline = now + task->period;
+    }
+    else
+    {
+        task->deadline = deadline + task->period;
+    }
+}
+
+void Sched_Run(void)
+{
+    uint32_t now = GetUsTime();
+    SchedTaskId_t due = FindDueTask(now);
+    if (due != SCHED_INVALID_ID)
+    {
+        RunTask(due, now);
+        return;
+    }
+
+    // 关中断后重新确认: 检查之后中断里启动的任务也能看到,
+    // 此时挂起的中断会让WFI立即返回, 开中断后再处理
+    __disable_irq();
+    uint32_t next;
+    bool hasNext = NextDeadline(&next);
+    now = GetUsTime();
+    if (!hasNext || UsTimeBefore(now + SCHED_SLEEP_MIN, next))
+    {
+        if (hasNext)
+            UsTime_SetAlarm(next);
+        __WFI();
+        UsTime_CancelAlarm();
+        idleStat.idleTime += UsTimeSpan(now);
+        idleStat.idleCount++;
+    }
+    __enable_irq();
+}
+
+const SchedTaskStat_t *Sched_GetTaskStat(SchedTaskId_t id)
+{
+    if (!IsValidId(id))
+        return NULL;
+
+    return &schedTask[id].stat;
+}
+
+const SchedIdleStat_t *Sched_GetIdleStat(void)
+{
+    return &idleStat;
+}
+
+void Sched_PrintStat(void)
+{
+    CL_LOG_INFO("sched idle: %u us, %u times", idleStat.idleTime, idleStat.idleCount);
+    for (SchedTaskId_t i = 0; i < taskCount; i++)
+    {
+        const SchedTaskStat_t *stat = &schedTask[i].stat;
+        CL_LOG_INFO("%s: run %u, last %u us, max %u us, total %u us, overrun %u",
+                    schedTask[i].name,
+                    stat->runCount,
+                    stat->lastRunTime,
+                    stat->maxRunTime,
+                    stat->totalRunTime,
+                    stat->overrunCount);
+    }
+}
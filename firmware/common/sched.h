@@ -0,0 +1,51 @@
+#pragma once
+
+#include "cl_common.h"
+
+// 协作式截止时间调度器, 时间单位us
+// period > 0: 周期任务; period == 0: 单次任务, 由Sched_Start触发
+// 多个任务同时到期时, 优先级高的先运行, 同优先级按截止时间先后
+
+#define SCHED_MAX_TASK (12)
+#define SCHED_INVALID_ID (-1)
+
+typedef int8_t SchedTaskId_t;
+typedef void (*SchedTaskFunc)(void);
+
+typedef enum
+{
+    SchedPrio_High = 0,
+    SchedPrio_Normal,
+    SchedPrio_Low,
+} SchedPrio_t;
+
+typedef struct
+{
+    uint32_t runCount;
+    uint32_t lastRunTime;  // 最近一次运行耗时
+    uint32_t maxRunTime;   // 最大运行耗时
+    uint32_t totalRunTime; // 累计运行耗时
+    uint32_t overrunCount; // 错过整个周期的次数
+} SchedTaskStat_t;
+
+typedef struct
+{
+    uint32_t idleTime; // WFI累计时间
+    uint32_t idleCount;
+} SchedIdleStat_t;
+
+SchedTaskId_t Sched_AddTask(SchedTaskFunc func, uint32_t period, SchedPrio_t prio, const char *name);
+void Sched_Start(SchedTaskId_t id, uint32_t delay);
+void Sched_Stop(SchedTaskId_t id);
+void Sched_SetPeriod(SchedTaskId_t id, uint32_t period);
+
+// 仅在任务函数内调用, 覆盖当前任务的下次运行时间
+void Sched_DelayCurrent(uint32_t delay);
+
+// 运行一个到期任务; 无到期任务时用闹钟定到最近的截止时间后WFI休眠,
+// 截止时间很近时不休眠, 直接返回由主循环再次检查
+void Sched_Run(void);
+
+const SchedTaskStat_t *Sched_GetTaskStat(SchedTaskId_t id);
+const SchedIdleStat_t *Sched_GetIdleStat(void);
+void Sched_PrintStat(void);
@@ -7,19 +7,22 @@ typedef enum
     SpgCmd_Dfu = 0x01,
 } SpgCmd_t;
 
+// DFU数据段格式, 多字节整数均为大端
+// 升级流程: DfuBootVer/AppVer(可选, 比较版本) -> DfuReq -> DfuReady -> DfuData x N -> DfuVerify
+// 任意阶段10s无通信则放弃本次升级, 设备回到等待请求状态
 typedef enum
 {
-    SgpSubCmd_DfuReq = 0x70,
-    SgpSubCmd_DfuData = 0x71,
-    SgpSubCmd_DfuVerify = 0x72,
-    SgpSubCmd_DfuBootVer = 0x73,
-    SgpSubCmd_AppVer = 0x74,
+    SgpSubCmd_DfuReq = 0x70,       // u32 文件大小, 1 ~ APP_MAX_SIZE; 设备擦除app后回复DfuReady
+    SgpSubCmd_DfuData = 0x71,      // u16 包序号(从0开始) + 数据; 重发上一包时只回复不写入, 其它序号忽略
+    SgpSubCmd_DfuVerify = 0x72,    // 64字节签名, 须在全部数据接收后发送
+    SgpSubCmd_DfuBootVer = 0x73,   // 无数据
+    SgpSubCmd_AppVer = 0x74,       // 无数据
 
-    SgpSubCmd_DfuReady = 0x70 | 0x80,
-    SgpSubCmd_DfuDataRsp = 0x71 | 0x80,
-    SgpSubCmd_DfuVerifyRsp = 0x72 | 0x80,
-    SgpSubCmd_DfuBootVerRsp = 0x73 | 0x80,
-    SgpSubCmd_AppVerRsp = 0x74 | 0x80,
+    SgpSubCmd_DfuReady = 0x70 | 0x80,      // 无数据, 可以开始发送数据
+    SgpSubCmd_DfuDataRsp = 0x71 | 0x80,    // u16 包序号 + u8 结果(1:成功 0:写入失败)
+    SgpSubCmd_DfuVerifyRsp = 0x72 | 0x80,  // u8 结果(1:成功 0:失败), 成功后设备复位进入app
+    SgpSubCmd_DfuBootVerRsp = 0x73 | 0x80, // 10字节PRODUCT_BOOT_STR + u8 major + u8 minor + u16 patch
+    SgpSubCmd_AppVerRsp = 0x74 | 0x80,     // 10字节PRODUCT_APP_STR + u8 major + u8 minor + u16 patch
 
-    SgpSubCmd_DfuError = 0x7f | 0x80,
+    SgpSubCmd_DfuError = 0x7f | 0x80, // 无数据, 本次升级失败, 需重新发送DfuReq
 } SgpSubCmd_t;
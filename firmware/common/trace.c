@@ -0,0 +1,80 @@
+#include "trace.h"
+#include "main.h"
+#include "usart1_tx.h"
+#include "ustime.h"
+
+#if TRACE_ENABLE
+#define TRACE_FLASH_BASE (0x08000000UL)
+#define TRACE_SLOT_MASK (TRACE_SLOT_COUNT - 1)
+
+static TraceRecord_t traceRing[TRACE_SLOT_COUNT];
+static volatile uint8_t traceReady[TRACE_SLOT_COUNT];
+static volatile uint32_t traceHead = 0; // 生产者已预留, 多个上下文竞争
+static volatile uint32_t traceTail = 0; // 消费者已释放, 仅Trace_Process修改
+static uint32_t sendingCount = 0;
+static volatile uint32_t dropCount = 0;
+
+void Trace_Write(const char *fmt, uint32_t argc, uint32_t a0, uint32_t a1, uint32_t a2, uint32_t a3)
+{
+    uint32_t head;
+    do
+    { // LDREX/STREX预留一个槽, 被中断打断时重试
+        head = __LDREXW((volatile uint32_t *)&traceHead);
+        if (head - traceTail >= TRACE_SLOT_COUNT)
+        {
+            __CLREX();
+            dropCount++; // 统计值, 并发时可能少计
+            return;
+        }
+    } while (__STREXW(head + 1, (volatile uint32_t *)&traceHead) != 0);
+
+    TraceRecord_t *rec = &traceRing[head & TRACE_SLOT_MASK];
+    rec->header = (((uint32_t)fmt - TRACE_FLASH_BASE) << 15) | (argc << 12) | TRACE_SYNC;
+    rec->time = GetUsTime();
+    rec->args[0] = a0;
+    rec->args[1] = a1;
+    rec->args[2] = a2;
+    rec->args[3] = a3;
+
+    __DMB();
+    traceReady[head & TRACE_SLOT_MASK] = 1;
+}
+
+uint32_t Trace_GetDropCount(void)
+{
+    return dropCount;
+}
+#endif
+
+void Trace_Process(void)
+{
+    // 文本日志只在行尾启动DMA, 未满一行的部分在这里发出
+    Usart1_Flush();
+
+#if TRACE_ENABLE
+    if (sendingCount > 0)
+    {
+        if (Usart1_IsBlockSending())
+            return;
+
+        for (uint32_t i = 0; i < sendingCount; i++)
+            traceReady[(traceTail + i) & TRACE_SLOT_MASK] = 0;
+        __DMB();
+        traceTail += sendingCount;
+        sendingCount = 0;
+    }
+
+    // 从tail开始取连续已写完的记录, 不跨越缓冲区末尾
+    uint32_t start = traceTail & TRACE_SLOT_MASK;
+    uint32_t pending = traceHead - traceTail;
+    uint32_t count = 0;
+    while (count < pending && start + count < TRACE_SLOT_COUNT && traceReady[start + count])
+        count++;
+
+    if (count == 0)
+        return;
+
+    if (Usart1_SendBlock(&traceRing[start], count * sizeof(TraceRecord_t)) == CL_ResSuccess)
+        sendingCount = count;
+#endif
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "cl_common.h"
+
+// 二进制跟踪日志, 只写入记录, 不在调用处格式化
+// 记录为固定24字节: 头部(格式字符串地址/参数个数/同步字) + us时间戳 + 4个32位参数
+// 由Trace_Process通过USART1 DMA发出, 主机端用trace_decode.py结合axf文件还原文本
+// 格式字符串必须为字面量(位于flash), 参数按32位整数处理, 不支持%f/%s
+// TRACE_ENABLE为0时宏展开为空, 不占用缓冲区RAM; 默认关闭, 调试时在工程中定义为1
+
+#ifndef TRACE_ENABLE
+#define TRACE_ENABLE (0)
+#endif
+
+#ifndef TRACE_SLOT_COUNT
+#define TRACE_SLOT_COUNT (32) // 必须为2的幂
+#endif
+
+#define TRACE_MAX_ARGS (4)
+#define TRACE_SYNC (0xA5) // 非ASCII, 可与文本日志混在同一串口
+
+// header: [31:15]格式字符串相对0x08000000偏移, [14:12]参数个数, [7:0]同步字
+typedef struct
+{
+    uint32_t header;
+    uint32_t time;
+    uint32_t args[TRACE_MAX_ARGS];
+} TraceRecord_t;
+
+#if TRACE_ENABLE
+#define TRACE0(fmt) Trace_Write(fmt, 0, 0, 0, 0, 0)
+#define TRACE1(fmt, a) Trace_Write(fmt, 1, (uint32_t)(a), 0, 0, 0)
+#define TRACE2(fmt, a, b) Trace_Write(fmt, 2, (uint32_t)(a), (uint32_t)(b), 0, 0)
+#define TRACE3(fmt, a, b, c) Trace_Write(fmt, 3, (uint32_t)(a), (uint32_t)(b), (uint32_t)(c), 0)
+#define TRACE4(fmt, a, b, c, d) Trace_Write(fmt, 4, (uint32_t)(a), (uint32_t)(b), (uint32_t)(c), (uint32_t)(d))
+#else
+#define TRACE0(fmt)
+#define TRACE1(fmt, a)
+#define TRACE2(fmt, a, b)
+#define TRACE3(fmt, a, b, c)
+#define TRACE4(fmt, a, b, c, d)
+#endif
+
+// 可在任意上下文(包括中断)调用, 缓冲区满时丢弃
+void Trace_Write(const char *fmt, uint32_t argc, uint32_t a0, uint32_t a1, uint32_t a2, uint32_t a3);
+
+// 在主循环中调用, 发出未满一行的文本日志和已写完的连续记录, 关闭跟踪时也需要调用
+void Trace_Process(void);
+
+#if TRACE_ENABLE
+uint32_t Trace_GetDropCount(void);
+#else
+static inline uint32_t Trace_GetDropCount(void) { return 0; }
+#endif
@@ -0,0 +1,132 @@
+#include "usart1_tx.h"
+#include "main.h"
+#include "stdio.h"
+
+// 发送环形缓冲区, DMA每次发送一段连续数据, 每段只产生一次TC中断
+#define USART1_TX_BUFF_MASK (USART1_TX_BUFF_SIZE - 1)
+#define USART1_TX_KICK_LEVEL (USART1_TX_BUFF_SIZE / 2) // 无换行时积累到此长度也启动发送
+
+typedef enum
+{
+    Usart1Tx_Idle = 0,
+    Usart1Tx_Text,  // 发送环形缓冲区中的一段
+    Usart1Tx_Block, // 发送外部数据块
+} Usart1TxStatus_t;
+
+static uint8_t usart1TxBuff[USART1_TX_BUFF_SIZE];
+static volatile uint32_t usart1TxHead = 0; // 写入位置, 仅fputc修改
+static volatile uint32_t usart1TxTail = 0; // 发送完成位置, 仅DMA中断修改
+static volatile Usart1TxStatus_t usart1TxStatus = Usart1Tx_Idle;
+static uint16_t usart1TxSpan = 0;
+
+FILE __stdout;
+
+void _sys_exit(int x)
+{
+    x = x;
+}
+
+void Usart1Tx_Init(uint32_t dmaPrio)
+{
+    // DMA1通道4: USART1_TX
+    LL_AHB1_GRP1_EnableClock(LL_AHB1_GRP1_PERIPH_DMA1);
+    LL_DMA_DisableChannel(DMA1, LL_DMA_CHANNEL_4);
+    LL_DMA_SetDataTransferDirection(DMA1, LL_DMA_CHANNEL_4, LL_DMA_DIRECTION_MEMORY_TO_PERIPH);
+    LL_DMA_SetChannelPriorityLevel(DMA1, LL_DMA_CHANNEL_4, LL_DMA_PRIORITY_LOW);
+    LL_DMA_SetMode(DMA1, LL_DMA_CHANNEL_4, LL_DMA_MODE_NORMAL);
+    LL_DMA_SetPeriphIncMode(DMA1, LL_DMA_CHANNEL_4, LL_DMA_PERIPH_NOINCREMENT);
+    LL_DMA_SetMemoryIncMode(DMA1, LL_DMA_CHANNEL_4, LL_DMA_MEMORY_INCREMENT);
+    LL_DMA_SetPeriphSize(DMA1, LL_DMA_CHANNEL_4, LL_DMA_PDATAALIGN_BYTE);
+    LL_DMA_SetMemorySize(DMA1, LL_DMA_CHANNEL_4, LL_DMA_MDATAALIGN_BYTE);
+    LL_DMA_SetPeriphAddress(DMA1, LL_DMA_CHANNEL_4, LL_USART_DMA_GetRegAddr(USART1));
+    LL_DMA_EnableIT_TC(DMA1, LL_DMA_CHANNEL_4);
+    LL_USART_EnableDMAReq_TX(USART1);
+
+    LL_USART_Disable(USART1);
+    LL_RCC_ClocksTypeDef rccClocks;
+    LL_RCC_GetSystemClocksFreq(&rccClocks);
+    LL_USART_SetBaudRate(USART1, rccClocks.PCLK2_Frequency, USART1_BAUDRATE);
+    LL_USART_Enable(USART1);
+
+    NVIC_SetPriority(DMA1_Channel4_IRQn, NVIC_EncodePriority(NVIC_GetPriorityGrouping(), dmaPrio, 0));
+    NVIC_EnableIRQ(DMA1_Channel4_IRQn);
+}
+
+static void Usart1_StartDma(const void *data, uint16_t len)
+{
+    LL_DMA_DisableChannel(DMA1, LL_DMA_CHANNEL_4);
+    LL_DMA_SetMemoryAddress(DMA1, LL_DMA_CHANNEL_4, (uint32_t)data);
+    LL_DMA_SetDataLength(DMA1, LL_DMA_CHANNEL_4, len);
+    LL_DMA_EnableChannel(DMA1, LL_DMA_CHANNEL_4);
+}
+
+// 空闲时启动下一段, 调用前须关中断
+static void Usart1_StartNextSpan(void)
+{
+    uint32_t pending = usart1TxHead - usart1TxTail;
+    if (usart1TxStatus != Usart1Tx_Idle || pending == 0)
+        return;
+
+    // 不跨越缓冲区末尾, 回绕部分下一段再发
+    uint32_t start = usart1TxTail & USART1_TX_BUFF_MASK;
+    usart1TxSpan = CL_MIN(pending, USART1_TX_BUFF_SIZE - start);
+    usart1TxStatus = Usart1Tx_Text;
+    Usart1_StartDma(&usart1TxBuff[start], usart1TxSpan);
+}
+
+int fputc(int ch, FILE *f)
+{
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    if (usart1TxHead - usart1TxTail < USART1_TX_BUFF_SIZE) // 满时丢弃
+    {
+        usart1TxBuff[usart1TxHead & USART1_TX_BUFF_MASK] = ch;
+        usart1TxHead++;
+    }
+    // 只在行尾或积累较多时启动, 一行文本只占一次DMA; DMA发送期间写入的数据在下一段一起发出
+    if (ch == '\n' || usart1TxHead - usart1TxTail >= USART1_TX_KICK_LEVEL)
+        Usart1_StartNextSpan();
+    __set_PRIMASK(primask);
+    return ch;
+}
+
+void Usart1_Flush(void)
+{
+    if (usart1TxHead == usart1TxTail)
+        return;
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    Usart1_StartNextSpan();
+    __set_PRIMASK(primask);
+}
+
+CL_Result_t Usart1_SendBlock(const void *data, uint16_t len)
+{
+    CL_Result_t res = CL_ResBusy;
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    if (usart1TxStatus == Usart1Tx_Idle)
+    {
+        usart1TxStatus = Usart1Tx_Block;
+        Usart1_StartDma(data, len);
+        res = CL_ResSuccess;
+    }
+    __set_PRIMASK(primask);
+    return res;
+}
+
+bool Usart1_IsBlockSending(void)
+{
+    return usart1TxStatus == Usart1Tx_Block;
+}
+
+void Usart1_OnDmaDone(void)
+{
+    LL_DMA_DisableChannel(DMA1, LL_DMA_CHANNEL_4);
+    if (usart1TxStatus == Usart1Tx_Text)
+        usart1TxTail += usart1TxSpan;
+    usart1TxStatus = Usart1Tx_Idle;
+    // 已排队的文本接着发, 仍是每段一次DMA
+    Usart1_StartNextSpan();
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "cl_common.h"
+
+// USART1 DMA发送, app与boot共用
+// 文本(printf)写入环形缓冲区, 遇到换行或缓冲区过半时才启动DMA, 不再每个字符启动一次
+// 二进制数据块(trace)直接由DMA发送, 与文本轮流占用通道
+
+// 可在工程宏定义中修改, PCLK2为72MHz时最高4.5Mbaud, 2Mbaud无误差
+#ifndef USART1_BAUDRATE
+#define USART1_BAUDRATE (115200)
+#endif
+
+#ifndef USART1_TX_BUFF_SIZE
+#define USART1_TX_BUFF_SIZE (1024) // 必须为2的幂
+#endif
+
+// 在MX_USART1_UART_Init之后调用, 配置DMA1通道4并设置波特率, dmaPrio为DMA中断抢占优先级
+void Usart1Tx_Init(uint32_t dmaPrio);
+
+// 发出缓冲区中未满一行的文本, 在主循环中周期调用
+void Usart1_Flush(void);
+
+// 发送中返回忙, data在发送完成前必须保持有效
+CL_Result_t Usart1_SendBlock(const void *data, uint16_t len);
+bool Usart1_IsBlockSending(void);
+
+void Usart1_OnDmaDone(void); // DMA发送完成中断中调用
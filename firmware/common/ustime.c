@@ -0,0 +1,94 @@
+#include "ustime.h"
+#include "main.h"
+#include "stm32f1xx_ll_tim.h"
+
+#define USTIME_TIM_LOW (TIM2)
+#define USTIME_TIM_HIGH (TIM4)
+
+void UsTime_Init(void)
+{
+    LL_APB1_GRP1_EnableClock(LL_APB1_GRP1_PERIPH_TIM2);
+    LL_APB1_GRP1_EnableClock(LL_APB1_GRP1_PERIPH_TIM4);
+
+    // 高16位: TIM4外部时钟模式1, 触发源ITR1(TIM2)
+    LL_TIM_SetPrescaler(USTIME_TIM_HIGH, 0);
+    LL_TIM_SetAutoReload(USTIME_TIM_HIGH, 0xffff);
+    LL_TIM_SetTriggerInput(USTIME_TIM_HIGH, LL_TIM_TS_ITR1);
+    LL_TIM_SetClockSource(USTIME_TIM_HIGH, LL_TIM_CLOCKSOURCE_EXT_MODE1);
+
+    // 低16位: TIM2计数1MHz, 溢出时输出TRGO
+    // APB1分频为2, 定时器时钟为HCLK
+    LL_TIM_SetPrescaler(USTIME_TIM_LOW, SystemCoreClock / 1000000UL - 1);
+    LL_TIM_SetAutoReload(USTIME_TIM_LOW, 0xffff);
+    LL_TIM_SetTriggerOutput(USTIME_TIM_LOW, LL_TIM_TRGO_UPDATE);
+    LL_TIM_GenerateEvent_UPDATE(USTIME_TIM_LOW); // 载入预分频
+
+    LL_TIM_SetCounter(USTIME_TIM_LOW, 0);
+    LL_TIM_SetCounter(USTIME_TIM_HIGH, 0);
+    LL_TIM_EnableCounter(USTIME_TIM_HIGH);
+    LL_TIM_EnableCounter(USTIME_TIM_LOW);
+
+    // 闹钟中断, 只在UsTime_SetAlarm后打开CC1中断
+    NVIC_SetPriority(TIM2_IRQn, NVIC_EncodePriority(NVIC_GetPriorityGrouping(), 3, 0));
+    NVIC_EnableIRQ(TIM2_IRQn);
+}
+
+uint32_t GetUsTime(void)
+{
+    uint16_t high, low;
+    do
+    { // 读取期间低位溢出则重读
+        high = LL_TIM_GetCounter(USTIME_TIM_HIGH);
+        low = LL_TIM_GetCounter(USTIME_TIM_LOW);
+    } while (high != LL_TIM_GetCounter(USTIME_TIM_HIGH));
+
+    return ((uint32_t)high << 16) | low;
+}
+
+static uint32_t usTimeHigh = 0;
+static uint32_t usTimeLast = 0;
+
+uint64_t GetUsTime64(void)
+{
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    uint32_t now = GetUsTime();
+    if (now < usTimeLast)
+        usTimeHigh++;
+    usTimeLast = now;
+    uint64_t result = ((uint64_t)usTimeHigh << 32) | now;
+
+    __set_PRIMASK(primask);
+    return result;
+}
+
+void UsTimeUpdate(void)
+{
+    GetUsTime64();
+}
+
+void UsTime_SetAlarm(uint32_t deadline)
+{
+    LL_TIM_OC_SetCompareCH1(USTIME_TIM_LOW, deadline & 0xffff);
+    LL_TIM_ClearFlag_CC1(USTIME_TIM_LOW);
+    LL_TIM_EnableIT_CC1(USTIME_TIM_LOW);
+}
+
+void UsTime_CancelAlarm(void)
+{
+    LL_TIM_DisableIT_CC1(USTIME_TIM_LOW);
+    LL_TIM_ClearFlag_CC1(USTIME_TIM_LOW);
+}
+
+void UsTime_OnAlarm(void)
+{
+    UsTime_CancelAlarm();
+}
+
+void DelayUs(uint32_t us)
+{
+    uint32_t start = GetUsTime();
+    while (UsTimeSpan(start) < us)
+        ;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "cl_common.h"
+
+// 微秒时基: TIM2(低16位, 1MHz) 级联 TIM4(高16位), 32位约71分钟回绕
+// 比较时间请使用 UsTimeSpan/UsTimeDiff, 回绕安全
+
+#define USTIME_MS(x) ((x) * 1000UL)
+#define USTIME_SECOND(x) ((x) * 1000000UL)
+
+void UsTime_Init(void);
+
+uint32_t GetUsTime(void);
+uint64_t GetUsTime64(void);
+
+// 在SysTick中调用, 保证64位时间的高位不会漏计
+void UsTimeUpdate(void);
+
+// 唤醒闹钟: TIM2 CC1与deadline低16位匹配时中断, 只用于把CPU从WFI唤醒
+// deadline超过65ms时会提前唤醒, 由调用者重新判断
+void UsTime_SetAlarm(uint32_t deadline);
+void UsTime_CancelAlarm(void);
+void UsTime_OnAlarm(void); // TIM2中断中调用
+
+static inline uint32_t UsTimeDiff(uint32_t from, uint32_t to)
+{
+    return to - from;
+}
+
+static inline uint32_t UsTimeSpan(uint32_t lastTime)
+{
+    return UsTimeDiff(lastTime, GetUsTime());
+}
+
+// a是否早于b
+static inline bool UsTimeBefore(uint32_t a, uint32_t b)
+{
+    return (int32_t)(a - b) < 0;
+}
+
+void DelayUs(uint32_t us);
@@ -0,0 +1,172 @@
+#include "bench_util.h"
+#include "mock.h"
+#include "dfu.h"
+#include "comm.h"
+#include "flash_layout.h"
+#include "board.h"
+#include "cl_serialize.h"
+#include <setjmp.h>
+#include <stdlib.h>
+
+// boot基准: 一次完整的DFU(请求/擦除/逐包写入/校验) 和 上电到跳转app(检查配对键和app校验)
+// 主机耗时只反映代码路径的相对变化; dfu_flash_est_ms按数据手册的典型擦写时间估算设备上的flash耗时
+
+#define IMAGE_SIZE (48 * 1024ul)
+#define CHUNK_SIZE (128)
+#define PAGE_ERASE_MS (20.0)       // STM32F103 tERASE典型值
+#define HALFWORD_PROG_MS (0.0525)  // tPROG典型值52.5us
+
+static SgpHostParser_t rspParser;
+static uint8_t lastRsp;
+static uint8_t lastRspData[SGP_HOST_MAX_DATA];
+static uint32_t rspCount;
+
+static void OnRsp(const SgpPacket_t *pack, void *arg)
+{
+    lastRsp = pack->subCmd;
+    memcpy(lastRspData, pack->data, pack->length);
+    rspCount++;
+}
+
+static CL_Result_t DeviceSend(const uint8_t *buff, uint16_t count)
+{
+    SgpHost_Feed(&rspParser, buff, count, OnRsp, NULL);
+    return CL_ResSuccess;
+}
+
+// 回复由DeviceSend直接收走, 不经过comm.c的发送队列
+bool Comm_IsSendIdle(void)
+{
+    return true;
+}
+
+static void HostSend(uint8_t subCmd, const uint8_t *data, uint8_t length)
+{
+    uint8_t frame[SGP_HOST_MAX_FRAME];
+    uint16_t size = SgpHost_Encode(frame, SpgCmd_Dfu, subCmd, data, length);
+    SgpProtocol_RecvData(SpgChannelHandle_Acm, frame, size);
+}
+
+static bool RunDfu(const uint8_t *image, uint32_t size, const uint8_t *sign)
+{
+    uint8_t data[2 + CHUNK_SIZE];
+    CL_Uint32ToBytes(size, data, CL_BigEndian);
+    HostSend(SgpSubCmd_DfuReq, data, 4);
+    if (lastRsp != SgpSubCmd_DfuReady)
+        return false;
+
+    uint16_t packCount = 0;
+    for (uint32_t offset = 0; offset < size; offset += CHUNK_SIZE)
+    {
+        uint32_t len = CL_MIN(CHUNK_SIZE, size - offset);
+        CL_Uint16ToBytes(packCount, data, CL_BigEndian);
+        memcpy(data + 2, image + offset, len);
+        HostSend(SgpSubCmd_DfuData, data, 2 + len);
+        if (lastRsp != SgpSubCmd_DfuDataRsp || lastRspData[2] != 1)
+            return false;
+        packCount++;
+    }
+
+    HostSend(SgpSubCmd_DfuVerify, sign, MOCK_SIGN_SIZE);
+    return lastRsp == SgpSubCmd_DfuVerifyRsp && lastRspData[0] == 1;
+}
+
+static jmp_buf jumpEnv;
+static uint32_t jumpMsp;
+
+static void OnJump(uint32_t msp)
+{
+    jumpMsp = msp;
+    longjmp(jumpEnv, 1);
+}
+
+// 与boot main()开头相同
+static bool BootToJump(void)
+{
+    if (setjmp(jumpEnv) != 0)
+        return true;
+
+    if (!NeedDfu())
+    {
+        if (IsAppValid())
+        {
+            HAL_FLASH_Lock();
+            JumpToApp();
+        }
+    }
+    return false;
+}
+
+int main(int argc, char **argv)
+{
+    bool quick = Bench_IsQuick(argc, argv);
+    uint8_t *image = malloc(IMAGE_SIZE);
+    uint32_t seed = 1;
+    for (uint32_t i = 0; i < IMAGE_SIZE; i++)
+    {
+        seed = seed * 1103515245u + 12345u;
+        image[i] = seed >> 16;
+    }
+    // 向量表: 栈顶和复位地址
+    CL_Uint32ToBytes(0x20005000, image, CL_LittleEndian);
+    CL_Uint32ToBytes(APP_START_ADDR + 0x101, image + 4, CL_LittleEndian);
+    uint8_t sign[MOCK_SIGN_SIZE];
+    MockSign_Make(image, IMAGE_SIZE, sign);
+
+    SgpProtocol_AddChannel(SpgChannelHandle_Acm, DeviceSend);
+    MockCpu_SetJumpHook(OnJump);
+    MockGpio_Set(BTN_PAIR_PORT, BTN_PAIR_PIN, true); // 按住配对键上电, 进入升级
+    Dfu_Init();
+    Dfu_Process();
+
+    // DFU
+    uint32_t runs = quick ? 2 : 50;
+    const MockFlashStat_t *stat = MockFlash_GetStat();
+    uint64_t elapsed = 0, pages = 0, bytes = 0, rsp = 0;
+    for (uint32_t i = 0; i < runs; i++)
+    {
+        MockFlashStat_t before = *stat;
+        uint32_t rspBefore = rspCount;
+        uint64_t start = Bench_NowNs();
+        bool ok = RunDfu(image, IMAGE_SIZE, sign);
+        elapsed += Bench_NowNs() - start;
+        pages += stat->erasePages - before.erasePages;
+        bytes += stat->writeBytes - before.writeBytes;
+        rsp += rspCount - rspBefore;
+        if (!ok)
+        {
+            printf("dfu failed, last rsp 0x%02x\n", lastRsp);
+            return 1;
+        }
+        // 使app无效后回到等待请求, 开始下一次
+        InvalidateAppInfo();
+        Dfu_Process();
+    }
+    Bench_Result("dfu_ms", elapsed / 1e6 / runs, "ms/dfu");
+    Bench_Result("dfu_rate", (double)IMAGE_SIZE * runs / (elapsed / 1e9) / 1e6, "MB/s");
+    Bench_Result("dfu_erase_pages", (double)pages / runs, "page/dfu");
+    Bench_Result("dfu_write_bytes", (double)bytes / runs, "byte/dfu");
+    Bench_Result("dfu_rsp", (double)rsp / runs, "msg/dfu");
+    Bench_Result("dfu_flash_est_ms", ((double)pages * PAGE_ERASE_MS + bytes / 2 * HALFWORD_PROG_MS) / runs, "ms/dfu");
+
+    // 上电到跳转
+    if (SaveAppInfo(APP_START_ADDR, IMAGE_SIZE) != CL_ResSuccess)
+        return 1;
+    MockGpio_Set(BTN_PAIR_PORT, BTN_PAIR_PIN, false);
+    runs = quick ? 10 : 2000;
+    uint64_t start = Bench_NowNs();
+    for (uint32_t i = 0; i < runs; i++)
+    {
+        if (!BootToJump() || jumpMsp != 0x20005000)
+        {
+            printf("boot did not jump to app\n");
+            return 1;
+        }
+    }
+    elapsed = Bench_NowNs() - start;
+    Bench_Result("boot_jump_us", elapsed / 1e3 / runs, "us/boot");
+    Bench_Result("boot_check_rate", (double)IMAGE_SIZE * runs / (elapsed / 1e9) / 1e6, "MB/s");
+
+    free(image);
+    return 0;
+}
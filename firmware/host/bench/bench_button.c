@@ -0,0 +1,72 @@
+#include "bench_util.h"
+#include "pad_synth.h"
+#include "mock.h"
+#include "board.h"
+#include "button.h"
+#include "cl_event_system.h"
+
+// 按键去抖吞吐: 每次Button_Process处理全部8个按键, 输入为随机长度的按下/抖动序列
+
+#define PATTERN_LEN (4096)
+
+static uint32_t patternB[PATTERN_LEN];
+static uint32_t events = 0;
+
+static bool OnEvent(void *eventArg)
+{
+    events++;
+    return true;
+}
+
+static void BuildPattern(void)
+{
+    // 每个按键独立: 随机保持5~300ms后翻转, 短于去抖时间的为抖动
+    static const uint32_t pins[] = {LL_GPIO_PIN_15, LL_GPIO_PIN_9, LL_GPIO_PIN_8, LL_GPIO_PIN_4,
+                                    LL_GPIO_PIN_12, LL_GPIO_PIN_10, LL_GPIO_PIN_11, LL_GPIO_PIN_13};
+    SynthRng_t rng = {777};
+    for (int b = 0; b < CL_ARRAY_LENGTH(pins); b++)
+    {
+        bool level = false;
+        int hold = 0;
+        for (int i = 0; i < PATTERN_LEN; i++)
+        {
+            if (hold-- <= 0)
+            {
+                level = !level;
+                hold = 5 + Synth_Next(&rng) % 300;
+            }
+            if (level)
+                patternB[i] |= pins[b];
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t n = Bench_IsQuick(argc, argv) ? 50000 : 5000000;
+
+    BuildPattern();
+    Button_Init();
+    for (int i = 0; i < BtnIdx_Max; i++)
+        CL_EventSysAddListener(OnEvent, CL_Event_Button, i);
+    Button_Process();
+
+    uint64_t start = Bench_NowNs();
+    for (uint32_t i = 0; i < n; i++)
+    {
+        MockTime_Advance(1000);
+        GPIOB->IDR = patternB[i & (PATTERN_LEN - 1)];
+        Button_Process();
+    }
+    uint64_t elapsed = Bench_NowNs() - start;
+
+    if (events == 0)
+    {
+        printf("no button event\n");
+        return 1;
+    }
+    Bench_Result("button_ns", (double)elapsed / n, "ns/scan");
+    Bench_Result("button_rate", (double)n * BtnIdx_Max / (elapsed / 1e9) / 1e6, "Mbutton/s");
+    Bench_Result("button_events", (double)events / n * 1000, "event/kscan");
+    return 0;
+}
@@ -0,0 +1,172 @@
+#include "bench_util.h"
+#include "pad_synth.h"
+#include "mock.h"
+#include "adc.h"
+#include "board.h"
+#include "button.h"
+#include "pad_func.h"
+#include "cali.h"
+#include "cl_event_system.h"
+
+// 校准收敛: 按真实流程驱动按键和合成的ADC帧(2kHz), 统计
+// 中间值收敛时间, 边界采集到可求解的时间(虚拟时间), 以及拟合边界与真实边界的误差
+
+#define CALI_TIMEOUT_MS (20000)
+#define FIT_MAX_ERR (10.0f) // ADC值
+
+typedef struct
+{
+    float angle;
+    float scale;
+    float trigger; // 0~1
+    bool spike;    // 第一帧左摇杆X出现单帧尖峰
+} Pose_t;
+
+static SynthStick_t left, right;
+static SynthRng_t rng;
+static uint64_t caliNs = 0;
+static uint32_t caliCalls = 0;
+
+static void SetFrame(const Pose_t *pose, bool spike)
+{
+    uint16_t f[AdcChan_Max];
+    Synth_Stick(&left, &rng, pose->angle, pose->scale, &f[AdcChan_LeftX], &f[AdcChan_LeftY]);
+    if (spike)
+        f[AdcChan_LeftX] = Synth_Clamp(f[AdcChan_LeftX] + 400.0f);
+    Synth_Stick(&right, &rng, pose->angle + 1.0f, pose->scale, &f[AdcChan_RightX], &f[AdcChan_RightY]);
+    f[AdcChan_LeftHall] = Synth_Clamp(300 + 3200 * pose->trigger + 2.0f * Synth_Gauss(&rng));
+    f[AdcChan_RightHall] = Synth_Clamp(280 + 3300 * pose->trigger + 2.0f * Synth_Gauss(&rng));
+    MockAdc_SetFrame(f);
+}
+
+// 1ms: 两帧ADC, 按键和校准任务各运行一次
+static void Step(const Pose_t *pose)
+{
+    for (int i = 0; i < 2; i++)
+    {
+        MockTime_Advance(500);
+        SetFrame(pose, pose->spike && i == 0);
+    }
+    Button_Process();
+    uint64_t start = Bench_NowNs();
+    Cali_Process();
+    caliNs += Bench_NowNs() - start;
+    caliCalls++;
+}
+
+static void ClickA(void)
+{
+    ButtonEvent_t evt = ButtonEvent_Click;
+    CL_EventSysRaise(CL_Event_Button, BtnIdx_A, &evt);
+}
+
+typedef struct
+{
+    uint32_t middleMs;
+    uint32_t marginMs;
+    float maxErr;
+    float meanErr;
+} CaliResult_t;
+
+static float FitError(const uint16_t *mags, const SynthStick_t *s, float *mean)
+{
+    float maxErr = 0, sum = 0;
+    for (int i = 0; i < 60; i++)
+    {
+        float err = fabsf(mags[i] - Synth_Boundary(s, i * 2 * (float)M_PI / 60));
+        maxErr = fmaxf(maxErr, err);
+        sum += err;
+    }
+    *mean = sum / 60;
+    return maxErr;
+}
+
+static bool RunCali(CaliResult_t *result)
+{
+    Pose_t rest = {0, 0, 0, false};
+
+    // 长按pair进入中间值校准
+    MockGpio_Set(BTN_PAIR_PORT, BTN_PAIR_PIN, true);
+    for (int ms = 0; GetCaliStatus() != CaliSta_Middle; ms++)
+    {
+        if (ms > BUTTON_LONG_PRESS_TIME + 500)
+            return false;
+        Step(&rest);
+    }
+    MockGpio_Set(BTN_PAIR_PORT, BTN_PAIR_PIN, false);
+
+    // 静止, 约每37ms一个单帧尖峰(接触噪声), 不应重新统计
+    uint32_t ms = 0;
+    for (; GetCaliStatus() == CaliSta_Middle; ms++)
+    {
+        if (ms > CALI_TIMEOUT_MS)
+            return false;
+        Pose_t pose = rest;
+        pose.spike = ms % 37 == 36;
+        Step(&pose);
+    }
+    result->middleMs = ms;
+
+    // 搓圈(约0.8s一圈), 每3圈回中一次; 扳机来回按压; 每50ms尝试按A确认
+    ms = 0;
+    for (; GetCaliStatus() == CaliSta_Margin; ms++)
+    {
+        if (ms > CALI_TIMEOUT_MS)
+            return false;
+        Pose_t pose = {0};
+        pose.angle = ms * 2 * (float)M_PI / 800;
+        uint32_t phase = ms % 2400;
+        pose.scale = phase < 100 ? fabsf((float)phase - 50) / 50.0f : 1.0f;
+        pose.trigger = 1.0f - fabsf((ms % 600) / 300.0f - 1.0f);
+        Step(&pose);
+        if (ms % 50 == 49)
+            ClickA();
+    }
+    result->marginMs = ms;
+
+    float leftMean, rightMean;
+    const CaliParams_t *params = GetCaliParams();
+    float leftMax = FitError(params->leftMag, &left, &leftMean);
+    float rightMax = FitError(params->rightMag, &right, &rightMean);
+    result->maxErr = fmaxf(leftMax, rightMax);
+    result->meanErr = (leftMean + rightMean) / 2;
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    int runs = Bench_IsQuick(argc, argv) ? 1 : 5;
+
+    Button_Init();
+    PadFunc_Init();
+    Synth_DefaultSticks(&left, &right);
+
+    CaliResult_t sum = {0};
+    float maxErr = 0;
+    for (int run = 0; run < runs; run++)
+    {
+        rng.state = 1000 + run;
+        CaliResult_t result;
+        if (!RunCali(&result))
+        {
+            printf("calibration did not converge, run %d\n", run);
+            return 1;
+        }
+        sum.middleMs += result.middleMs;
+        sum.marginMs += result.marginMs;
+        sum.meanErr += result.meanErr;
+        maxErr = fmaxf(maxErr, result.maxErr);
+    }
+
+    Bench_Result("cali_middle_ms", (double)sum.middleMs / runs, "ms");
+    Bench_Result("cali_margin_ms", (double)sum.marginMs / runs, "ms");
+    Bench_Result("cali_fit_mean_err", sum.meanErr / runs, "adc");
+    Bench_Result("cali_fit_max_err", maxErr, "adc");
+    Bench_Result("cali_proc_ns", (double)caliNs / caliCalls, "ns/call");
+    if (maxErr > FIT_MAX_ERR)
+    {
+        printf("fit error %.1f exceeds %.1f\n", maxErr, FIT_MAX_ERR);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,67 @@
+# 比较基准结果与保存的基线, 超出容差时列出并返回1
+# usage: python bench_compare.py baseline.txt results.txt [--tol 0.25] [--update]
+# 结果为bench_*的输出, 每行: bench 名称 数值 单位; 单位以"/s"结尾的越大越好, 其它越小越好
+# 基线行末可加单独的容差, 覆盖--tol; 容差为0表示确定值(如擦除页数), 任何变化都算退化
+# --update 用本次结果覆盖基线(保留各行的容差), 在结果有意改变后使用
+
+import sys
+import argparse
+
+def Load(path):
+    results = {}
+    with open(path) as f:
+        for line in f:
+            fields = line.split()
+            if len(fields) in (4, 5) and fields[0] == "bench":
+                tol = float(fields[4]) if len(fields) == 5 else None
+                results[fields[1]] = (float(fields[2]), fields[3], tol)
+    return results
+
+def IsRegression(base, value, unit, tol):
+    if tol == 0:
+        return abs(value - base) > abs(base) * 1e-6
+    if unit.endswith("/s"):
+        return value < base / (1 + tol)
+    return value > base * (1 + tol) + 1e-9
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="compare bench results against a baseline")
+    parser.add_argument("baseline")
+    parser.add_argument("results")
+    parser.add_argument("--tol", type=float, default=0.25, help="allowed relative change, default 0.25")
+    parser.add_argument("--update", action="store_true", help="overwrite the baseline with the results")
+    args = parser.parse_args()
+
+    results = Load(args.results)
+    if args.update:
+        try:
+            old = Load(args.baseline)
+        except FileNotFoundError:
+            old = {}
+        with open(args.baseline, "w", newline="\n") as f:
+            for name, (value, unit, _) in results.items():
+                tol = old[name][2] if name in old else None
+                f.write("bench %s %.3f %s%s\n" % (name, value, unit, "" if tol is None else " %g" % tol))
+        print("baseline updated, %d results" % len(results))
+        sys.exit(0)
+
+    baseline = Load(args.baseline)
+    failed = 0
+    for name, (base, unit, tol) in baseline.items():
+        if name not in results:
+            print("%-20s missing" % name)
+            failed += 1
+            continue
+        value = results[name][0]
+        change = (value - base) / base * 100 if base != 0 else 0
+        bad = IsRegression(base, value, unit, args.tol if tol is None else tol)
+        print("%-20s %12.3f %12.3f %+8.1f%% %-12s%s" % (name, base, value, change, unit, "  REGRESSION" if bad else ""))
+        failed += bad
+    for name in results:
+        if name not in baseline:
+            print("%-20s new, not in baseline" % name)
+
+    if failed:
+        print("%d of %d results regressed (tol %.0f%%)" % (failed, len(baseline), args.tol * 100))
+        sys.exit(1)
+    print("all %d results within %.0f%% of baseline" % (len(baseline), args.tol * 100))
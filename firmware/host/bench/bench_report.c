@@ -0,0 +1,76 @@
+#include "bench_util.h"
+#include "pad_synth.h"
+#include "mock.h"
+#include "adc.h"
+#include "button.h"
+#include "pad_func.h"
+#include "cali.h"
+#include "usbd_hid.h"
+
+// 上报任务耗时: 读按键 + 摇杆校正(归一化/线性校正/整形) + 扳机查表 + 按键映射
+// 输入为预先生成的合成帧, 生成开销不计入
+
+#define FRAME_COUNT (1024)
+
+static uint16_t frames[FRAME_COUNT][AdcChan_Max];
+static uint32_t gpioB[FRAME_COUNT];
+
+static void BuildFrames(void)
+{
+    SynthStick_t left, right;
+    Synth_DefaultSticks(&left, &right);
+    SynthRng_t rng = {12345};
+    for (int i = 0; i < FRAME_COUNT; i++)
+    {
+        float angle = i * 2 * (float)M_PI / 256;
+        float scale = (i % 512) / 511.0f; // 由中心逐渐推到边界
+        uint16_t *f = frames[i];
+        Synth_Stick(&left, &rng, angle, scale, &f[AdcChan_LeftX], &f[AdcChan_LeftY]);
+        Synth_Stick(&right, &rng, -angle, scale, &f[AdcChan_RightX], &f[AdcChan_RightY]);
+        f[AdcChan_LeftHall] = Synth_Clamp(300 + 3200 * scale);
+        f[AdcChan_RightHall] = Synth_Clamp(3500 - 3200 * scale);
+        gpioB[i] = (i & 64) ? LL_GPIO_PIN_9 | LL_GPIO_PIN_12 : 0; // A和上键
+    }
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t n = Bench_IsQuick(argc, argv) ? 20000 : 2000000;
+
+    Button_Init();
+    PadFunc_Init();
+    BuildFrames();
+
+    uint32_t before = MockUsb_ReportCount();
+    uint64_t start = Bench_NowNs();
+    for (uint32_t i = 0; i < n; i++)
+    {
+        uint32_t idx = i & (FRAME_COUNT - 1);
+        MockAdc_SetFrame(frames[idx]);
+        GPIOB->IDR = gpioB[idx];
+        PadFunc_Process();
+    }
+    uint64_t elapsed = Bench_NowNs() - start;
+    if (MockUsb_ReportCount() - before != n)
+    {
+        printf("report count mismatch\n");
+        return 1;
+    }
+    Bench_Result("report_ns", (double)elapsed / n, "ns/report");
+    Bench_Result("report_rate", n / (elapsed / 1e9) / 1e6, "Mreport/s");
+
+    // 单独统计摇杆校正
+    start = Bench_NowNs();
+    float sum = 0;
+    for (uint32_t i = 0; i < n; i++)
+    {
+        const uint16_t *f = frames[i & (FRAME_COUNT - 1)];
+        Vector2 stick = {f[AdcChan_LeftX], f[AdcChan_LeftY]};
+        StickCorrect(&stick, true);
+        sum += stick.x;
+    }
+    elapsed = Bench_NowNs() - start;
+    benchSink = (uint32_t)sum;
+    Bench_Result("stick_correct_ns", (double)elapsed / n, "ns/stick");
+    return 0;
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+// 主机基准公共部分: 计时, --quick参数, 结果按"bench 名称 数值 单位"逐行输出, 便于脚本比较
+
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+
+static inline uint64_t Bench_NowNs(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static inline bool Bench_IsQuick(int argc, char **argv)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--quick") == 0)
+            return true;
+    }
+    return false;
+}
+
+static inline void Bench_Result(const char *name, double value, const char *unit)
+{
+    printf("bench %s %.3f %s\n", name, value, unit);
+}
+
+// 防止被优化掉的结果
+static volatile uint32_t benchSink;
@@ -0,0 +1,435 @@
+#define _GNU_SOURCE // posix_openpt/ptsname
+#include "mock.h"
+#include "dfu.h"
+#include "comm.h"
+#include "profile.h"
+#include "board.h"
+#include "flash_layout.h"
+#include "cl_event_system.h"
+#include "usbd_cdc_if.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+
+// boot在主机上的模拟: dfu.c/dfu_stm32.c/comm.c用原代码, flash映射到文件, USB CDC由pty代替
+// 主机工具打开--link指定的路径, 像打开设备的串口一样通信
+//
+// boot_emu --flash flash.bin --link /tmp/pad0 [--pair n] [--time-scale k] [--seed s]
+//          [--drop p] [--dup p] [--reorder p] [--power-loss-write n] [--power-loss-erase n]
+//          [--reset-hangup n] [--drop-verify n]
+// boot_emu sign image.bin image.sig   生成主机构建中能通过校验的签名
+//
+//   --pair n           前n次上电时按住配对键(进入升级), 默认0
+//   --time-scale k     设备时间按k倍速运行, 用于缩短10s通信超时的测试
+//   --drop p           每个方向的帧按概率p丢弃
+//   --dup p            主机发来的帧按概率p重复一次
+//   --reorder p        主机发来的帧按概率p推迟到下一帧之后
+//   --power-loss-write n   第n个半字写入前掉电, 进程以MOCK_POWER_LOSS_EXIT退出
+//   --power-loss-erase n   第n页擦除到一半时掉电
+//   --reset-hangup n   前n次复位时断开pty并在同一路径重建(像USB重新枚举), 主机需要重新打开端口
+//   --drop-verify n    每次启动后丢弃设备的前n个校验回复
+//
+// 复位时以相同参数重新执行自身, pty保持不变(对应设备重新枚举后主机重新打开同一个端口);
+// 跳转app时打印并退出, 退出码0. 复位和跳转前等主机读走已发出的数据, 与设备复位前的延时对应
+
+typedef struct
+{
+    const char *flash;
+    const char *link;
+    uint32_t pair;
+    double timeScale;
+    uint32_t seed;
+    double drop;
+    double dup;
+    double reorder;
+    uint32_t powerLossWrite;
+    uint32_t powerLossErase;
+    uint32_t resetHangup;
+    uint32_t dropVerify;
+} EmuArgs_t;
+
+typedef struct
+{
+    uint32_t dropped;
+    uint32_t duplicated;
+    uint32_t reordered;
+} FaultStat_t;
+
+static EmuArgs_t args = {.timeScale = 1.0, .seed = 1};
+static char **emuArgv;
+static int ptyMaster = -1;
+static int ptySlave = -1; // 自己保持打开的从端, 用于查询主机未读走的数据
+static uint32_t bootCount = 0;
+static uint32_t rngState;
+static FaultStat_t faultStat;
+
+//**************时间****************
+static uint64_t startNs;
+
+static uint64_t MonoNs(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+// 设备时间按实际时间推进, DelayOnSysTime等推进过的部分不回退
+static void SyncTime(void)
+{
+    uint64_t us = 1000 + (uint64_t)((MonoNs() - startNs) / 1000 * args.timeScale);
+    if (us > MockTime_Get())
+        MockTime_Set(us);
+}
+
+//**************故障注入****************
+static bool Chance(double p)
+{
+    if (p <= 0)
+        return false;
+    rngState ^= rngState << 13;
+    rngState ^= rngState >> 17;
+    rngState ^= rngState << 5;
+    return (rngState >> 8) * (1.0 / (1 << 24)) < p;
+}
+
+// 主机发往设备, 等待设备取走的数据; 设备接收缓冲区满时保留在此, 相当于USB NAK
+static uint8_t rxPending[16 * 1024];
+static uint32_t rxPendingLen = 0;
+static uint8_t heldFrame[SGP_HOST_MAX_FRAME];
+static uint16_t heldLen = 0;
+
+static void QueueToDevice(const uint8_t *data, uint16_t len)
+{
+    if (rxPendingLen + len > sizeof(rxPending))
+    {
+        faultStat.dropped++; // 主机发送过快, 与设备端丢弃一样处理
+        return;
+    }
+    memcpy(rxPending + rxPendingLen, data, len);
+    rxPendingLen += len;
+}
+
+static void OnHostFrame(const SgpPacket_t *pack, void *arg)
+{
+    uint8_t frame[SGP_HOST_MAX_FRAME];
+    uint16_t len = SgpHost_Encode(frame, pack->cmd, pack->subCmd, pack->data, pack->length);
+    if (Chance(args.drop))
+    {
+        faultStat.dropped++;
+        return;
+    }
+    if (heldLen == 0 && Chance(args.reorder))
+    {
+        memcpy(heldFrame, frame, len);
+        heldLen = len;
+        faultStat.reordered++;
+        return;
+    }
+
+    QueueToDevice(frame, len);
+    if (Chance(args.dup))
+    {
+        QueueToDevice(frame, len);
+        faultStat.duplicated++;
+    }
+    if (heldLen > 0)
+    {
+        QueueToDevice(heldFrame, heldLen);
+        heldLen = 0;
+    }
+}
+
+static void OnDeviceFrame(const SgpPacket_t *pack, void *arg)
+{
+    uint8_t frame[SGP_HOST_MAX_FRAME];
+    uint16_t len = SgpHost_Encode(frame, pack->cmd, pack->subCmd, pack->data, pack->length);
+    if (Chance(args.drop))
+    {
+        faultStat.dropped++;
+        return;
+    }
+    if (pack->cmd == SpgCmd_Dfu && pack->subCmd == SgpSubCmd_DfuVerifyRsp && args.dropVerify > 0)
+    {
+        args.dropVerify--;
+        faultStat.dropped++;
+        return;
+    }
+    if (write(ptyMaster, frame, len) != len)
+        fprintf(stderr, "boot_emu: pty write failed: %s\n", strerror(errno));
+}
+
+//**************CDC****************
+uint8_t UserTxBufferFS[APP_TX_DATA_SIZE];
+static SgpHostParser_t hostParser;
+static SgpHostParser_t deviceParser;
+
+uint8_t CDC_Transmit_FS(uint8_t *Buf, uint16_t Len)
+{
+    SgpHost_Feed(&deviceParser, Buf, Len, OnDeviceFrame, NULL);
+    return USBD_OK;
+}
+
+USBD_StatusTypeDef CDC_GetTransmitStatus(void)
+{
+    return USBD_OK;
+}
+
+static uint32_t rxChunks = 0; // 已交给comm还未处理的包数, Comm_Process每次处理一个
+
+static void PollHost(void)
+{
+    int timeoutMs = rxPendingLen > 0 || rxChunks > 0 ? 0 : 1;
+    struct pollfd pfd = {.fd = ptyMaster, .events = POLLIN};
+    if (poll(&pfd, 1, timeoutMs) > 0 && (pfd.revents & POLLIN))
+    {
+        uint8_t buff[1024];
+        ssize_t len = read(ptyMaster, buff, sizeof(buff));
+        if (len > 0)
+            SgpHost_Feed(&hostParser, buff, len, OnHostFrame, NULL);
+    }
+
+    // 按USB包大小交给comm, 与CDC_Receive_FS相同
+    uint32_t pos = 0;
+    uint8_t *recvBuff;
+    while (pos < rxPendingLen && (recvBuff = Comm_GetRecvBuff()) != NULL)
+    {
+        uint32_t len = CL_MIN(rxPendingLen - pos, APP_TX_DATA_SIZE);
+        memcpy(recvBuff, rxPending + pos, len);
+        Comm_RecvDone(len);
+        pos += len;
+        rxChunks++;
+    }
+    memmove(rxPending, rxPending + pos, rxPendingLen - pos);
+    rxPendingLen -= pos;
+}
+
+//**************复位/跳转****************
+// 等主机读走pty中的数据; 主机1s没有读取(未打开端口)时放弃
+static void DrainToHost(void)
+{
+    int pending, last = -1;
+    uint64_t since = MonoNs();
+    while (ioctl(ptySlave, FIONREAD, &pending) == 0 && pending > 0)
+    {
+        if (pending != last)
+        {
+            last = pending;
+            since = MonoNs();
+        }
+        else if (MonoNs() - since > 1000000000ull)
+        {
+            fprintf(stderr, "boot_emu: host left %d bytes unread\n", pending);
+            break;
+        }
+        usleep(1000);
+    }
+}
+
+static void PrintFaultStat(void)
+{
+    if (args.drop > 0 || args.dup > 0 || args.reorder > 0)
+        fprintf(stderr, "boot_emu: faults dropped %u, duplicated %u, reordered %u\n",
+                faultStat.dropped, faultStat.duplicated, faultStat.reordered);
+}
+
+static void OnReset(void)
+{
+    PrintFaultStat();
+    fprintf(stderr, "boot_emu: reset\n");
+    char env[32];
+    DrainToHost();
+    if (bootCount <= args.resetHangup)
+    {
+        // 端口断开, 新进程在同一路径打开新的pty
+        close(ptySlave);
+        close(ptyMaster);
+        unlink(args.link);
+        unsetenv("BOOT_EMU_PTY");
+    }
+    else
+    {
+        snprintf(env, sizeof(env), "%d,%d", ptyMaster, ptySlave);
+        setenv("BOOT_EMU_PTY", env, 1);
+    }
+    snprintf(env, sizeof(env), "%u", bootCount);
+    setenv("BOOT_EMU_BOOTS", env, 1);
+    execv("/proc/self/exe", emuArgv);
+    perror("boot_emu: exec");
+    _exit(1);
+}
+
+static void OnJump(uint32_t msp)
+{
+    PrintFaultStat();
+    uint32_t reset = *(const uint32_t *)(APP_START_ADDR + 4);
+    fprintf(stderr, "boot_emu: jump to app, msp 0x%08x, reset 0x%08x\n", msp, reset);
+    DrainToHost();
+    if (args.link != NULL)
+        unlink(args.link);
+    exit(0);
+}
+
+static void OnPowerLoss(void)
+{
+    fprintf(stderr, "boot_emu: power loss\n");
+    _exit(MOCK_POWER_LOSS_EXIT);
+}
+
+//**************启动****************
+static int OpenPty(const char *link)
+{
+    const char *inherit = getenv("BOOT_EMU_PTY");
+    if (inherit != NULL)
+    {
+        int master = -1;
+        if (sscanf(inherit, "%d,%d", &master, &ptySlave) != 2)
+            return -1;
+        return master;
+    }
+
+    int master = posix_openpt(O_RDWR | O_NOCTTY);
+    if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0)
+        return -1;
+
+    // 自己保持打开从端, 主机工具未打开时读主端不会出错; 原始模式, 不做行处理
+    const char *name = ptsname(master);
+    ptySlave = open(name, O_RDWR | O_NOCTTY);
+    struct termios tio;
+    if (ptySlave < 0 || tcgetattr(ptySlave, &tio) != 0)
+        return -1;
+    cfmakeraw(&tio);
+    tcsetattr(ptySlave, TCSANOW, &tio);
+
+    unlink(link);
+    if (symlink(name, link) != 0)
+        return -1;
+    return master;
+}
+
+static int SignFile(const char *in, const char *out)
+{
+    FILE *f = fopen(in, "rb");
+    if (f == NULL)
+        return perror(in), 1;
+    static uint8_t data[APP_MAX_SIZE + 1];
+    size_t len = fread(data, 1, sizeof(data), f);
+    fclose(f);
+
+    uint8_t sign[MOCK_SIGN_SIZE];
+    MockSign_Make(data, len, sign);
+    f = fopen(out, "wb");
+    if (f == NULL || fwrite(sign, 1, sizeof(sign), f) != sizeof(sign))
+        return perror(out), 1;
+    return fclose(f) == 0 ? 0 : 1;
+}
+
+static bool ParseArgs(int argc, char **argv)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        const char *opt = argv[i];
+        const char *val = i + 1 < argc ? argv[++i] : NULL;
+        if (val == NULL)
+            return false;
+        if (strcmp(opt, "--flash") == 0)
+            args.flash = val;
+        else if (strcmp(opt, "--link") == 0)
+            args.link = val;
+        else if (strcmp(opt, "--pair") == 0)
+            args.pair = strtoul(val, NULL, 0);
+        else if (strcmp(opt, "--time-scale") == 0)
+            args.timeScale = atof(val);
+        else if (strcmp(opt, "--seed") == 0)
+            args.seed = strtoul(val, NULL, 0);
+        else if (strcmp(opt, "--drop") == 0)
+            args.drop = atof(val);
+        else if (strcmp(opt, "--dup") == 0)
+            args.dup = atof(val);
+        else if (strcmp(opt, "--reorder") == 0)
+            args.reorder = atof(val);
+        else if (strcmp(opt, "--power-loss-write") == 0)
+            args.powerLossWrite = strtoul(val, NULL, 0);
+        else if (strcmp(opt, "--power-loss-erase") == 0)
+            args.powerLossErase = strtoul(val, NULL, 0);
+        else if (strcmp(opt, "--reset-hangup") == 0)
+            args.resetHangup = strtoul(val, NULL, 0);
+        else if (strcmp(opt, "--drop-verify") == 0)
+            args.dropVerify = strtoul(val, NULL, 0);
+        else
+            return false;
+    }
+    return args.flash != NULL && args.link != NULL && args.timeScale > 0;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc == 4 && strcmp(argv[1], "sign") == 0)
+        return SignFile(argv[2], argv[3]);
+    if (!ParseArgs(argc, argv))
+    {
+        fprintf(stderr, "usage: %s --flash flash.bin --link path [--pair n] [--time-scale k] [--seed s]\n"
+                        "       [--drop p] [--dup p] [--reorder p] [--power-loss-write n] [--power-loss-erase n]\n"
+                        "       [--reset-hangup n] [--drop-verify n]\n"
+                        "       %s sign image.bin image.sig\n", argv[0], argv[0]);
+        return 2;
+    }
+
+    emuArgv = argv;
+    const char *boots = getenv("BOOT_EMU_BOOTS");
+    bootCount = (boots != NULL ? strtoul(boots, NULL, 0) : 0) + 1;
+    rngState = args.seed * 2654435761u + bootCount;
+    if (rngState == 0)
+        rngState = 1;
+    startNs = MonoNs();
+
+    if (MockFlash_Map(args.flash) != CL_ResSuccess)
+    {
+        fprintf(stderr, "boot_emu: map %s failed\n", args.flash);
+        return 2;
+    }
+    ptyMaster = OpenPty(args.link);
+    if (ptyMaster < 0)
+    {
+        perror("boot_emu: pty");
+        return 2;
+    }
+    fcntl(ptyMaster, F_SETFD, 0); // 复位后继续使用
+    MockCpu_SetResetHook(OnReset);
+    MockCpu_SetJumpHook(OnJump);
+    // 掉电只在第一次上电时注入, 复位后的启动不再触发
+    if (bootCount == 1)
+        MockFlash_SetPowerLoss(args.powerLossWrite, args.powerLossErase, OnPowerLoss);
+    MockGpio_Set(BTN_PAIR_PORT, BTN_PAIR_PIN, bootCount <= args.pair);
+    fprintf(stderr, "boot_emu: boot %u, pair %s\n", bootCount, bootCount <= args.pair ? "pressed" : "released");
+
+    // 以下与boot main()相同
+    Profile_Init();
+    if (!NeedDfu())
+    {
+        if (IsAppValid())
+        {
+            HAL_FLASH_Lock();
+            JumpToApp();
+        }
+    }
+    CL_EventSysInit();
+
+    Comm_Init();
+    Dfu_Init();
+    while (1)
+    {
+        SyncTime();
+        PollHost();
+        Comm_Process();
+        if (rxChunks > 0)
+            rxChunks--;
+        Dfu_Process();
+    }
+}
@@ -0,0 +1,341 @@
+# boot_emu升级测试: 正常/丢包/重复/乱序/掉电/超时下各完成一次升级, 检查恢复行为并输出吞吐率
+# usage: python dfu_emu_test.py path/to/boot_emu workdir
+# 帧格式与host/mock/sgp_host.h一致, 命令见common/sgp_cmd.h
+
+import os
+import sys
+import time
+import struct
+import select
+import subprocess
+import termios
+import tty
+import random
+
+CMD_DFU = 0x01
+DFU_REQ = 0x70
+DFU_DATA = 0x71
+DFU_VERIFY = 0x72
+DFU_BOOT_VER = 0x73
+APP_VER = 0x74
+RSP = 0x80
+DFU_ERROR = 0xFF
+
+FLASH_BASE = 0x08000000
+APP_START = FLASH_BASE + 68 * 1024
+DFU_APP_INFO = APP_START + 58 * 1024
+FW_INFO_OFFSET = 10 * 1024
+PAGE_SIZE = 1024
+
+IMAGE_SIZE = 16 * 1024
+CHUNK_SIZE = 128
+RETRY_TIMEOUT = 0.05
+
+class DeviceGone(Exception):
+    pass
+
+class DfuFailed(Exception):
+    pass
+
+def Crc16(data):
+    crc = 0xFFFF
+    for b in data:
+        crc ^= b << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else crc << 1
+            crc &= 0xFFFF
+    return crc
+
+def Encode(subCmd, data=b""):
+    body = bytes([CMD_DFU, subCmd, len(data)]) + data
+    return b"\xA5\x5A" + body + struct.pack(">H", Crc16(body))
+
+class Link:
+    def __init__(self, path):
+        self.fd = os.open(path, os.O_RDWR | os.O_NOCTTY)
+        tty.setraw(self.fd)
+        termios.tcflush(self.fd, termios.TCIOFLUSH)
+        self.buff = bytearray()
+        self.retries = 0
+
+    def Close(self):
+        os.close(self.fd)
+
+    def Send(self, subCmd, data=b""):
+        try:
+            os.write(self.fd, Encode(subCmd, data))
+        except OSError:
+            raise DeviceGone()
+
+    def Parse(self):
+        while True:
+            start = self.buff.find(b"\xA5\x5A")
+            if start < 0:
+                del self.buff[:-1]
+                return None
+            del self.buff[:start]
+            if len(self.buff) < 5 or len(self.buff) < 7 + self.buff[4]:
+                return None
+            size = 7 + self.buff[4]
+            frame = bytes(self.buff[:size])
+            if struct.unpack(">H", frame[-2:])[0] != Crc16(frame[2:-2]):
+                del self.buff[:1]
+                continue
+            del self.buff[:size]
+            return frame[3], frame[5:-2]
+
+    def Recv(self, timeout):
+        deadline = time.monotonic() + timeout
+        while True:
+            msg = self.Parse()
+            if msg is not None:
+                return msg
+            left = deadline - time.monotonic()
+            if left <= 0 or not select.select([self.fd], [], [], left)[0]:
+                return None
+            try:
+                data = os.read(self.fd, 4096)
+            except OSError:
+                raise DeviceGone()
+            if not data:
+                raise DeviceGone()
+            self.buff += data
+
+    # 发送并等待期望的回复, 超时重发
+    def Request(self, subCmd, data, rspCmd, match=None, tries=60):
+        for _ in range(tries):
+            self.Send(subCmd, data)
+            deadline = time.monotonic() + RETRY_TIMEOUT
+            while True:
+                msg = self.Recv(max(0, deadline - time.monotonic()))
+                if msg is None:
+                    break
+                if msg[0] == DFU_ERROR:
+                    raise DfuFailed("device reported dfu error")
+                if msg[0] == rspCmd and (match is None or match(msg[1])):
+                    return msg[1]
+            self.retries += 1
+        raise DfuFailed("no response to 0x%02x" % subCmd)
+
+    def Version(self, subCmd):
+        data = self.Request(subCmd, b"", subCmd | RSP)
+        major, minor, patch = struct.unpack(">BBH", data[10:14])
+        return data[:10].decode("ascii", "replace"), (major, minor, patch)
+
+def FirmwareCheck(major, minor, patch):
+    return ((((major + minor + patch + 2333) * (minor + patch + 0xFFFFFFFF)) ^ 0xDBEF5328) & 0xFFFFFFFF)
+
+def MakeImage(path, version, seed):
+    rng = random.Random(seed)
+    image = bytearray(rng.getrandbits(8) for _ in range(IMAGE_SIZE))
+    image[0:8] = struct.pack("<II", 0x20005000, APP_START + 0x101)
+    image[FW_INFO_OFFSET:FW_INFO_OFFSET + 8] = struct.pack("<BBHI", *version, FirmwareCheck(*version))
+    with open(path, "wb") as f:
+        f.write(image)
+    return bytes(image)
+
+class Emulator:
+    def __init__(self, exe, workdir, name, flash, options):
+        self.link = os.path.join(workdir, name + ".tty")
+        self.logPath = os.path.join(workdir, name + ".log")
+        if os.path.lexists(self.link):
+            os.unlink(self.link)
+        self.log = open(self.logPath, "a")
+        self.proc = subprocess.Popen([exe, "--flash", flash, "--link", self.link] + options,
+                                     stdout=self.log, stderr=self.log)
+        deadline = time.monotonic() + 2
+        while not os.path.exists(self.link):
+            if self.proc.poll() is not None or time.monotonic() > deadline:
+                break
+            time.sleep(0.002)
+
+    def Wait(self, timeout=3):
+        try:
+            code = self.proc.wait(timeout)
+        except subprocess.TimeoutExpired:
+            self.proc.kill()
+            code = self.proc.wait()
+        self.log.close()
+        with open(self.logPath) as f:
+            return code, f.read()
+
+    def Alive(self):
+        return self.proc.poll() is None
+
+    def Kill(self):
+        if self.Alive():
+            self.proc.kill()
+        return self.Wait()
+
+def RunDfu(link, image, sign):
+    _, bootVer = link.Version(DFU_BOOT_VER)
+    start = time.monotonic()
+    link.Request(DFU_REQ, struct.pack(">I", len(image)), DFU_REQ | RSP)
+    seq = 0
+    for offset in range(0, len(image), CHUNK_SIZE):
+        pack = struct.pack(">H", seq) + image[offset:offset + CHUNK_SIZE]
+        rsp = link.Request(DFU_DATA, pack, DFU_DATA | RSP, lambda d: struct.unpack(">H", d[:2])[0] == seq)
+        if rsp[2] != 1:
+            raise DfuFailed("write failed at pack %d" % seq)
+        seq += 1
+    try:
+        result = link.Request(DFU_VERIFY, sign, DFU_VERIFY | RSP)[0]
+    except DeviceGone:
+        result = None # 校验回复丢失时设备已复位跳转
+    return result, time.monotonic() - start
+
+class Test:
+    def __init__(self, exe, workdir):
+        self.exe = exe
+        self.workdir = workdir
+        self.failedCases = set()
+        os.makedirs(workdir, exist_ok=True)
+        self.image = MakeImage(os.path.join(workdir, "image.bin"), (1, 2, 3), 1)
+        subprocess.check_call([exe, "sign", os.path.join(workdir, "image.bin"), os.path.join(workdir, "image.sig")])
+        with open(os.path.join(workdir, "image.sig"), "rb") as f:
+            self.sign = f.read()
+
+    def Check(self, case, cond, what):
+        if not cond:
+            print("[FAIL] %s: %s" % (case, what))
+            self.failedCases.add(case)
+        return cond
+
+    def Flash(self, name, base=None):
+        path = os.path.join(self.workdir, name + ".bin")
+        if os.path.exists(path):
+            os.unlink(path)
+        if base is not None:
+            with open(base, "rb") as src, open(path, "wb") as dst:
+                dst.write(src.read())
+        return path
+
+    def Start(self, case, flash, options):
+        emu = Emulator(self.exe, self.workdir, case, flash, options)
+        return emu, Link(emu.link) if emu.Alive() else None
+
+    # 升级直到设备跳转app
+    def UpdateToApp(self, case, emu, link):
+        try:
+            result, elapsed = RunDfu(link, self.image, self.sign)
+        except (DfuFailed, DeviceGone) as e:
+            self.Check(case, False, "dfu: %s" % e)
+            link.Close()
+            emu.Kill()
+            return None
+        link.Close()
+        code, log = emu.Wait()
+        ok = self.Check(case, result in (1, None), "verify result %s" % result)
+        ok = self.Check(case, code == 0 and "jump to app" in log, "no jump after update, exit %s" % code) and ok
+        return elapsed if ok else None
+
+    def ExpectJump(self, case, flash, what):
+        emu = Emulator(self.exe, self.workdir, case, flash, [])
+        code, log = emu.Wait(2)
+        return self.Check(case, code == 0 and "jump to app" in log, what)
+
+    def ExpectStay(self, case, flash):
+        # 不应跳转: 仍在boot中并回应版本查询
+        emu, link = self.Start(case, flash, [])
+        time.sleep(0.2)
+        ok = self.Check(case, emu.Alive(), "jumped to a partial app")
+        if ok:
+            name, _ = link.Version(DFU_BOOT_VER)
+            ok = self.Check(case, name == "FREEPADDFU", "boot version %s" % name)
+        return emu, link, ok
+
+    def Report(self, case, elapsed, link):
+        if elapsed is not None:
+            print("bench emu_%s_rate %.3f KB/s" % (case, len(self.image) / elapsed / 1024))
+            print("bench emu_%s_retries %d count" % (case, link.retries))
+        if case not in self.failedCases:
+            print("[ok] %s" % case)
+
+    def Normal(self):
+        case = "normal"
+        flash = self.Flash("valid")
+        emu, link = self.Start(case, flash, [])
+        _, appVer = link.Version(APP_VER)
+        self.Check(case, appVer == (0xFF, 0xFF, 0xFFFF), "app version on empty flash %s" % (appVer,))
+        elapsed = self.UpdateToApp(case, emu, link)
+        self.ExpectJump(case, flash, "valid app not started")
+        emu, link2 = self.Start(case, flash, ["--pair", "1"])
+        _, appVer = link2.Version(APP_VER)
+        self.Check(case, appVer == (1, 2, 3), "app version after update %s" % (appVer,))
+        link2.Close()
+        emu.Kill()
+        self.Report(case, elapsed, link)
+
+    def Fault(self, case, options):
+        flash = self.Flash(case, os.path.join(self.workdir, "valid.bin"))
+        emu, link = self.Start(case, flash, ["--pair", "1", "--seed", "7"] + options)
+        elapsed = self.UpdateToApp(case, emu, link)
+        self.ExpectJump(case, flash, "valid app not started")
+        self.Report(case, elapsed, link)
+
+    def ReadFlash(self, flash, addr, size):
+        with open(flash, "rb") as f:
+            f.seek(addr - FLASH_BASE)
+            return f.read(size)
+
+    def PowerLoss(self, case, options, erasing=False):
+        flash = self.Flash(case, os.path.join(self.workdir, "valid.bin"))
+        emu, link = self.Start(case, flash, ["--pair", "1"] + options)
+        try:
+            RunDfu(link, self.image, self.sign)
+            self.Check(case, False, "update finished before power loss")
+        except (DfuFailed, DeviceGone):
+            pass
+        link.Close()
+        code, _ = emu.Wait()
+        self.Check(case, code == 3, "exit %s, expect power loss" % code)
+        # 擦除app之前信息页已失效
+        info = self.ReadFlash(flash, DFU_APP_INFO, 8)
+        self.Check(case, info == b"\xff" * 8, "app info still valid after power loss: %s" % info.hex())
+        if erasing:
+            # 掉电时正在擦除app第一页, 只擦除了一半
+            page = self.ReadFlash(flash, APP_START, PAGE_SIZE)
+            self.Check(case, page[:PAGE_SIZE // 2] == b"\xff" * (PAGE_SIZE // 2) and
+                       page[PAGE_SIZE // 2:] == self.image[PAGE_SIZE // 2:PAGE_SIZE], "app page not half erased")
+
+        start = time.monotonic()
+        emu, link, ok = self.ExpectStay(case, flash)
+        if ok:
+            elapsed = self.UpdateToApp(case, emu, link)
+            if elapsed is not None:
+                print("bench emu_%s_recover_ms %.1f ms" % (case, (time.monotonic() - start) * 1000))
+            self.Report(case, elapsed, link)
+        else:
+            emu.Kill()
+
+    def Timeout(self):
+        case = "timeout"
+        flash = self.Flash(case, os.path.join(self.workdir, "valid.bin"))
+        emu, link = self.Start(case, flash, ["--pair", "1", "--time-scale", "50"])
+        link.Request(DFU_REQ, struct.pack(">I", len(self.image)), DFU_REQ | RSP)
+        for seq in range(8):
+            pack = struct.pack(">H", seq) + self.image[seq * CHUNK_SIZE:(seq + 1) * CHUNK_SIZE]
+            link.Request(DFU_DATA, pack, DFU_DATA | RSP, lambda d: struct.unpack(">H", d[:2])[0] == seq)
+        # 停止发送, 设备10s(模拟时间)后报错并回到等待请求
+        start = time.monotonic()
+        msg = link.Recv(2)
+        self.Check(case, msg is not None and msg[0] == DFU_ERROR, "no dfu error after timeout: %s" % (msg,))
+        if msg is not None:
+            print("bench emu_timeout_error_ms %.1f ms" % ((time.monotonic() - start) * 1000))
+        self.Check(case, emu.Alive(), "jumped to a partial app after timeout")
+        elapsed = self.UpdateToApp(case, emu, link)
+        self.Report(case, elapsed, link)
+
+if __name__ == "__main__":
+    if len(sys.argv) != 3:
+        print("usage: %s boot_emu workdir" % sys.argv[0])
+        sys.exit(2)
+    test = Test(sys.argv[1], sys.argv[2])
+    test.Normal()
+    test.Fault("drop", ["--drop", "0.05"])
+    test.Fault("dup", ["--dup", "0.1"])
+    test.Fault("reorder", ["--reorder", "0.1"])
+    test.PowerLoss("power_loss_write", ["--power-loss-write", "3000"])
+    test.PowerLoss("power_loss_erase", ["--power-loss-erase", "2"], erasing=True) # 第1页为信息页, 第2页为app首页
+    test.Timeout()
+    sys.exit(1 if test.failedCases else 0)
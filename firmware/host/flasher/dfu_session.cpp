@@ -0,0 +1,310 @@
+#include "dfu_session.h"
+#include "sgp_cmd.h"
+#include "firmware_info.h"
+#include <cstring>
+
+std::string FwVersion::Str() const
+{
+    return std::to_string(major) + "." + std::to_string(minor) + "." + std::to_string(patch);
+}
+
+DfuSession::DfuSession(const std::string &port, const DfuImage &image, const DfuOptions &options)
+    : portName(port), image(image), options(options)
+{
+}
+
+const char *DfuSession::StateName(State state)
+{
+    switch (state)
+    {
+    case State::ProbeBoot:
+        return "probe_boot";
+    case State::ProbeApp:
+        return "probe_app";
+    case State::Request:
+        return "request";
+    case State::Data:
+        return "data";
+    case State::Verify:
+        return "verify";
+    case State::Reconnect:
+        return "reconnect";
+    case State::Confirm:
+        return "confirm";
+    case State::Done:
+        return "done";
+    case State::Skipped:
+        return "skipped";
+    case State::Failed:
+        return "failed";
+    case State::Unknown:
+        return "unknown";
+    }
+    return "?";
+}
+
+double DfuSession::Seconds() const
+{
+    auto end = Finished() ? endTime : Clock::now();
+    return std::chrono::duration<double>(end - startTime).count();
+}
+
+double DfuSession::DataSeconds() const
+{
+    if (dataStart == Clock::time_point())
+        return 0;
+    auto end = dataEnd != Clock::time_point() ? dataEnd : Clock::now();
+    return std::chrono::duration<double>(end - dataStart).count();
+}
+
+void DfuSession::Start(Clock::time_point now)
+{
+    startTime = now;
+    std::string why;
+    if (!port.Open(portName, why))
+    {
+        Finish(State::Failed, why);
+        return;
+    }
+    state = State::ProbeBoot;
+    Send(SgpSubCmd_DfuBootVer, nullptr, 0, now);
+}
+
+void DfuSession::Send(uint8_t subCmd, const uint8_t *data, uint8_t length, Clock::time_point now)
+{
+    lastFrame.resize(SGP_HOST_MAX_FRAME);
+    lastFrame.resize(SgpHost_Encode(lastFrame.data(), SpgCmd_Dfu, subCmd, data, length));
+    tries = 0;
+    deadline = now + std::chrono::milliseconds(options.timeoutMs);
+    if (!port.Write(lastFrame.data(), lastFrame.size()))
+        Finish(State::Failed, "write failed");
+}
+
+void DfuSession::SendRequest(Clock::time_point now)
+{
+    uint8_t data[4];
+    uint32_t size = image.data.size();
+    data[0] = size >> 24;
+    data[1] = size >> 16;
+    data[2] = size >> 8;
+    data[3] = size;
+    offset = 0;
+    packCount = 0;
+    state = State::Request;
+    Send(SgpSubCmd_DfuReq, data, sizeof(data), now);
+}
+
+void DfuSession::SendData(Clock::time_point now)
+{
+    uint8_t data[SGP_HOST_MAX_DATA];
+    uint32_t len = std::min<uint32_t>(options.chunkSize, image.data.size() - offset);
+    data[0] = packCount >> 8;
+    data[1] = packCount;
+    memcpy(data + 2, image.data.data() + offset, len);
+    Send(SgpSubCmd_DfuData, data, 2 + len, now);
+}
+
+void DfuSession::OnReadable(Clock::time_point now)
+{
+    this->now = now;
+    uint8_t buff[1024];
+    ssize_t len = 0;
+    while (!Finished() && (len = port.Read(buff, sizeof(buff))) > 0)
+        SgpHost_Feed(&parser, buff, len, PacketThunk, this);
+
+    if (len < 0 && !Finished())
+    {
+        // 校验成功后设备复位, 回复丢失时只能看到端口断开
+        if (state == State::Verify || state == State::Confirm)
+            ToReconnect(now);
+        else
+            Finish(State::Failed, "device disconnected");
+    }
+}
+
+void DfuSession::ToReconnect(Clock::time_point now)
+{
+    if (state == State::Verify)
+        reopenTries = 0;
+    port.Close();
+    state = State::Reconnect;
+    deadline = now + std::chrono::milliseconds(options.timeoutMs);
+}
+
+// 校验失败时设备不复位, 断开说明已通过校验并复位; 回到boot时读app版本确认写入的是本镜像
+// 已跳转app时端口不再出现, 重试用完后报告Unknown
+void DfuSession::Reopen(Clock::time_point now)
+{
+    std::string why;
+    if (reopenTries >= options.maxRetries)
+    {
+        Finish(State::Unknown, "device reset before the verify response");
+        return;
+    }
+    reopenTries++;
+    if (port.Open(portName, why))
+    {
+        state = State::Confirm;
+        Send(SgpSubCmd_AppVer, nullptr, 0, now);
+    }
+    else
+        deadline = now + std::chrono::milliseconds(options.timeoutMs);
+}
+
+void DfuSession::OnWritable()
+{
+    if (!port.Flush())
+        Finish(State::Failed, "write failed");
+}
+
+void DfuSession::OnTick(Clock::time_point now)
+{
+    if (Finished() || now < deadline)
+        return;
+
+    if (state == State::Reconnect)
+    {
+        Reopen(now);
+        return;
+    }
+    if (tries >= options.maxRetries)
+    {
+        if (state == State::Confirm)
+            Finish(State::Unknown, "device reset before the verify response");
+        else
+            Finish(State::Failed, std::string("no response in ") + StateName(state));
+        return;
+    }
+    tries++;
+    retries++;
+    deadline = now + std::chrono::milliseconds(options.timeoutMs);
+    if (!port.Write(lastFrame.data(), lastFrame.size()))
+        Finish(State::Failed, "write failed");
+}
+
+void DfuSession::PacketThunk(const SgpPacket_t *pack, void *arg)
+{
+    DfuSession *session = static_cast<DfuSession *>(arg);
+    if (!session->Finished())
+        session->OnPacket(pack, session->now);
+}
+
+bool DfuSession::ParseVersion(const SgpPacket_t *pack, const char *name, FwVersion &version)
+{
+    if (pack->length != 14 || memcmp(pack->data, name, 10) != 0)
+        return false;
+    version.major = pack->data[10];
+    version.minor = pack->data[11];
+    version.patch = (pack->data[12] << 8) | pack->data[13];
+    return true;
+}
+
+void DfuSession::OnPacket(const SgpPacket_t *pack, Clock::time_point now)
+{
+    if (pack->cmd != SpgCmd_Dfu)
+        return;
+
+    if (pack->subCmd == SgpSubCmd_DfuError)
+    { // 设备放弃本次升级后回到等待请求, 从DfuReq重新开始
+        if (state == State::Request || state == State::Data || state == State::Verify)
+        {
+            if (restarts >= options.maxRestarts)
+                Finish(State::Failed, "device reported dfu error");
+            else
+            {
+                restarts++;
+                SendRequest(now);
+            }
+        }
+        return;
+    }
+
+    switch (state)
+    {
+    case State::ProbeBoot:
+        if (pack->subCmd == SgpSubCmd_DfuBootVerRsp)
+        {
+            if (!ParseVersion(pack, PRODUCT_BOOT_STR, bootVersion))
+            {
+                Finish(State::Failed, "not a " PRODUCT_BOOT_STR " bootloader");
+                return;
+            }
+            state = State::ProbeApp;
+            Send(SgpSubCmd_AppVer, nullptr, 0, now);
+        }
+        break;
+    case State::ProbeApp:
+        if (pack->subCmd == SgpSubCmd_AppVerRsp)
+        {
+            // 没有app时版本为擦除后的0xff, 同样按需要升级处理
+            ParseVersion(pack, PRODUCT_APP_STR, appVersion);
+            probed = true;
+            if (appVersion == image.version && !options.force)
+                Finish(State::Skipped, "");
+            else
+                SendRequest(now);
+        }
+        break;
+    case State::Request:
+        if (pack->subCmd == SgpSubCmd_DfuReady)
+        {
+            state = State::Data;
+            if (dataStart == Clock::time_point())
+                dataStart = now;
+            SendData(now);
+        }
+        break;
+    case State::Data:
+        if (pack->subCmd == SgpSubCmd_DfuDataRsp && pack->length == 3 &&
+            ((pack->data[0] << 8) | pack->data[1]) == packCount)
+        {
+            if (pack->data[2] != 1)
+            {
+                Finish(State::Failed, "flash write failed at offset " + std::to_string(offset));
+                return;
+            }
+            offset += std::min<uint32_t>(options.chunkSize, image.data.size() - offset);
+            packCount++;
+            if (offset < image.data.size())
+            {
+                SendData(now);
+            }
+            else
+            {
+                dataEnd = now;
+                state = State::Verify;
+                Send(SgpSubCmd_DfuVerify, image.sign.data(), image.sign.size(), now);
+            }
+        }
+        break;
+    case State::Verify:
+        if (pack->subCmd == SgpSubCmd_DfuVerifyRsp && pack->length == 1)
+        {
+            if (pack->data[0] == 1)
+                Finish(State::Done, "");
+            else
+                Finish(State::Failed, "signature rejected");
+        }
+        break;
+    case State::Confirm:
+        if (pack->subCmd == SgpSubCmd_AppVerRsp)
+        {
+            FwVersion version;
+            if (ParseVersion(pack, PRODUCT_APP_STR, version) && version == image.version)
+                Finish(State::Done, "");
+            else
+                Finish(State::Failed, "app version " + version.Str() + " after reset");
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+void DfuSession::Finish(State result, const std::string &why)
+{
+    state = result;
+    error = why;
+    endTime = Clock::now();
+    port.Close();
+}
@@ -0,0 +1,121 @@
+#pragma once
+
+#include "serial_port.h"
+#include "sgp_host.h"
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+struct FwVersion
+{
+    uint8_t major = 0;
+    uint8_t minor = 0;
+    uint16_t patch = 0;
+
+    bool operator==(const FwVersion &other) const
+    {
+        return major == other.major && minor == other.minor && patch == other.patch;
+    }
+    std::string Str() const;
+};
+
+struct DfuImage
+{
+    std::vector<uint8_t> data;
+    std::vector<uint8_t> sign;
+    FwVersion version;
+};
+
+struct DfuOptions
+{
+    uint32_t chunkSize = 128;   // 每包数据字节数, 偶数(按半字写入)
+    uint32_t timeoutMs = 200;   // 等待回复的时间, 超时重发
+    uint32_t maxRetries = 20;   // 同一请求最多重发次数
+    uint32_t maxRestarts = 3;   // 设备报错后从DfuReq重新开始的次数
+    bool force = false;         // 版本相同也升级
+};
+
+// 一个设备的升级流程, 按sgp_cmd.h: DfuBootVer -> AppVer -> DfuReq -> DfuData x N -> DfuVerify
+// 校验回复前端口断开时, 重新打开端口读app版本确认结果
+// 设备每次只处理一个包, 收到对应回复后再发下一个; 所有会话在同一线程中由poll驱动
+class DfuSession
+{
+public:
+    enum class State
+    {
+        ProbeBoot,
+        ProbeApp,
+        Request,
+        Data,
+        Verify,
+        Reconnect, // 校验回复前端口断开, 等待设备重新枚举
+        Confirm,   // 重新打开后读app版本
+        Done,
+        Skipped,
+        Failed,
+        Unknown, // 校验回复丢失, 设备复位后未能重新打开
+    };
+
+    DfuSession(const std::string &port, const DfuImage &image, const DfuOptions &options);
+
+    void Start(Clock::time_point now);
+    void OnReadable(Clock::time_point now);
+    void OnWritable();
+    void OnTick(Clock::time_point now);
+
+    int Fd() const { return port.Fd(); }
+    bool WantWrite() const { return port.HasPending(); }
+    bool Finished() const { return state >= State::Done; }
+    bool Ok() const { return state == State::Done || state == State::Skipped; }
+
+    const std::string &PortName() const { return portName; }
+    State GetState() const { return state; }
+    static const char *StateName(State state);
+    const std::string &Error() const { return error; }
+    const FwVersion &BootVersion() const { return bootVersion; }
+    const FwVersion &AppVersion() const { return appVersion; }
+    bool Probed() const { return probed; } // 已读到boot和app版本
+    uint32_t Acked() const { return offset; }
+    uint32_t Retries() const { return retries; }
+    uint32_t Restarts() const { return restarts; }
+    double Seconds() const;     // 从开始到结束的总时间
+    double DataSeconds() const; // 从DfuReady到全部数据确认
+
+private:
+    void Send(uint8_t subCmd, const uint8_t *data, uint8_t length, Clock::time_point now);
+    void SendData(Clock::time_point now);
+    void SendRequest(Clock::time_point now);
+    void ToReconnect(Clock::time_point now);
+    void Reopen(Clock::time_point now);
+    void OnPacket(const SgpPacket_t *pack, Clock::time_point now);
+    static void PacketThunk(const SgpPacket_t *pack, void *arg);
+    void Finish(State result, const std::string &why);
+    static bool ParseVersion(const SgpPacket_t *pack, const char *name, FwVersion &version);
+
+    Clock::time_point now; // 当前处理的事件时间, 供解析回调使用
+
+    std::string portName;
+    const DfuImage &image;
+    DfuOptions options;
+    SerialPort port;
+    SgpHostParser_t parser = {};
+    State state = State::ProbeBoot;
+    std::string error;
+
+    std::vector<uint8_t> lastFrame; // 超时重发
+    Clock::time_point deadline;
+    uint32_t tries = 0;
+    uint32_t reopenTries = 0;
+
+    FwVersion bootVersion;
+    FwVersion appVersion;
+    bool probed = false;
+    uint32_t offset = 0; // 已确认的字节数
+    uint16_t packCount = 0;
+    uint32_t retries = 0;
+    uint32_t restarts = 0;
+    Clock::time_point startTime, endTime, dataStart, dataEnd;
+};
@@ -0,0 +1,168 @@
+# pad_flash测试: 对多个boot_emu并行升级, 包括空设备/丢包乱序/版本相同跳过/强制升级/端口不存在/校验回复丢失
+# usage: python flash_test.py path/to/pad_flash path/to/boot_emu workdir
+
+import os
+import sys
+import json
+import shutil
+import subprocess
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "emu"))
+from dfu_emu_test import Emulator, MakeImage, APP_START, FLASH_BASE
+
+class FlashTest:
+    def __init__(self, flasher, emu, workdir):
+        self.flasher = flasher
+        self.emu = emu
+        self.workdir = workdir
+        self.failed = False
+        if os.path.isdir(workdir):
+            shutil.rmtree(workdir)
+        os.makedirs(workdir)
+        self.images = {}
+        for name, version, seed in (("old", (1, 0, 0), 2), ("new", (1, 2, 3), 3)):
+            path = os.path.join(workdir, name + ".bin")
+            self.images[name] = (path, MakeImage(path, version, seed))
+            subprocess.check_call([emu, "sign", path, path + ".sig"])
+
+    def Check(self, case, cond, what):
+        if not cond:
+            print("[FAIL] %s: %s" % (case, what))
+            self.failed = True
+        return cond
+
+    def Flash(self, name, base=None):
+        path = os.path.join(self.workdir, name + ".flash")
+        if base is None:
+            if os.path.exists(path):
+                os.unlink(path)
+        else:
+            shutil.copyfile(os.path.join(self.workdir, base + ".flash"), path)
+        return path
+
+    def AppImage(self, flash, size):
+        with open(flash, "rb") as f:
+            f.seek(APP_START - FLASH_BASE)
+            return f.read(size)
+
+    # devices: [(name, flash, emu options)], extraPorts: 不存在的端口, stay: 升级后停在boot的设备
+    # 返回 {port: 设备结果}, 以及升级后各模拟器是否跳转app
+    def Run(self, case, image, devices, args=(), extraPorts=(), stay=()):
+        emus = {}
+        for name, flash, options in devices:
+            emus[name] = Emulator(self.emu, self.workdir, case + "_" + name, flash, options)
+        ports = [emus[name].link for name, _, _ in devices] + list(extraPorts)
+        summary = os.path.join(self.workdir, case + ".json")
+        cmd = [self.flasher, "--image", self.images[image][0], "--timeout", "50", "--json", summary] + list(args) + ports
+        proc = subprocess.run(cmd, stdout=subprocess.PIPE, stderr=subprocess.STDOUT, timeout=60)
+        sys.stdout.write(proc.stdout.decode(errors="replace"))
+        with open(summary) as f:
+            result = json.load(f)
+        jumped = {}
+        for name, _, _ in devices:
+            emu = emus[name]
+            # 结果未知时设备可能已跳转, 同样等待退出
+            if name not in stay and any(d["port"] == emu.link and d["status"] in ("done", "unknown")
+                                        for d in result["devices"]):
+                code, log = emu.Wait()
+            else:
+                code, log = emu.Kill()
+            jumped[name] = code == 0 and "jump to app" in log
+        byName = {}
+        for name, _, _ in devices:
+            byName[name] = next(d for d in result["devices"] if d["port"] == emus[name].link)
+        for port in extraPorts:
+            byName[port] = next(d for d in result["devices"] if d["port"] == port)
+        return proc.returncode, result, byName, jumped
+
+    def ExpectDone(self, case, image, name, device, jumped, flash):
+        self.Check(case, device["status"] == "done", "%s status %s %s" % (name, device["status"], device["error"]))
+        self.Check(case, jumped[name], "%s did not jump to app" % name)
+        data = self.images[image][1]
+        self.Check(case, self.AppImage(flash, len(data)) == data, "%s app image differs" % name)
+        self.Check(case, device["bytes"] == len(data), "%s acked %d bytes" % (name, device["bytes"]))
+
+    # 三台空设备同时升级, 其中两台注入链路故障
+    def Parallel(self):
+        case = "parallel"
+        devices = [("dev0", self.Flash("dev0"), []),
+                   ("dev1", self.Flash("dev1"), ["--drop", "0.05", "--seed", "3"]),
+                   ("dev2", self.Flash("dev2"), ["--dup", "0.1", "--reorder", "0.1", "--seed", "5"])]
+        code, result, byName, jumped = self.Run(case, "old", devices)
+        self.Check(case, code == 0, "exit %d" % code)
+        self.Check(case, result["done"] == 3 and result["failed"] == 0, "summary %s" % result)
+        for name, flash, _ in devices:
+            self.ExpectDone(case, "old", name, byName[name], jumped, flash)
+            self.Check(case, byName[name]["app_version"] == "255.255.65535",
+                       "%s app version before %s" % (name, byName[name]["app_version"]))
+        self.Check(case, byName["dev1"]["retries"] > 0, "no retries with packet drop")
+        for name in byName:
+            print("bench flash_%s_%s_rate %.1f KB/s" % (case, name, byName[name]["kbps"]))
+        if not self.failed:
+            print("[ok] %s" % case)
+
+    # 旧版本设备升级, 不存在的端口报告失败但不影响其他设备
+    def Upgrade(self):
+        case = "upgrade"
+        devices = [("old", self.Flash("upgrade", "dev0"), ["--pair", "1"])]
+        missing = os.path.join(self.workdir, "missing.tty")
+        code, result, byName, jumped = self.Run(case, "new", devices, extraPorts=[missing])
+        self.Check(case, code == 1, "exit %d with a missing port" % code)
+        self.Check(case, byName[missing]["status"] == "failed", "missing port %s" % byName[missing]["status"])
+        self.Check(case, byName[missing]["app_version"] == "", "missing port reported a version")
+        self.Check(case, byName["old"]["app_version"] == "1.0.0", "app version before %s" % byName["old"]["app_version"])
+        self.ExpectDone(case, "new", "old", byName["old"], jumped, devices[0][1])
+        if not self.failed:
+            print("[ok] %s" % case)
+
+    # 版本相同的设备跳过, 不擦除; --force时仍升级
+    def Skip(self):
+        case = "skip"
+        flash = self.Flash("skip", "upgrade")
+        code, result, byName, _ = self.Run(case, "new", [("same", flash, ["--pair", "1"])])
+        self.Check(case, code == 0 and byName["same"]["status"] == "skipped",
+                   "exit %d status %s" % (code, byName["same"]["status"]))
+        self.Check(case, byName["same"]["bytes"] == 0, "sent %d bytes" % byName["same"]["bytes"])
+        data = self.images["new"][1]
+        self.Check(case, self.AppImage(flash, len(data)) == data, "app changed while skipping")
+
+        code, result, byName, jumped = self.Run(case + "_force", "new", [("same", flash, ["--pair", "1"])], ["--force"])
+        self.Check(case, code == 0, "exit %d with --force" % code)
+        self.ExpectDone(case, "new", "same", byName["same"], jumped, flash)
+        if not self.failed:
+            print("[ok] %s" % case)
+
+    # 校验回复丢失, 设备复位时端口断开重建: 设备回到boot时重新打开端口读到新版本即为成功,
+    # 已跳转app时端口不再出现, 报告unknown
+    def Reconnect(self):
+        case = "reconnect"
+        flash = self.Flash("reconnect")
+        code, result, byName, jumped = self.Run(case, "old", [("boot", flash, ["--pair", "2", "--reset-hangup", "1", "--drop-verify", "1"])],
+                                                stay=["boot"])
+        device = byName["boot"]
+        self.Check(case, code == 0, "exit %d" % code)
+        self.Check(case, device["status"] == "done", "status %s %s" % (device["status"], device["error"]))
+        self.Check(case, not jumped["boot"], "jumped while the pair key was held")
+        data = self.images["old"][1]
+        self.Check(case, self.AppImage(flash, len(data)) == data, "app image differs")
+
+        flash = self.Flash("reconnect_app")
+        code, result, byName, jumped = self.Run(case + "_app", "old", [("app", flash, ["--reset-hangup", "1", "--drop-verify", "1"])])
+        device = byName["app"]
+        self.Check(case, code == 1, "exit %d with an unknown result" % code)
+        self.Check(case, device["status"] == "unknown", "status %s %s" % (device["status"], device["error"]))
+        self.Check(case, jumped["app"], "app did not jump to app")
+        self.Check(case, self.AppImage(flash, len(data)) == data, "app image differs")
+        if not self.failed:
+            print("[ok] %s" % case)
+
+if __name__ == "__main__":
+    if len(sys.argv) != 4:
+        print("usage: %s pad_flash boot_emu workdir" % sys.argv[0])
+        sys.exit(2)
+    test = FlashTest(*sys.argv[1:])
+    test.Parallel()
+    test.Upgrade()
+    test.Skip()
+    test.Reconnect()
+    sys.exit(1 if test.failed else 0)
@@ -0,0 +1,273 @@
+#include "dfu_session.h"
+#include "flash_layout.h"
+#include "firmware_info.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <poll.h>
+#include <unistd.h>
+
+// 多设备并行升级, 按sgp_cmd.h的DFU流程; 先查询app版本, 与镜像相同的设备跳过
+//
+// pad_flash --image app.bin [--sig app.sig] [--version x.y.z] [--force] [--chunk n] [--timeout ms]
+//           [--retries n] [--json summary.json] [--quiet] port...
+//   --sig      64字节签名, 默认为镜像路径加.sig
+//   --version  镜像版本, 默认读取镜像中appFwInfo(APP_FW_INFO_ADDR)处的版本
+//   --json     输出每个设备的结果, "-"为标准输出
+// 全部设备升级成功或跳过时返回0
+
+struct Args
+{
+    std::string image;
+    std::string sign;
+    std::string version;
+    std::string json;
+    bool quiet = false;
+    DfuOptions options;
+    std::vector<std::string> ports;
+};
+
+static void Usage(const char *name)
+{
+    fprintf(stderr,
+            "usage: %s --image app.bin [--sig app.sig] [--version x.y.z] [--force] [--chunk n]\n"
+            "       [--timeout ms] [--retries n] [--json summary.json] [--quiet] port...\n",
+            name);
+}
+
+static bool ParseArgs(int argc, char **argv, Args &args)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        std::string opt = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (opt == "--force")
+            args.options.force = true;
+        else if (opt == "--quiet")
+            args.quiet = true;
+        else if (opt == "--image" && hasValue)
+            args.image = argv[++i];
+        else if (opt == "--sig" && hasValue)
+            args.sign = argv[++i];
+        else if (opt == "--version" && hasValue)
+            args.version = argv[++i];
+        else if (opt == "--json" && hasValue)
+            args.json = argv[++i];
+        else if (opt == "--chunk" && hasValue)
+            args.options.chunkSize = strtoul(argv[++i], nullptr, 0);
+        else if (opt == "--timeout" && hasValue)
+            args.options.timeoutMs = strtoul(argv[++i], nullptr, 0);
+        else if (opt == "--retries" && hasValue)
+            args.options.maxRetries = strtoul(argv[++i], nullptr, 0);
+        else if (opt.rfind("--", 0) == 0)
+            return false;
+        else
+            args.ports.push_back(opt);
+    }
+    if (args.sign.empty())
+        args.sign = args.image + ".sig";
+
+    // 数据包为2字节序号加数据, 长度字段为1字节; 按半字写入, 必须为偶数
+    uint32_t chunk = args.options.chunkSize;
+    if (chunk == 0 || chunk % 2 != 0 || chunk > SGP_HOST_MAX_DATA - 2)
+    {
+        fprintf(stderr, "chunk size must be even and 2..%u\n", SGP_HOST_MAX_DATA - 3);
+        return false;
+    }
+    return !args.image.empty() && !args.ports.empty() && args.options.timeoutMs > 0;
+}
+
+static bool ReadFile(const std::string &path, std::vector<uint8_t> &data)
+{
+    std::ifstream f(path, std::ios::binary);
+    if (!f)
+        return false;
+    data.assign(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+    return true;
+}
+
+static bool LoadImage(const Args &args, DfuImage &image)
+{
+    if (!ReadFile(args.image, image.data) || image.data.empty() || image.data.size() > APP_MAX_SIZE)
+    {
+        fprintf(stderr, "%s: missing, empty or larger than %lu bytes\n", args.image.c_str(), APP_MAX_SIZE);
+        return false;
+    }
+    if (!ReadFile(args.sign, image.sign) || image.sign.size() != 64)
+    {
+        fprintf(stderr, "%s: missing or not a 64 byte signature\n", args.sign.c_str());
+        return false;
+    }
+
+    if (!args.version.empty())
+    {
+        unsigned major, minor, patch;
+        if (sscanf(args.version.c_str(), "%u.%u.%u", &major, &minor, &patch) != 3)
+        {
+            fprintf(stderr, "bad version %s\n", args.version.c_str());
+            return false;
+        }
+        image.version = {(uint8_t)major, (uint8_t)minor, (uint16_t)patch};
+        return true;
+    }
+
+    // 与boot回复AppVer时读取的位置相同
+    uint32_t infoOffset = APP_FW_INFO_ADDR - APP_START_ADDR;
+    FirmwareInfo_t info;
+    if (image.data.size() < infoOffset + sizeof(info))
+    {
+        fprintf(stderr, "%s: too small to contain the firmware info, use --version\n", args.image.c_str());
+        return false;
+    }
+    memcpy(&info, image.data.data() + infoOffset, sizeof(info));
+    if (!FirmwareCheck(&info))
+    {
+        fprintf(stderr, "%s: no valid firmware info at offset 0x%x, use --version\n", args.image.c_str(), infoOffset);
+        return false;
+    }
+    image.version = {info.verMajor, info.verMinor, info.verPatch};
+    return true;
+}
+
+static std::string JsonString(const std::string &s)
+{
+    std::string out = "\"";
+    for (char c : s)
+    {
+        if (c == '"' || c == '\\')
+            out += '\\';
+        if ((unsigned char)c < 0x20)
+        {
+            char buff[8];
+            snprintf(buff, sizeof(buff), "\\u%04x", c);
+            out += buff;
+            continue;
+        }
+        out += c;
+    }
+    return out + "\"";
+}
+
+static double KBps(const DfuSession &s)
+{
+    double sec = s.DataSeconds();
+    return sec > 0 ? s.Acked() / sec / 1024 : 0;
+}
+
+static void WriteJson(FILE *f, const Args &args, const DfuImage &image,
+                      const std::vector<std::unique_ptr<DfuSession>> &sessions, double seconds)
+{
+    int ok = 0, skipped = 0, failed = 0;
+    fprintf(f, "{\n  \"image\": %s,\n  \"size\": %zu,\n  \"version\": \"%s\",\n  \"devices\": [\n",
+            JsonString(args.image).c_str(), image.data.size(), image.version.Str().c_str());
+    for (size_t i = 0; i < sessions.size(); i++)
+    {
+        const DfuSession &s = *sessions[i];
+        DfuSession::State state = s.GetState();
+        ok += state == DfuSession::State::Done;
+        skipped += state == DfuSession::State::Skipped;
+        failed += !s.Ok();
+        fprintf(f, "    {\"port\": %s, \"status\": \"%s\", \"boot_version\": \"%s\", \"app_version\": \"%s\", "
+                   "\"bytes\": %u, \"seconds\": %.3f, \"kbps\": %.1f, \"retries\": %u, \"restarts\": %u, \"error\": %s}%s\n",
+                JsonString(s.PortName()).c_str(), DfuSession::StateName(state),
+                s.Probed() ? s.BootVersion().Str().c_str() : "", s.Probed() ? s.AppVersion().Str().c_str() : "",
+                s.Acked(), s.Seconds(), KBps(s), s.Retries(), s.Restarts(), JsonString(s.Error()).c_str(),
+                i + 1 < sessions.size() ? "," : "");
+    }
+    fprintf(f, "  ],\n  \"seconds\": %.3f,\n  \"done\": %d,\n  \"skipped\": %d,\n  \"failed\": %d\n}\n",
+            seconds, ok, skipped, failed);
+}
+
+static void PrintProgress(const std::vector<std::unique_ptr<DfuSession>> &sessions, size_t imageSize)
+{
+    for (const auto &s : sessions)
+    {
+        if (s->Finished())
+            continue;
+        fprintf(stderr, "%s: %s %3u%% %.1f KB/s\n", s->PortName().c_str(), DfuSession::StateName(s->GetState()),
+                (unsigned)(s->Acked() * 100ull / imageSize), KBps(*s));
+    }
+}
+
+int main(int argc, char **argv)
+{
+    Args args;
+    if (!ParseArgs(argc, argv, args))
+    {
+        Usage(argv[0]);
+        return 2;
+    }
+    DfuImage image;
+    if (!LoadImage(args, image))
+        return 2;
+
+    auto start = Clock::now();
+    std::vector<std::unique_ptr<DfuSession>> sessions;
+    for (const auto &port : args.ports)
+    {
+        sessions.push_back(std::make_unique<DfuSession>(port, image, args.options));
+        sessions.back()->Start(start);
+    }
+
+    auto lastProgress = start;
+    while (true)
+    {
+        std::vector<pollfd> fds;
+        std::vector<DfuSession *> active;
+        for (auto &s : sessions)
+        {
+            if (s->Finished())
+                continue;
+            short events = POLLIN | (s->WantWrite() ? POLLOUT : 0);
+            fds.push_back({s->Fd(), events, 0});
+            active.push_back(s.get());
+        }
+        if (active.empty())
+            break;
+
+        poll(fds.data(), fds.size(), 5);
+        auto now = Clock::now();
+        for (size_t i = 0; i < active.size(); i++)
+        {
+            if (fds[i].revents & (POLLIN | POLLHUP | POLLERR))
+                active[i]->OnReadable(now);
+            if (fds[i].revents & POLLOUT)
+                active[i]->OnWritable();
+            active[i]->OnTick(now);
+        }
+
+        if (!args.quiet && now - lastProgress >= std::chrono::seconds(1))
+        {
+            lastProgress = now;
+            PrintProgress(sessions, image.data.size());
+        }
+    }
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    bool allOk = true;
+    for (const auto &s : sessions)
+    {
+        allOk = allOk && s->Ok();
+        printf("%-24s %-8s app %-13s %6.1f KB/s  %5.2f s  retries %u%s%s\n", s->PortName().c_str(),
+               DfuSession::StateName(s->GetState()), s->Probed() ? s->AppVersion().Str().c_str() : "-", KBps(*s), s->Seconds(),
+               s->Retries(), s->Error().empty() ? "" : "  ", s->Error().c_str());
+    }
+    printf("%zu devices in %.2f s, image %s\n", sessions.size(), seconds, image.version.Str().c_str());
+
+    if (!args.json.empty())
+    {
+        FILE *f = args.json == "-" ? stdout : fopen(args.json.c_str(), "w");
+        if (f == nullptr)
+        {
+            perror(args.json.c_str());
+            return 2;
+        }
+        WriteJson(f, args, image, sessions, seconds);
+        if (f != stdout)
+            fclose(f);
+    }
+    return allOk ? 0 : 1;
+}
@@ -0,0 +1,68 @@
+#include "serial_port.h"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+
+SerialPort::~SerialPort()
+{
+    Close();
+}
+
+bool SerialPort::Open(const std::string &path, std::string &error)
+{
+    fd = open(path.c_str(), O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0)
+    {
+        error = path + ": " + strerror(errno);
+        return false;
+    }
+
+    // CDC忽略波特率, 只需关闭行处理和回显
+    struct termios tio;
+    if (tcgetattr(fd, &tio) == 0)
+    {
+        cfmakeraw(&tio);
+        cfsetspeed(&tio, B115200);
+        tcsetattr(fd, TCSANOW, &tio);
+    }
+    tcflush(fd, TCIOFLUSH); // 丢弃打开前设备发出的内容
+    return true;
+}
+
+void SerialPort::Close()
+{
+    if (fd >= 0)
+        close(fd);
+    fd = -1;
+    txBuff.clear();
+}
+
+bool SerialPort::Write(const uint8_t *data, size_t len)
+{
+    txBuff.insert(txBuff.end(), data, data + len);
+    return Flush();
+}
+
+bool SerialPort::Flush()
+{
+    while (!txBuff.empty())
+    {
+        ssize_t n = write(fd, txBuff.data(), txBuff.size());
+        if (n < 0)
+            return errno == EAGAIN || errno == EINTR;
+        txBuff.erase(txBuff.begin(), txBuff.begin() + n);
+    }
+    return true;
+}
+
+ssize_t SerialPort::Read(uint8_t *buff, size_t size)
+{
+    ssize_t n = read(fd, buff, size);
+    if (n > 0)
+        return n;
+    if (n < 0 && (errno == EAGAIN || errno == EINTR))
+        return 0;
+    return -1; // EIO或读到结尾: 设备复位或拔出
+}
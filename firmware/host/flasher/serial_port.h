@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <sys/types.h>
+
+// 原始模式打开的串口(设备CDC或boot_emu的pty), 非阻塞读写
+class SerialPort
+{
+public:
+    ~SerialPort();
+
+    bool Open(const std::string &path, std::string &error);
+    void Close();
+    int Fd() const { return fd; }
+
+    // 写不完的部分留在发送缓冲区, 可写时调用Flush
+    bool Write(const uint8_t *data, size_t len);
+    bool Flush();
+    bool HasPending() const { return !txBuff.empty(); }
+
+    // 返回读到的字节数, 0为暂无数据, -1为设备已断开
+    ssize_t Read(uint8_t *buff, size_t size);
+
+private:
+    int fd = -1;
+    std::vector<uint8_t> txBuff;
+};
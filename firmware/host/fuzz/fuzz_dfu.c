@@ -0,0 +1,342 @@
+// 直接包含dfu.c, 以便在每次处理后检查dfuContext
+#include "dfu.c"
+
+#include "fuzz_dfu.h"
+#include "mock.h"
+#include <setjmp.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// 不变量:
+// 1. flash只在app区和app信息页内被擦写, 其它区域(boot/档案)保持不变
+// 2. recvSize <= fileSize <= APP_MAX_SIZE
+// 3. 只有全部数据接收后才处理校验, 校验成功时flash中的app与签名一致
+// 4. 回复写入成功的数据包, flash中对应位置与包内数据一致
+
+#define FUZZ_CHECK(cond, what)                                                       \
+    do                                                                               \
+    {                                                                                \
+        if (!(cond))                                                                 \
+        {                                                                            \
+            fprintf(stderr, "fuzz_dfu: invariant failed: %s (line %d)\n", what, __LINE__); \
+            abort();                                                                 \
+        }                                                                            \
+    } while (0)
+
+// 输入为操作序列, 每个操作以1字节操作码开始, 输入不足时其余字段按0处理
+typedef enum
+{
+    FuzzOp_Raw = 0,  // n + n字节, 原样交给SgpProtocol_RecvData
+    FuzzOp_Frame,    // cmd + subCmd + 分割点 + len + len字节, 编码为正确的帧, 分两次送入
+    FuzzOp_Request,  // u16 文件大小, 发送DfuReq
+    FuzzOp_Data,     // 模式 + len (+ 数据), 发送DfuData, 序号基于设备当前的packCount
+    FuzzOp_Verify,   // 模式 (+ 签名), 发送DfuVerify
+    FuzzOp_Tick,     // t, 时间前进t*50ms
+    FuzzOp_Max,
+} FuzzOp_t;
+
+#define FUZZ_DATA_SEQ_MASK (0x03) // 0:期望的序号 1:上一包 2:下一包 3:取自输入
+#define FUZZ_DATA_FROM_INPUT (0x04) // 数据取自输入, 否则按偏移生成
+
+typedef struct
+{
+    const uint8_t *data;
+    size_t size;
+    size_t pos;
+} FuzzInput_t;
+
+static uint8_t Take8(FuzzInput_t *in)
+{
+    return in->pos < in->size ? in->data[in->pos++] : 0;
+}
+
+static uint16_t Take16(FuzzInput_t *in)
+{
+    uint16_t hi = Take8(in);
+    return (hi << 8) | Take8(in);
+}
+
+static void TakeBytes(FuzzInput_t *in, uint8_t *buff, uint32_t length)
+{
+    uint32_t n = CL_MIN(length, in->size - in->pos);
+    memcpy(buff, in->data + in->pos, n);
+    memset(buff + n, 0, length - n);
+    in->pos += n;
+}
+
+static inline uint8_t GenByte(uint32_t offset)
+{
+    return (uint8_t)((offset * 2654435761u) >> 24);
+}
+
+//**************flash模型****************
+static uint8_t initFlash[MOCK_FLASH_SIZE];
+
+static bool InDfuRegion(uint32_t addr)
+{
+    return (addr >= APP_START_ADDR && addr < APP_START_ADDR + APP_MAX_SIZE) ||
+           (addr >= DFU_APP_INFO_ADDR && addr < DFU_APP_INFO_ADDR + FLASH_PAGE_SIZE);
+}
+
+// 空白设备: app区和信息页已擦除, 其它区域填充非0xff的内容, 被擦写时可以发现
+static void InitFlashImage(void)
+{
+    for (uint32_t i = 0; i < MOCK_FLASH_SIZE; i++)
+    {
+        uint32_t addr = FLASH_BASE + i;
+        initFlash[i] = InDfuRegion(addr) ? 0xff : (GenByte(i) & 0x7f);
+    }
+}
+
+static void CheckFlashRegions(void)
+{
+    const uint8_t *flash = MockFlash_Ptr(FLASH_BASE);
+    uint32_t ranges[][2] = {
+        {FLASH_BASE, APP_START_ADDR},
+        {APP_START_ADDR + APP_MAX_SIZE, DFU_APP_INFO_ADDR},
+        {DFU_APP_INFO_ADDR + FLASH_PAGE_SIZE, FLASH_BASE + MOCK_FLASH_SIZE},
+    };
+    for (int i = 0; i < CL_ARRAY_LENGTH(ranges); i++)
+    {
+        uint32_t start = ranges[i][0] - FLASH_BASE;
+        uint32_t end = ranges[i][1] - FLASH_BASE;
+        FUZZ_CHECK(memcmp(flash + start, initFlash + start, end - start) == 0, "flash changed outside the dfu region");
+    }
+}
+
+//**************收发****************
+static uint8_t features[FUZZ_FEATURE_BITS / 8];
+static DfuContext_t before; // 设备处理当前包之前的状态
+static SgpPacket_t lastPack;
+static uint8_t lastPackData[SGP_HOST_MAX_DATA];
+static SgpHostParser_t rspParser;
+
+static void AddFeature(uint32_t a, uint32_t b, uint32_t c)
+{
+    uint32_t h = (a * 0x9e3779b1u) ^ (b * 0x85ebca77u) ^ (c * 0xc2b2ae3du);
+    h = (h ^ (h >> 15)) % FUZZ_FEATURE_BITS;
+    features[h / 8] |= 1 << (h % 8);
+}
+
+// 在dfu.c的监听之前注册, 记录处理前的状态
+static bool BeforeDfu(void *eventArg)
+{
+    const SgpPacket_t *pack = (const SgpPacket_t *)eventArg;
+    before = dfuContext;
+    lastPack = *pack;
+    memcpy(lastPackData, pack->data, pack->length);
+    lastPack.data = lastPackData;
+    return true;
+}
+
+static void OnRsp(const SgpPacket_t *pack, void *arg)
+{
+    bool fullReceipt = before.status == DfuStatus_RecvFile && before.recvSize == before.fileSize;
+    AddFeature(before.status << 8 | lastPack.subCmd, pack->subCmd << 8 | dfuContext.status,
+               (pack->length > 0 ? pack->data[pack->length - 1] : 0xff) << 2 | fullReceipt << 1 | (before.recvSize == 0));
+
+    if (pack->subCmd == SgpSubCmd_DfuVerifyRsp)
+    {
+        FUZZ_CHECK(lastPack.subCmd == SgpSubCmd_DfuVerify, "verify response to another command");
+        FUZZ_CHECK(fullReceipt && before.fileSize > 0, "verify handled before the whole file was received");
+        if (pack->data[0] == 1)
+        {
+            uint8_t sign[MOCK_SIGN_SIZE];
+            MockSign_Make(ReadFlash(APP_START_ADDR), before.fileSize, sign);
+            FUZZ_CHECK(lastPack.length == MOCK_SIGN_SIZE && memcmp(sign, lastPack.data, MOCK_SIGN_SIZE) == 0,
+                       "verify passed with a wrong signature");
+            FUZZ_CHECK(IsAppValid(), "app invalid after a successful verify");
+        }
+    }
+    else if (pack->subCmd == SgpSubCmd_DfuDataRsp && pack->data[2] == 1 && dfuContext.recvSize != before.recvSize)
+    {
+        uint32_t length = dfuContext.recvSize - before.recvSize;
+        FUZZ_CHECK(lastPack.subCmd == SgpSubCmd_DfuData && length == lastPack.length - 2u, "recv size advanced by another length");
+        FUZZ_CHECK(memcmp(ReadFlash(APP_START_ADDR + before.recvSize), lastPack.data + 2, length) == 0,
+                   "acked data differs from flash");
+    }
+}
+
+static CL_Result_t DeviceSend(const uint8_t *buff, uint16_t count)
+{
+    SgpHost_Feed(&rspParser, buff, count, OnRsp, NULL);
+    return CL_ResSuccess;
+}
+
+// comm.c需要CDC, 不参与编译; 回复由DeviceSend直接收走, 发送队列总为空
+bool Comm_IsSendIdle(void)
+{
+    return true;
+}
+
+static void HostSend(uint8_t cmd, uint8_t subCmd, const uint8_t *data, uint8_t length, uint16_t split)
+{
+    uint8_t frame[SGP_HOST_MAX_FRAME];
+    uint16_t size = SgpHost_Encode(frame, cmd, subCmd, data, length);
+    split = split % (size + 1);
+    SgpProtocol_RecvData(SpgChannelHandle_Acm, frame, split);
+    SgpProtocol_RecvData(SpgChannelHandle_Acm, frame + split, size - split);
+}
+
+static void CheckContext(void)
+{
+    FUZZ_CHECK(dfuContext.recvSize <= dfuContext.fileSize, "recvSize > fileSize");
+    FUZZ_CHECK(dfuContext.fileSize <= APP_MAX_SIZE, "fileSize > APP_MAX_SIZE");
+}
+
+//**************操作****************
+static void RunOp(FuzzInput_t *in)
+{
+    uint8_t buff[SGP_HOST_MAX_DATA];
+    uint8_t op = Take8(in) % FuzzOp_Max;
+    DfuStatus_t status = dfuContext.status;
+
+    switch (op)
+    {
+    case FuzzOp_Raw:
+    {
+        uint8_t n = Take8(in);
+        TakeBytes(in, buff, n);
+        SgpProtocol_RecvData(SpgChannelHandle_Acm, buff, n);
+        break;
+    }
+    case FuzzOp_Frame:
+    {
+        uint8_t cmd = Take8(in);
+        uint8_t subCmd = Take8(in);
+        uint8_t split = Take8(in);
+        uint8_t length = Take8(in);
+        TakeBytes(in, buff, length);
+        HostSend(cmd, subCmd, buff, length, split);
+        break;
+    }
+    case FuzzOp_Request:
+        CL_Uint32ToBytes(Take16(in), buff, CL_BigEndian);
+        HostSend(SpgCmd_Dfu, SgpSubCmd_DfuReq, buff, 4, 0);
+        break;
+    case FuzzOp_Data:
+    {
+        uint8_t mode = Take8(in);
+        uint8_t length = Take8(in) % (SGP_HOST_MAX_DATA - 1);
+        uint16_t seq = dfuContext.packCount;
+        switch (mode & FUZZ_DATA_SEQ_MASK)
+        {
+        case 1:
+            seq--;
+            break;
+        case 2:
+            seq++;
+            break;
+        case 3:
+            seq = Take16(in);
+            break;
+        }
+        CL_Uint16ToBytes(seq, buff, CL_BigEndian);
+        if (mode & FUZZ_DATA_FROM_INPUT)
+        {
+            TakeBytes(in, buff + 2, length);
+        }
+        else
+        {
+            for (uint32_t i = 0; i < length; i++)
+                buff[2 + i] = GenByte(dfuContext.recvSize + i);
+        }
+        HostSend(SpgCmd_Dfu, SgpSubCmd_DfuData, buff, 2 + length, mode >> 3);
+        break;
+    }
+    case FuzzOp_Verify:
+    {
+        uint8_t mode = Take8(in) % 3;
+        uint8_t length = MOCK_SIGN_SIZE;
+        if (mode == 0) // 按设备已接收的数据签名
+            MockSign_Make(ReadFlash(APP_START_ADDR), dfuContext.recvSize, buff);
+        else if (mode == 1)
+            TakeBytes(in, buff, length);
+        else
+            TakeBytes(in, buff, length = Take8(in));
+        HostSend(SpgCmd_Dfu, SgpSubCmd_DfuVerify, buff, length, 0);
+        break;
+    }
+    case FuzzOp_Tick:
+        MockTime_Advance(Take8(in) * 50000u);
+        break;
+    }
+
+    AddFeature(0x10000 | op, status, dfuContext.status);
+    CheckContext();
+    Dfu_Process();
+    CheckContext();
+}
+
+//**************入口****************
+static jmp_buf resetEnv;
+
+static void OnReset(void)
+{
+    longjmp(resetEnv, 1);
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    static bool inited = false;
+    if (!inited)
+    {
+        inited = true;
+        InitFlashImage();
+        MockCpu_SetResetHook(OnReset);
+        MockGpio_Set(BTN_PAIR_PORT, BTN_PAIR_PIN, true); // 按住配对键上电, 进入升级
+    }
+
+    // 每个输入从空白设备开始
+    memcpy(MockFlash_Ptr(FLASH_BASE), initFlash, MOCK_FLASH_SIZE);
+    memset(features, 0, sizeof(features));
+    memset(&rspParser, 0, sizeof(rspParser));
+    memset(&dfuContext, 0, sizeof(dfuContext));
+    MockTime_Set(0);
+    MockSgp_Reset();
+    MockEvent_Reset();
+    CL_EventSysAddListener(BeforeDfu, CL_Event_SgpRecvMsg, 0);
+    SgpProtocol_AddChannel(SpgChannelHandle_Acm, DeviceSend);
+    Dfu_Init();
+    Dfu_Process();
+
+    FuzzInput_t in = {data, size, 0};
+    // 校验成功后设备复位, 本次输入结束
+    if (setjmp(resetEnv) == 0)
+    {
+        while (in.pos < in.size)
+            RunOp(&in);
+    }
+    else
+    {
+        FUZZ_CHECK(IsAppValid(), "reset without a valid app");
+    }
+    CheckFlashRegions();
+    return 0;
+}
+
+const uint8_t *FuzzDfu_Features(void)
+{
+    return features;
+}
+
+size_t FuzzDfu_MakeSession(uint8_t *buff, size_t size, uint32_t fileSize, uint8_t chunk)
+{
+    size_t pos = 0;
+    uint32_t packs = (fileSize + chunk - 1) / chunk;
+    if (size < 3 + packs * 3 + 2)
+        return 0;
+
+    buff[pos++] = FuzzOp_Request;
+    buff[pos++] = fileSize >> 8;
+    buff[pos++] = fileSize & 0xff;
+    for (uint32_t offset = 0; offset < fileSize; offset += chunk)
+    {
+        buff[pos++] = FuzzOp_Data;
+        buff[pos++] = 0;
+        buff[pos++] = CL_MIN(chunk, fileSize - offset);
+    }
+    buff[pos++] = FuzzOp_Verify;
+    buff[pos++] = 0;
+    return pos;
+}
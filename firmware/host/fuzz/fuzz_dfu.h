@@ -0,0 +1,16 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// boot的SGP接收和DFU处理的模糊测试, 可由libFuzzer或fuzz_main.c驱动
+// 输入按操作序列解释(见fuzz_dfu.c中的FuzzOp_t), 每个输入从空白设备开始
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size);
+
+// 生成一次完整升级的输入(请求/全部数据/正确签名), 作为初始语料; 返回长度, buff不足时返回0
+size_t FuzzDfu_MakeSession(uint8_t *buff, size_t size, uint32_t fileSize, uint8_t chunk);
+
+// 最近一次输入覆盖到的状态特征, 无插桩编译时用于筛选语料
+#define FUZZ_FEATURE_BITS (4096)
+const uint8_t *FuzzDfu_Features(void);
@@ -0,0 +1,347 @@
+#include "fuzz_dfu.h"
+#include "bench_util.h"
+#include "mock.h"
+#include "sgp_protocol.h"
+#include "sgp_cmd.h"
+#include "flash_layout.h"
+#include "cl_event_system.h"
+#include <dirent.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+
+// 无libFuzzer时的驱动(gcc构建), 三种用法:
+// fuzz_dfu --runs n [--seed s] [--save dir]  随机变异n个输入, 以完整升级的输入为初始语料,
+//                                           覆盖到新状态特征的输入加入语料; --save保存语料
+// fuzz_dfu file|dir...                       逐个运行保存的输入(libFuzzer产生的crash/语料同样适用)
+// fuzz_dfu [--quick]                         SGP解析和DFU处理的吞吐基准
+// 不变量失败或sanitizer报错时, 当前输入写入fuzz-crash.bin
+
+#define FUZZ_MAX_INPUT (4096)
+#define FUZZ_MAX_CORPUS (512)
+
+typedef struct
+{
+    uint8_t *data;
+    size_t size;
+} Input_t;
+
+static Input_t corpus[FUZZ_MAX_CORPUS];
+static uint32_t corpusCount;
+static uint8_t coverage[FUZZ_FEATURE_BITS / 8];
+static const uint8_t *curData;
+static size_t curSize;
+
+static void SaveCrash(void)
+{
+    FILE *f = fopen("fuzz-crash.bin", "wb");
+    if (f == NULL)
+        return;
+    fwrite(curData, 1, curSize, f);
+    fclose(f);
+    fprintf(stderr, "fuzz_dfu: input (%zu bytes) saved to fuzz-crash.bin\n", curSize);
+}
+
+static void OnAbort(int sig)
+{
+    SaveCrash();
+    signal(sig, SIG_DFL);
+    raise(sig);
+}
+
+// sanitizer报错时的回调, 无sanitizer时为NULL
+void __sanitizer_set_death_callback(void (*callback)(void)) __attribute__((weak));
+
+static bool Run(const uint8_t *data, size_t size)
+{
+    curData = data;
+    curSize = size;
+    LLVMFuzzerTestOneInput(data, size);
+
+    bool fresh = false;
+    const uint8_t *features = FuzzDfu_Features();
+    for (uint32_t i = 0; i < sizeof(coverage); i++)
+    {
+        if (features[i] & ~coverage[i])
+            fresh = true;
+        coverage[i] |= features[i];
+    }
+    return fresh;
+}
+
+static uint32_t CoverageBits(void)
+{
+    uint32_t bits = 0;
+    for (uint32_t i = 0; i < sizeof(coverage); i++)
+        bits += __builtin_popcount(coverage[i]);
+    return bits;
+}
+
+static void AddCorpus(const uint8_t *data, size_t size)
+{
+    if (corpusCount >= FUZZ_MAX_CORPUS)
+        return;
+    corpus[corpusCount].data = malloc(size);
+    memcpy(corpus[corpusCount].data, data, size);
+    corpus[corpusCount].size = size;
+    corpusCount++;
+}
+
+//**************变异****************
+static uint32_t rngState = 1;
+
+static uint32_t Rand(uint32_t n)
+{ // xorshift32
+    rngState ^= rngState << 13;
+    rngState ^= rngState >> 17;
+    rngState ^= rngState << 5;
+    return n > 0 ? rngState % n : 0;
+}
+
+static size_t Mutate(uint8_t *data, size_t size)
+{
+    uint32_t count = 1 + Rand(6);
+    for (uint32_t n = 0; n < count; n++)
+    {
+        uint32_t pos = Rand(size + 1);
+        uint32_t len = 1 + Rand(8); // CL_MIN会对参数求值两次, 先取随机数
+        switch (Rand(size > 0 ? 6 : 1))
+        {
+        case 0: // 插入随机字节
+        {
+            len = CL_MIN(len, FUZZ_MAX_INPUT - size);
+            memmove(data + pos + len, data + pos, size - pos);
+            for (uint32_t i = 0; i < len; i++)
+                data[pos + i] = Rand(256);
+            size += len;
+            break;
+        }
+        case 1: // 删除
+        {
+            len = CL_MIN(len, size - pos);
+            memmove(data + pos, data + pos + len, size - pos - len);
+            size -= len;
+            break;
+        }
+        case 2: // 改写一个字节
+            if (pos < size)
+                data[pos] = Rand(256);
+            break;
+        case 3: // 翻转一位
+            if (pos < size)
+                data[pos] ^= 1 << Rand(8);
+            break;
+        case 4: // 重复一段, 使数据包/时间等操作连续出现
+        {
+            len *= 4;
+            len = CL_MIN(len, size - pos);
+            len = CL_MIN(len, FUZZ_MAX_INPUT - size);
+            memmove(data + pos + len, data + pos, size - pos);
+            size += len;
+            break;
+        }
+        case 5: // 与另一个语料拼接
+        {
+            const Input_t *other = &corpus[Rand(corpusCount)];
+            uint32_t from = Rand(other->size + 1);
+            len = CL_MIN(other->size - from, FUZZ_MAX_INPUT - pos);
+            memcpy(data + pos, other->data + from, len);
+            size = pos + len;
+            break;
+        }
+        }
+    }
+    return size;
+}
+
+static void SaveCorpus(const char *dir)
+{
+    mkdir(dir, 0755);
+    for (uint32_t i = 0; i < corpusCount; i++)
+    {
+        char path[512];
+        snprintf(path, sizeof(path), "%s/input-%04u.bin", dir, i);
+        FILE *f = fopen(path, "wb");
+        if (f == NULL)
+            continue;
+        fwrite(corpus[i].data, 1, corpus[i].size, f);
+        fclose(f);
+    }
+}
+
+static int Fuzz(uint32_t runs, uint32_t seed, const char *saveDir)
+{
+    static uint8_t buff[FUZZ_MAX_INPUT];
+    rngState = seed != 0 ? seed : 1;
+
+    // 初始语料: 不同长度/包大小的完整升级, 以及空输入
+    static const uint32_t sessions[][2] = {{1, 2}, {300, 128}, {1000, 64}, {4096, 252}, {APP_MAX_SIZE, 252}};
+    for (int i = 0; i < CL_ARRAY_LENGTH(sessions); i++)
+    {
+        size_t size = FuzzDfu_MakeSession(buff, sizeof(buff), sessions[i][0], sessions[i][1]);
+        Run(buff, size);
+        AddCorpus(buff, size);
+    }
+    Run(NULL, 0);
+
+    uint64_t start = Bench_NowNs();
+    for (uint32_t i = 0; i < runs; i++)
+    {
+        const Input_t *base = &corpus[Rand(corpusCount)];
+        memcpy(buff, base->data, base->size);
+        size_t size = Mutate(buff, base->size);
+        if (Run(buff, size))
+            AddCorpus(buff, size);
+    }
+    double sec = (Bench_NowNs() - start) / 1e9;
+    printf("fuzz_dfu: %u runs in %.2f s (%.0f exec/s), corpus %u, features %u\n", runs, sec, runs / sec,
+           corpusCount, CoverageBits());
+    if (saveDir != NULL)
+        SaveCorpus(saveDir);
+    return 0;
+}
+
+static void RunFile(const char *path)
+{
+    static uint8_t buff[1 << 20];
+    FILE *f = fopen(path, "rb");
+    if (f == NULL)
+    {
+        perror(path);
+        exit(1);
+    }
+    size_t size = fread(buff, 1, sizeof(buff), f);
+    fclose(f);
+    Run(buff, size);
+}
+
+static int Replay(int argc, char **argv)
+{
+    uint32_t files = 0;
+    for (int i = 1; i < argc; i++)
+    {
+        struct stat st;
+        if (stat(argv[i], &st) == 0 && S_ISDIR(st.st_mode))
+        {
+            DIR *dir = opendir(argv[i]);
+            struct dirent *entry;
+            while (dir != NULL && (entry = readdir(dir)) != NULL)
+            {
+                if (entry->d_name[0] == '.')
+                    continue;
+                char path[1024];
+                snprintf(path, sizeof(path), "%s/%s", argv[i], entry->d_name);
+                RunFile(path);
+                files++;
+            }
+            if (dir != NULL)
+                closedir(dir);
+        }
+        else
+        {
+            RunFile(argv[i]);
+            files++;
+        }
+    }
+    printf("fuzz_dfu: %u inputs ok\n", files);
+    return 0;
+}
+
+//**************吞吐基准****************
+static uint32_t benchPacks;
+
+static bool CountPack(void *eventArg)
+{
+    benchPacks++;
+    return true;
+}
+
+static CL_Result_t DropSend(const uint8_t *buff, uint16_t count)
+{
+    return CL_ResSuccess;
+}
+
+// SGP解析: 连续的数据帧 / 随机噪声; DFU处理: 完整升级的输入
+static int Bench(bool quick)
+{
+    enum { STREAM_SIZE = 64 * 1024 };
+    static uint8_t stream[STREAM_SIZE];
+    uint8_t data[SGP_HOST_MAX_DATA];
+    for (uint32_t i = 0; i < sizeof(data); i++)
+        data[i] = i * 37;
+
+    // 与升级时相同的130字节数据帧, 按USB包大小64字节送入
+    uint32_t frameSize = 0, frames = 0;
+    while (frameSize + SGP_HOST_MAX_FRAME <= STREAM_SIZE)
+    {
+        frameSize += SgpHost_Encode(stream + frameSize, SpgCmd_Dfu, 0x55, data, 130);
+        frames++;
+    }
+    MockEvent_Reset();
+    MockSgp_Reset();
+    CL_EventSysAddListener(CountPack, CL_Event_SgpRecvMsg, 0);
+    SgpProtocol_AddChannel(SpgChannelHandle_Acm, DropSend);
+
+    uint32_t runs = quick ? 20 : 2000;
+    benchPacks = 0;
+    uint64_t start = Bench_NowNs();
+    for (uint32_t r = 0; r < runs; r++)
+    {
+        for (uint32_t pos = 0; pos < frameSize; pos += 64)
+            SgpProtocol_RecvData(SpgChannelHandle_Acm, stream + pos, CL_MIN(64, frameSize - pos));
+    }
+    uint64_t elapsed = Bench_NowNs() - start;
+    if (benchPacks != frames * runs)
+    {
+        printf("sgp parse: %u of %u frames\n", benchPacks, frames * runs);
+        return 1;
+    }
+    Bench_Result("sgp_parse_rate", (double)frameSize * runs / (elapsed / 1e9) / 1e6, "MB/s");
+    Bench_Result("sgp_parse_frame_ns", (double)elapsed / (frames * runs), "ns/frame");
+
+    // 噪声中夹杂帧头, 测试重新同步
+    for (uint32_t i = 0; i < STREAM_SIZE; i++)
+        stream[i] = Rand(8) == 0 ? SGP_HOST_SYNC0 : Rand(256);
+    start = Bench_NowNs();
+    for (uint32_t r = 0; r < runs; r++)
+        SgpProtocol_RecvData(SpgChannelHandle_Acm, stream, STREAM_SIZE);
+    elapsed = Bench_NowNs() - start;
+    Bench_Result("sgp_noise_rate", (double)STREAM_SIZE * runs / (elapsed / 1e9) / 1e6, "MB/s");
+    benchSink = benchPacks;
+
+    // 一次输入为48KB的完整升级(擦除/写入/签名校验/复位)
+    static uint8_t input[FUZZ_MAX_INPUT];
+    size_t size = FuzzDfu_MakeSession(input, sizeof(input), 48 * 1024, 128);
+    runs = quick ? 2 : 100;
+    start = Bench_NowNs();
+    for (uint32_t r = 0; r < runs; r++)
+        LLVMFuzzerTestOneInput(input, size);
+    elapsed = Bench_NowNs() - start;
+    Bench_Result("fuzz_dfu_session_ms", elapsed / 1e6 / runs, "ms/exec");
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    signal(SIGABRT, OnAbort);
+    if (__sanitizer_set_death_callback != NULL)
+        __sanitizer_set_death_callback(SaveCrash);
+
+    uint32_t runs = 0, seed = 1;
+    const char *saveDir = NULL;
+    bool fuzz = false;
+    for (int i = 1; i + 1 < argc; i++)
+    {
+        if (strcmp(argv[i], "--runs") == 0)
+            runs = strtoul(argv[++i], NULL, 0), fuzz = true;
+        else if (strcmp(argv[i], "--seed") == 0)
+            seed = strtoul(argv[++i], NULL, 0);
+        else if (strcmp(argv[i], "--save") == 0)
+            saveDir = argv[++i];
+    }
+    if (fuzz)
+        return Fuzz(runs, seed, saveDir);
+    if (argc > 1 && strcmp(argv[1], "--quick") != 0)
+        return Replay(argc, argv);
+    return Bench(Bench_IsQuick(argc, argv));
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+// 主机构建的外设模拟, 测试/基准/回放通过这些接口驱动固件代码
+
+#include "cl_common.h"
+#include "main.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//**************虚拟时钟****************
+// GetUsTime/GetSysTime都由此换算, 只在调用这些接口时推进
+void MockTime_Set(uint64_t us);
+void MockTime_Advance(uint32_t us);
+uint64_t MockTime_Get(void);
+// WFI时若设置了闹钟推进到闹钟时间, 否则推进该值, 默认1000us
+void MockTime_SetIdleStep(uint32_t us);
+// WFI最多推进到该时间, 0为不限制; 回放时用于在帧时间停下
+void MockTime_SetWakeLimit(uint64_t us);
+
+//**************复位/跳转****************
+// 钩子不应返回(如longjmp), 未设置或返回时结束进程
+typedef void (*MockResetFunc)(void);
+typedef void (*MockJumpFunc)(uint32_t msp);
+void MockCpu_SetResetHook(MockResetFunc func); // NVIC_SystemReset
+void MockCpu_SetJumpHook(MockJumpFunc func);   // boot跳转app时的__set_MSP
+
+//**************GPIO****************
+void MockGpio_Set(GPIO_TypeDef *port, uint32_t pin, bool high);
+void MockGpio_SetAll(uint32_t a, uint32_t b, uint32_t c); // 按端口写入IDR
+void MockGpio_GetAll(uint32_t *a, uint32_t *b, uint32_t *c);
+
+//**************ADC****************
+// 按AdcChannel_t顺序, 写入一帧滤波值, 摇杆帧计数加1, 摇杆/扳机采样流各写入一个采样
+void MockAdc_SetFrame(const uint16_t adc[6]);
+void MockAdc_Set(int chan, uint16_t value);
+
+//**************PWM****************
+typedef struct
+{
+    uint16_t motor[2];
+    uint16_t padLed;
+    uint32_t motorUpdates;
+    uint32_t ledWaves;
+} MockPwm_t;
+const MockPwm_t *MockPwm_Get(void);
+
+//**************USB****************
+typedef void (*MockUsbReportFunc)(const void *report, uint32_t len);
+void MockUsb_SetIdle(bool idle);
+void MockUsb_SetReportHook(MockUsbReportFunc func); // 每次上报回调, NULL时只记录最近一次
+const void *MockUsb_LastReport(void);
+uint32_t MockUsb_ReportCount(void);
+
+//**************flash****************
+// 启动时映射到FLASH_BASE的128KB匿名内存, 全部为0xff
+// path不为NULL时改为映射到文件(不存在则创建并填0xff), 修改直接写回文件
+CL_Result_t MockFlash_Map(const char *path);
+uint8_t *MockFlash_Ptr(uint32_t addr);
+// 从FLASH_BASE起载入flash镜像(如读出的整片flash), 只修改内存, 不写回文件
+CL_Result_t MockFlash_Load(const char *path);
+typedef struct
+{
+    uint32_t erasePages;
+    uint32_t writeBytes;
+} MockFlashStat_t;
+const MockFlashStat_t *MockFlash_GetStat(void); // 擦除/写入累计量
+// 掉电: 之后第writes个半字写入前, 或第erases页擦除到一半时调用func, 0为不触发; func不应返回
+// 未设置func时以MOCK_POWER_LOSS_EXIT退出进程, 文件映射的flash保留掉电时的内容
+typedef void (*MockPowerLossFunc)(void);
+#define MOCK_POWER_LOSS_EXIT (3)
+void MockFlash_SetPowerLoss(uint32_t writes, uint32_t erases, MockPowerLossFunc func);
+#define MOCK_FLASH_SIZE (128 * 1024ul)
+
+//**************事件****************
+void MockEvent_Reset(void);
+
+//**************SGP****************
+void MockSgp_Reset(void); // 丢弃各通道未解析完的数据
+
+//**************签名****************
+// boot的SingCheck在主机上的替代, 生成它能通过的签名
+#define MOCK_SIGN_SIZE (64)
+void MockSign_Make(const uint8_t *data, uint32_t dataSize, uint8_t sign[MOCK_SIGN_SIZE]);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,65 @@
+#include "mock.h"
+#include "cl_event_system.h"
+#include "crc.h"
+#include "string.h"
+
+//**************事件****************
+#define MOCK_EVENT_MAX_LISTENER (16)
+
+typedef struct
+{
+    CL_EventCallback_t func;
+    CL_Event_t event;
+    uint8_t session;
+} Listener_t;
+
+static Listener_t listeners[MOCK_EVENT_MAX_LISTENER];
+static int listenerCount = 0;
+
+void MockEvent_Reset(void)
+{
+    listenerCount = 0;
+}
+
+CL_Result_t CL_EventSysInit(void)
+{
+    MockEvent_Reset();
+    return CL_ResSuccess;
+}
+
+CL_Result_t CL_EventSysAddListener(CL_EventCallback_t func, CL_Event_t event, uint8_t session)
+{
+    if (listenerCount >= MOCK_EVENT_MAX_LISTENER)
+        return CL_ResFailed;
+
+    listeners[listenerCount++] = (Listener_t){func, event, session};
+    return CL_ResSuccess;
+}
+
+CL_Result_t CL_EventSysRaise(CL_Event_t event, uint8_t session, void *eventArg)
+{
+    for (int i = 0; i < listenerCount; i++)
+    {
+        if (listeners[i].event == event && listeners[i].session == session)
+            listeners[i].func(eventArg);
+    }
+    return CL_ResSuccess;
+}
+
+//**************CRC****************
+// clib中的实现不在本仓库, 这里按32位小端字输入、高位先移计算, 只需在主机构建内自洽
+uint32_t Ethernet_CRC32(const uint8_t *data, uint32_t length)
+{
+    uint32_t crc = 0xffffffff;
+    for (uint32_t i = 0; i < length; i += 4)
+    {
+        uint32_t word = 0;
+        for (uint32_t j = 0; j < 4 && i + j < length; j++)
+            word |= (uint32_t)data[i + j] << (j * 8);
+
+        crc ^= word;
+        for (int bit = 0; bit < 32; bit++)
+            crc = (crc & 0x80000000) ? (crc << 1) ^ 0x04C11DB7 : crc << 1;
+    }
+    return crc;
+}
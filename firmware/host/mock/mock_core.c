@@ -0,0 +1,78 @@
+#include "mock.h"
+#include "trace.h"
+#include "stdio.h"
+#include "stdlib.h"
+
+// 内核/GPIO/跟踪等app与boot共用的部分, 外设模拟见mock_hw.c
+
+DWT_Type mockDwt;
+CoreDebug_Type mockCoreDebug;
+uint32_t SystemCoreClock = 72000000;
+uint32_t mockPrimask = 0;
+GPIO_TypeDef mockGpio[3];
+bool hostLogEnable = false;
+
+__attribute__((constructor)) static void MockHw_Init(void)
+{
+    const char *env = getenv("HOST_LOG");
+    hostLogEnable = env != NULL && env[0] == '1';
+}
+
+//**************GPIO****************
+void MockGpio_Set(GPIO_TypeDef *port, uint32_t pin, bool high)
+{
+    if (high)
+        port->IDR |= pin;
+    else
+        port->IDR &= ~pin;
+}
+
+void MockGpio_SetAll(uint32_t a, uint32_t b, uint32_t c)
+{
+    GPIOA->IDR = a;
+    GPIOB->IDR = b;
+    GPIOC->IDR = c;
+}
+
+void MockGpio_GetAll(uint32_t *a, uint32_t *b, uint32_t *c)
+{
+    *a = GPIOA->IDR;
+    *b = GPIOB->IDR;
+    *c = GPIOC->IDR;
+}
+
+//**************复位/跳转****************
+static MockResetFunc resetHook = NULL;
+static MockJumpFunc jumpHook = NULL;
+
+void MockCpu_SetResetHook(MockResetFunc func)
+{
+    resetHook = func;
+}
+
+void MockCpu_SetJumpHook(MockJumpFunc func)
+{
+    jumpHook = func;
+}
+
+void Mock_SystemReset(void)
+{
+    if (resetHook != NULL)
+        resetHook();
+    fprintf(stderr, "mock: system reset\n");
+    exit(0);
+}
+
+// 跳转前设置MSP, 在此截住, 不执行flash中的内容
+void Mock_SetMsp(uint32_t sp)
+{
+    if (jumpHook != NULL)
+        jumpHook(sp);
+    fprintf(stderr, "mock: jump to app, msp 0x%08x\n", sp);
+    exit(0);
+}
+
+//**************trace****************
+void Trace_Write(const char *fmt, uint32_t argc, uint32_t a0, uint32_t a1, uint32_t a2, uint32_t a3)
+{
+}
@@ -0,0 +1,147 @@
+#include "mock.h"
+#include "iflash_stm32.h"
+#include "string.h"
+#include "stdio.h"
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+// 固件按绝对地址读flash, 把模拟的flash映射到FLASH_BASE, 指针可直接使用
+static uint8_t *flash = NULL;
+static MockFlashStat_t stat;
+static uint32_t powerLossWrites = 0;
+static uint32_t powerLossErases = 0;
+static MockPowerLossFunc powerLossFunc = NULL;
+
+__attribute__((constructor)) static void MockFlash_Init(void)
+{
+    if (MockFlash_Map(NULL) != CL_ResSuccess)
+    {
+        fprintf(stderr, "mock flash: map at 0x%08lx failed\n", (unsigned long)FLASH_BASE);
+        _exit(1);
+    }
+}
+
+CL_Result_t MockFlash_Map(const char *path)
+{
+    int fd = -1;
+    int flags = MAP_SHARED;
+    if (path == NULL)
+    {
+        flags = MAP_PRIVATE | MAP_ANONYMOUS;
+    }
+    else
+    {
+        fd = open(path, O_RDWR | O_CREAT, 0644);
+        if (fd < 0)
+            return CL_ResFailed;
+        off_t size = lseek(fd, 0, SEEK_END);
+        if (size < (off_t)MOCK_FLASH_SIZE)
+        { // 新文件或长度不足, 补齐为擦除状态
+            static const uint8_t erased[1024] = {[0 ... 1023] = 0xff};
+            for (off_t pos = size; pos < (off_t)MOCK_FLASH_SIZE; pos += sizeof(erased))
+                if (pwrite(fd, erased, CL_MIN(sizeof(erased), MOCK_FLASH_SIZE - pos), pos) < 0)
+                    return close(fd), CL_ResFailed;
+        }
+    }
+
+    if (flash != NULL)
+        munmap(flash, MOCK_FLASH_SIZE);
+    void *addr = mmap((void *)FLASH_BASE, MOCK_FLASH_SIZE, PROT_READ | PROT_WRITE, flags | MAP_FIXED_NOREPLACE, fd, 0);
+    if (fd >= 0)
+        close(fd);
+    if (addr != (void *)FLASH_BASE)
+    {
+        if (addr != MAP_FAILED)
+            munmap(addr, MOCK_FLASH_SIZE);
+        flash = NULL;
+        return CL_ResFailed;
+    }
+
+    flash = addr;
+    if (path == NULL)
+        memset(flash, 0xff, MOCK_FLASH_SIZE);
+    return CL_ResSuccess;
+}
+
+CL_Result_t MockFlash_Load(const char *path)
+{
+    FILE *f = fopen(path, "rb");
+    if (f == NULL)
+        return CL_ResFailed;
+    size_t len = fread(flash, 1, MOCK_FLASH_SIZE, f);
+    fclose(f);
+    return len > 0 ? CL_ResSuccess : CL_ResFailed;
+}
+
+void MockFlash_SetPowerLoss(uint32_t writes, uint32_t erases, MockPowerLossFunc func)
+{
+    powerLossWrites = writes;
+    powerLossErases = erases;
+    powerLossFunc = func;
+}
+
+static void PowerLoss(void)
+{
+    powerLossWrites = 0;
+    powerLossErases = 0;
+    if (powerLossFunc != NULL)
+        powerLossFunc();
+    _exit(MOCK_POWER_LOSS_EXIT);
+}
+
+const MockFlashStat_t *MockFlash_GetStat(void)
+{
+    return &stat;
+}
+
+uint8_t *MockFlash_Ptr(uint32_t addr)
+{
+    return flash + (addr - FLASH_BASE);
+}
+
+static bool InFlash(uint32_t addr, uint32_t length)
+{
+    return addr >= FLASH_BASE && length <= MOCK_FLASH_SIZE && addr - FLASH_BASE <= MOCK_FLASH_SIZE - length;
+}
+
+CL_Result_t IFlashStm32_ErasePages(uint32_t addr, uint32_t pages)
+{
+    if ((addr - FLASH_BASE) % FLASH_PAGE_SIZE != 0 || !InFlash(addr, pages * FLASH_PAGE_SIZE))
+        return CL_ResFailed;
+
+    for (uint32_t i = 0; i < pages; i++)
+    {
+        uint8_t *page = MockFlash_Ptr(addr + i * FLASH_PAGE_SIZE);
+        if (powerLossErases > 0 && --powerLossErases == 0)
+        { // 擦除中途掉电, 页内容不确定, 这里按前一半已擦除处理
+            memset(page, 0xff, FLASH_PAGE_SIZE / 2);
+            PowerLoss();
+        }
+        memset(page, 0xff, FLASH_PAGE_SIZE);
+        stat.erasePages++;
+    }
+    return CL_ResSuccess;
+}
+
+// 与硬件一样按半字编程, 目标半字未擦除(且写入值不为0)时失败
+CL_Result_t IFlashStm32_Write(uint32_t addr, const uint8_t *buff, uint32_t length)
+{
+    if (addr % 2 != 0 || !InFlash(addr, (length + 1) & ~1u))
+        return CL_ResFailed;
+
+    uint8_t *dst = MockFlash_Ptr(addr);
+    for (uint32_t i = 0; i < length; i += 2)
+    {
+        uint16_t value = buff[i] | (i + 1 < length ? buff[i + 1] << 8 : 0xff00);
+        uint16_t old = dst[i] | dst[i + 1] << 8;
+        if (old != 0xffff && value != 0)
+            return CL_ResFailed;
+        if (powerLossWrites > 0 && --powerLossWrites == 0)
+            PowerLoss();
+        dst[i] = value;
+        dst[i + 1] = value >> 8;
+    }
+    stat.writeBytes += length;
+    return CL_ResSuccess;
+}
@@ -0,0 +1,140 @@
+#include "mock.h"
+#include "adc.h"
+#include "ustime.h"
+#include "tim.h"
+#include "usb_device.h"
+#include "usbd_hid.h"
+#include "string.h"
+
+//**************ADC****************
+static uint16_t adcResult[AdcChan_Max] = {2048, 2048, 2048, 2048, 2048, 2048};
+static uint32_t stickFrame = 0;
+static AdcSample_t stickStream[32];
+static AdcSample_t hallStream[64];
+static AdcRing_t stream[AdcStream_Max] = {
+    {stickStream, 32, 0},
+    {hallStream, 64, 0},
+};
+
+void MockAdc_SetFrame(const uint16_t adc[6])
+{
+    memcpy(adcResult, adc, sizeof(adcResult));
+    stickFrame++;
+    uint32_t now = GetUsTime();
+    AdcRing_Push(&stream[AdcStream_Stick], now, adc[AdcChan_LeftX], adc[AdcChan_LeftY],
+                 adc[AdcChan_RightX], adc[AdcChan_RightY]);
+    AdcRing_Push(&stream[AdcStream_Hall], now, adc[AdcChan_LeftHall], adc[AdcChan_RightHall], 0, 0);
+}
+
+void MockAdc_Set(int chan, uint16_t value)
+{
+    adcResult[chan] = value;
+}
+
+uint16_t GetAdcResult(AdcChannel_t chan)
+{
+    return adcResult[chan];
+}
+
+uint32_t AdcGetStickFrame(void)
+{
+    return stickFrame;
+}
+
+uint32_t AdcStream_Read(AdcStream_t stream_, uint32_t *readCount, AdcSample_t *out, uint32_t max)
+{
+    return AdcRing_Read(&stream[stream_], readCount, out, max);
+}
+
+uint32_t AdcStream_Count(AdcStream_t stream_)
+{
+    return stream[stream_].writeCount;
+}
+
+void AdcStop(void)
+{
+}
+
+void AdcResume(void)
+{
+}
+
+//**************PWM****************
+TIM_HandleTypeDef htim1;
+TIM_HandleTypeDef htim3;
+static MockPwm_t pwm;
+
+const MockPwm_t *MockPwm_Get(void)
+{
+    return &pwm;
+}
+
+void PwmSetDuty(PwmChannel_t chan, uint16_t duty)
+{
+    if (chan == PwmChan_PadLed)
+        pwm.padLed = duty;
+    else
+        pwm.motor[chan] = duty;
+}
+
+void PwmSetMotorDuty(uint16_t left, uint16_t right)
+{
+    pwm.motor[0] = left;
+    pwm.motor[1] = right;
+    pwm.motorUpdates++;
+}
+
+void PwmPlayPadLedWave(const uint16_t *wave, uint16_t len, uint8_t stepMs)
+{
+    pwm.padLed = len > 0 ? wave[0] : 0;
+    pwm.ledWaves++;
+}
+
+void PwmSuspend(void)
+{
+}
+
+void PwmResume(void)
+{
+}
+
+//**************USB****************
+USBD_HandleTypeDef hUsbDeviceFS;
+static bool usbIdle = true;
+static MockUsbReportFunc reportHook = NULL;
+static PadReport_t lastReport;
+static uint32_t reportCount = 0;
+
+void MockUsb_SetIdle(bool idle)
+{
+    usbIdle = idle;
+}
+
+void MockUsb_SetReportHook(MockUsbReportFunc func)
+{
+    reportHook = func;
+}
+
+const void *MockUsb_LastReport(void)
+{
+    return &lastReport;
+}
+
+uint32_t MockUsb_ReportCount(void)
+{
+    return reportCount;
+}
+
+bool USBD_UploadIdle(USBD_HandleTypeDef *pdev)
+{
+    return usbIdle;
+}
+
+CL_Result_t USBD_SendPadReport(USBD_HandleTypeDef *pdev, const PadReport_t *report)
+{
+    lastReport = *report;
+    reportCount++;
+    if (reportHook != NULL)
+        reportHook(report, sizeof(PadReport_t));
+    return CL_ResSuccess;
+}
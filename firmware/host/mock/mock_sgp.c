@@ -0,0 +1,47 @@
+#include "mock.h"
+#include "sgp_protocol.h"
+#include "cl_event_system.h"
+
+// SGP协议固件侧接口的主机替代实现, 编解码见sgp_host.c
+
+//**************固件接口****************
+typedef struct
+{
+    SgpSendFunc_t sendFunc;
+    SgpHostParser_t parser;
+} SgpChannel_t;
+
+static SgpChannel_t channels[SpgChannelHandle_Max];
+
+void SgpProtocol_AddChannel(uint8_t handle, SgpSendFunc_t sendFunc)
+{
+    if (handle < SpgChannelHandle_Max)
+        channels[handle].sendFunc = sendFunc;
+}
+
+static void RaiseRecvMsg(const SgpPacket_t *pack, void *arg)
+{
+    CL_EventSysRaise(CL_Event_SgpRecvMsg, 0, (void *)pack);
+}
+
+void MockSgp_Reset(void)
+{
+    for (int i = 0; i < SpgChannelHandle_Max; i++)
+        channels[i].parser.pos = 0;
+}
+
+void SgpProtocol_RecvData(uint8_t handle, const uint8_t *data, uint32_t length)
+{
+    if (handle < SpgChannelHandle_Max)
+        SgpHost_Feed(&channels[handle].parser, data, length, RaiseRecvMsg, NULL);
+}
+
+CL_Result_t SgpProtocol_SendMsg(uint8_t handle, uint8_t cmd, uint8_t subCmd, const uint8_t *data, uint8_t length)
+{
+    if (handle >= SpgChannelHandle_Max || channels[handle].sendFunc == NULL)
+        return CL_ResFailed;
+
+    uint8_t frame[SGP_HOST_MAX_FRAME];
+    uint16_t frameSize = SgpHost_Encode(frame, cmd, subCmd, data, length);
+    return channels[handle].sendFunc(frame, frameSize);
+}
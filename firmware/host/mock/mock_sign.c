@@ -0,0 +1,34 @@
+#include "mock.h"
+#include "sign_check.h"
+#include "crc.h"
+#include "string.h"
+
+// cmox库只有Cortex-M3的二进制, 主机上用CRC32派生的64字节代替ECDSA签名,
+// 只用于走通升级流程, 不提供任何安全性
+
+void MockSign_Make(const uint8_t *data, uint32_t dataSize, uint8_t sign[MOCK_SIGN_SIZE])
+{
+    uint32_t crc = Ethernet_CRC32(data, dataSize);
+    for (int i = 0; i < MOCK_SIGN_SIZE / 4; i++)
+    {
+        uint32_t word = crc ^ (0x9e3779b9u * (i + 1));
+        sign[i * 4] = word >> 24;
+        sign[i * 4 + 1] = word >> 16;
+        sign[i * 4 + 2] = word >> 8;
+        sign[i * 4 + 3] = word;
+    }
+}
+
+void SignCheck_Init(void)
+{
+}
+
+CL_Result_t SingCheck(const uint8_t *data, uint32_t dataSize, const uint8_t *sign, uint32_t signSize)
+{
+    uint8_t expect[MOCK_SIGN_SIZE];
+    if (signSize != MOCK_SIGN_SIZE)
+        return CL_ResFailed;
+
+    MockSign_Make(data, dataSize, expect);
+    return memcmp(expect, sign, MOCK_SIGN_SIZE) == 0 ? CL_ResSuccess : CL_ResFailed;
+}
@@ -0,0 +1,102 @@
+#include "mock.h"
+#include "ustime.h"
+#include "systime.h"
+
+static uint64_t nowUs = 1000; // 不从0开始, 固件用0表示未初始化
+static uint32_t idleStep = 1000;
+static uint64_t wakeLimit = 0;
+static bool alarmSet = false;
+static uint32_t alarmTime = 0;
+
+void MockTime_Set(uint64_t us)
+{
+    nowUs = us;
+}
+
+void MockTime_Advance(uint32_t us)
+{
+    nowUs += us;
+}
+
+uint64_t MockTime_Get(void)
+{
+    return nowUs;
+}
+
+void MockTime_SetIdleStep(uint32_t us)
+{
+    idleStep = us;
+}
+
+void MockTime_SetWakeLimit(uint64_t us)
+{
+    wakeLimit = us;
+}
+
+uint32_t GetUsTime(void)
+{
+    return (uint32_t)nowUs;
+}
+
+uint64_t GetUsTime64(void)
+{
+    return nowUs;
+}
+
+void UsTimeUpdate(void)
+{
+}
+
+void UsTime_Init(void)
+{
+}
+
+void UsTime_SetAlarm(uint32_t deadline)
+{
+    alarmSet = true;
+    alarmTime = deadline;
+}
+
+void UsTime_CancelAlarm(void)
+{
+    alarmSet = false;
+}
+
+void UsTime_OnAlarm(void)
+{
+    UsTime_CancelAlarm();
+}
+
+void DelayUs(uint32_t us)
+{
+    nowUs += us;
+}
+
+uint32_t GetSysTime(void)
+{
+    return (uint32_t)(nowUs / 1000);
+}
+
+void DelayOnSysTime(uint32_t ms)
+{
+    nowUs += (uint64_t)ms * 1000;
+}
+
+void HAL_Delay(uint32_t ms)
+{
+    DelayOnSysTime(ms);
+}
+
+void Mock_Wfi(void)
+{
+    // 闹钟与硬件一样按低16位比较, 超过65ms时提前唤醒
+    uint32_t step = idleStep;
+    if (alarmSet)
+    {
+        uint32_t diff = (uint16_t)(alarmTime - (uint32_t)nowUs);
+        step = diff == 0 ? 0x10000 : diff;
+    }
+    if (wakeLimit != 0 && nowUs < wakeLimit && nowUs + step > wakeLimit)
+        step = wakeLimit - nowUs;
+    nowUs += step;
+}
@@ -0,0 +1,71 @@
+#include "sgp_host.h"
+#include "string.h"
+
+// 主机帧格式的编解码, 固件(mock_sgp.c)和主机工具共用
+
+static uint16_t Crc16(const uint8_t *data, uint32_t length)
+{
+    uint16_t crc = 0xffff;
+    for (uint32_t i = 0; i < length; i++)
+    {
+        crc ^= (uint16_t)data[i] << 8;
+        for (int bit = 0; bit < 8; bit++)
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+    }
+    return crc;
+}
+
+uint16_t SgpHost_Encode(uint8_t *frame, uint8_t cmd, uint8_t subCmd, const uint8_t *data, uint8_t length)
+{
+    frame[0] = SGP_HOST_SYNC0;
+    frame[1] = SGP_HOST_SYNC1;
+    frame[2] = cmd;
+    frame[3] = subCmd;
+    frame[4] = length;
+    if (length > 0)
+        memcpy(frame + SGP_HOST_HEADER_SIZE, data, length);
+    uint16_t crc = Crc16(frame + 2, length + 3);
+    frame[SGP_HOST_HEADER_SIZE + length] = crc >> 8;
+    frame[SGP_HOST_HEADER_SIZE + length + 1] = crc & 0xff;
+    return SGP_HOST_HEADER_SIZE + length + 2;
+}
+
+void SgpHost_Feed(SgpHostParser_t *parser, const uint8_t *data, uint32_t length, SgpHostPacketFunc func, void *arg)
+{
+    for (uint32_t i = 0; i < length; i++)
+    {
+        uint8_t ch = data[i];
+        if (parser->pos == 0 && ch != SGP_HOST_SYNC0)
+            continue;
+        if (parser->pos == 1 && ch != SGP_HOST_SYNC1)
+        { // 同步失败, 当前字节可能是新的帧头
+            parser->pos = ch == SGP_HOST_SYNC0 ? 1 : 0;
+            continue;
+        }
+
+        parser->buff[parser->pos++] = ch;
+        if (parser->pos < SGP_HOST_HEADER_SIZE)
+            continue;
+
+        uint8_t len = parser->buff[4];
+        uint16_t frameSize = SGP_HOST_HEADER_SIZE + len + 2;
+        if (parser->pos < frameSize)
+            continue;
+
+        parser->pos = 0;
+        uint16_t crc = (parser->buff[frameSize - 2] << 8) | parser->buff[frameSize - 1];
+        if (crc != Crc16(parser->buff + 2, len + 3))
+        {
+            parser->crcErrors++;
+            continue;
+        }
+
+        SgpPacket_t pack = {
+            .cmd = parser->buff[2],
+            .subCmd = parser->buff[3],
+            .length = len,
+            .data = parser->buff + SGP_HOST_HEADER_SIZE,
+        };
+        func(&pack, arg);
+    }
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// mmlib中的SGP协议不在本仓库, 主机构建使用自定的帧格式:
+// A5 5A | cmd | subCmd | len | data[len] | crc16(CCITT, 初值0xffff, 大端, 覆盖cmd~data)
+// 只用于主机上的工具/测试与固件代码互通, 不代表设备上的帧格式
+// 固件侧接口(SgpProtocol_*)见shim/sgp_protocol.h, 由mock_sgp.c实现
+#define SGP_HOST_SYNC0 (0xA5)
+#define SGP_HOST_SYNC1 (0x5A)
+#define SGP_HOST_HEADER_SIZE (5)
+#define SGP_HOST_MAX_DATA (255)
+#define SGP_HOST_MAX_FRAME (SGP_HOST_HEADER_SIZE + SGP_HOST_MAX_DATA + 2)
+
+typedef struct
+{
+    uint8_t cmd;
+    uint8_t subCmd;
+    uint8_t length;
+    const uint8_t *data;
+} SgpPacket_t;
+
+typedef struct
+{
+    uint16_t pos;
+    uint8_t buff[SGP_HOST_MAX_FRAME];
+    uint32_t crcErrors;
+} SgpHostParser_t;
+
+typedef void (*SgpHostPacketFunc)(const SgpPacket_t *pack, void *arg);
+
+// 返回帧长度, frame至少SGP_HOST_MAX_FRAME字节
+uint16_t SgpHost_Encode(uint8_t *frame, uint8_t cmd, uint8_t subCmd, const uint8_t *data, uint8_t length);
+// 逐字节解析, 每个完整且校验正确的帧调用一次func; pack->data指向parser内部, 只在回调中有效
+void SgpHost_Feed(SgpHostParser_t *parser, const uint8_t *data, uint32_t length, SgpHostPacketFunc func, void *arg);
+
+#ifdef __cplusplus
+}
+#endif
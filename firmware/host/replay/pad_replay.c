@@ -0,0 +1,295 @@
+#include "pad_trace.h"
+#include "mock.h"
+#include "adc.h"
+#include "board.h"
+#include "button.h"
+#include "sched.h"
+#include "ustime.h"
+#include "pad_func.h"
+#include "cali.h"
+#include "usbd_hid.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// 输入回放: 按帧时间推进虚拟时钟, 按键和校准任务由调度器按固件中的周期运行,
+// 在每帧的时间点写入ADC和按键引脚后运行一次上报, 输出PadReport_t序列
+//
+// pad_replay trace.ptr [-o out.rep] [--csv out.csv] [--expect golden.rep [--tol n]] [--flash image.bin]
+//   -o       保存上报序列, 用于之后的回归比较
+//   --csv    输出与trace_decode.py --csv相同的列, 可与设备采集的结果对比
+//   --expect 与保存的上报序列逐帧比较, 摇杆轴允许相差tol, 有差异时返回1
+//   --flash  载入读出的flash镜像, 使用设备上保存的校准参数
+
+#define MAX_DIFF_PRINT (10)
+
+typedef struct
+{
+    const char *trace;
+    const char *out;
+    const char *csv;
+    const char *expect;
+    const char *flash;
+    int tol;
+} ReplayArgs_t;
+
+// 按键引脚, 与pad_func.c中上报按键位的顺序一致
+typedef struct
+{
+    GPIO_TypeDef *port;
+    uint32_t pin;
+} PinDef_t;
+
+static const PinDef_t buttonPins[16] = {
+    {BTN_UP_PORT, BTN_UP_PIN},
+    {BTN_DOWN_PORT, BTN_DOWN_PIN},
+    {BTN_LEFT_PORT, BTN_LEFT_PIN},
+    {BTN_RIGHT_PORT, BTN_RIGHT_PIN},
+    {BTN_RMENU_PORT, BTN_RMENU_PIN},
+    {BTN_LMENU_PORT, BTN_LMENU_PIN},
+    {BTN_LSTICK_PORT, BTN_LSTICK_PIN},
+    {BTN_RSTICK_PORT, BTN_RSTICK_PIN},
+    {BTN_LB_PORT, BTN_LB_PIN},
+    {BTN_RB_PORT, BTN_RB_PIN},
+    {BTN_XBOX_PORT, BTN_XBOX_PIN},
+    {BTN_PAIR_PORT, BTN_PAIR_PIN},
+    {BTN_A_PORT, BTN_A_PIN},
+    {BTN_B_PORT, BTN_B_PIN},
+    {BTN_X_PORT, BTN_X_PIN},
+    {BTN_Y_PORT, BTN_Y_PIN},
+};
+
+static void SetButtons(uint16_t buttons)
+{
+    GPIOA->IDR = 0;
+    GPIOB->IDR = 0;
+    GPIOC->IDR = 0;
+    for (int i = 0; i < 16; i++)
+    {
+        if (buttons & (1 << i))
+            buttonPins[i].port->IDR |= buttonPins[i].pin;
+    }
+}
+
+static void *ReadFile(const char *path, uint32_t magic, uint16_t frameSize, uint32_t *count)
+{
+    FILE *f = fopen(path, "rb");
+    if (f == NULL)
+    {
+        perror(path);
+        return NULL;
+    }
+
+    PadTraceHeader_t header;
+    void *frames = NULL;
+    if (fread(&header, sizeof(header), 1, f) != 1 || header.magic != magic ||
+        header.version != PAD_TRACE_VERSION || header.frameSize != frameSize)
+    {
+        fprintf(stderr, "%s: bad header\n", path);
+    }
+    else
+    {
+        frames = malloc((size_t)header.frameCount * frameSize + 1);
+        *count = fread(frames, frameSize, header.frameCount, f);
+        if (*count != header.frameCount)
+            fprintf(stderr, "%s: truncated, %u of %u frames\n", path, *count, header.frameCount);
+    }
+    fclose(f);
+    return frames;
+}
+
+static bool WriteReports(const char *path, const PadReport_t *reports, uint32_t count)
+{
+    FILE *f = fopen(path, "wb");
+    if (f == NULL)
+    {
+        perror(path);
+        return false;
+    }
+    PadTraceHeader_t header = {PAD_REPORT_MAGIC, PAD_TRACE_VERSION, sizeof(PadReport_t), count, 0};
+    fwrite(&header, sizeof(header), 1, f);
+    fwrite(reports, sizeof(PadReport_t), count, f);
+    return fclose(f) == 0;
+}
+
+static bool WriteCsv(const char *path, const PadTraceFrame_t *frames, const PadReport_t *reports, uint32_t count)
+{
+    FILE *f = fopen(path, "w");
+    if (f == NULL)
+    {
+        perror(path);
+        return false;
+    }
+    fprintf(f, "time_us,right_hall,right_x,right_y,left_hall,left_x,left_y,button0,button1,"
+               "left_x_out,left_y_out,right_x_out,right_y_out,left_trigger_out,right_trigger_out\n");
+    for (uint32_t i = 0; i < count; i++)
+    {
+        const PadTraceFrame_t *in = &frames[i];
+        const PadReport_t *out = &reports[i];
+        fprintf(f, "%u,%u,%u,%u,%u,%u,%u,%u,%u,%d,%d,%d,%d,%u,%u\n",
+                in->timeUs, in->adc[0], in->adc[1], in->adc[2], in->adc[3], in->adc[4], in->adc[5],
+                in->buttons & 0xff, in->buttons >> 8,
+                out->leftX, out->leftY, out->rightX, out->rightY, out->leftTrigger, out->rightTrigger);
+    }
+    return fclose(f) == 0;
+}
+
+static bool ReportMatch(const PadReport_t *a, const PadReport_t *b, int tol)
+{
+    return abs(a->leftX - b->leftX) <= tol && abs(a->leftY - b->leftY) <= tol &&
+           abs(a->rightX - b->rightX) <= tol && abs(a->rightY - b->rightY) <= tol &&
+           a->leftTrigger == b->leftTrigger && a->rightTrigger == b->rightTrigger &&
+           a->button[0] == b->button[0] && a->button[1] == b->button[1];
+}
+
+static void PrintReport(const char *tag, const PadReport_t *r)
+{
+    printf("  %s: %6d %6d %6d %6d  %3u %3u  %02x %02x\n", tag,
+           r->leftX, r->leftY, r->rightX, r->rightY, r->leftTrigger, r->rightTrigger, r->button[0], r->button[1]);
+}
+
+static uint32_t Compare(const char *path, const PadReport_t *reports, uint32_t count, int tol)
+{
+    uint32_t expectCount = 0;
+    PadReport_t *expect = ReadFile(path, PAD_REPORT_MAGIC, sizeof(PadReport_t), &expectCount);
+    if (expect == NULL)
+        return UINT32_MAX;
+
+    uint32_t diffs = 0;
+    if (expectCount != count)
+    {
+        printf("frame count differs: %u, expect %u\n", count, expectCount);
+        diffs++;
+    }
+    for (uint32_t i = 0; i < CL_MIN(count, expectCount); i++)
+    {
+        if (ReportMatch(&reports[i], &expect[i], tol))
+            continue;
+        if (diffs++ < MAX_DIFF_PRINT)
+        {
+            printf("frame %u differs:\n", i);
+            PrintReport("got   ", &reports[i]);
+            PrintReport("expect", &expect[i]);
+        }
+    }
+    free(expect);
+    return diffs;
+}
+
+static PadReport_t *reportOut;
+static uint32_t reportIndex;
+
+static void OnReport(const void *report, uint32_t len)
+{
+    memcpy(&reportOut[reportIndex++], report, sizeof(PadReport_t));
+}
+
+static void Replay(const PadTraceFrame_t *frames, uint32_t count)
+{
+    // 设备时间为32位, 回放中扩展为64位
+    uint64_t high = 0;
+    uint32_t last = frames[0].timeUs;
+    MockTime_Set(last);
+    SetButtons(frames[0].buttons);
+    MockAdc_SetFrame(frames[0].adc);
+
+    Button_Init();
+    PadFunc_Init();
+    Sched_AddTask(Button_Process, USTIME_MS(1), SchedPrio_Normal, "button");
+    Sched_AddTask(Cali_Process, USTIME_MS(1), SchedPrio_Normal, "cali");
+    MockUsb_SetReportHook(OnReport);
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        const PadTraceFrame_t *frame = &frames[i];
+        if (frame->timeUs < last)
+            high += 1ull << 32;
+        last = frame->timeUs;
+        uint64_t t = high | frame->timeUs;
+
+        // 帧之间的任务看到的是上一帧的输入
+        MockTime_SetWakeLimit(t);
+        while (MockTime_Get() < t)
+            Sched_Run();
+
+        SetButtons(frame->buttons);
+        MockAdc_SetFrame(frame->adc);
+        PadFunc_Process();
+    }
+}
+
+static bool ParseArgs(int argc, char **argv, ReplayArgs_t *args)
+{
+    memset(args, 0, sizeof(ReplayArgs_t));
+    for (int i = 1; i < argc; i++)
+    {
+        const char *next = i + 1 < argc ? argv[i + 1] : NULL;
+        if (strcmp(argv[i], "-o") == 0 && next)
+            args->out = argv[++i];
+        else if (strcmp(argv[i], "--csv") == 0 && next)
+            args->csv = argv[++i];
+        else if (strcmp(argv[i], "--expect") == 0 && next)
+            args->expect = argv[++i];
+        else if (strcmp(argv[i], "--tol") == 0 && next)
+            args->tol = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--flash") == 0 && next)
+            args->flash = argv[++i];
+        else if (argv[i][0] != '-' && args->trace == NULL)
+            args->trace = argv[i];
+        else
+            return false;
+    }
+    return args->trace != NULL;
+}
+
+int main(int argc, char **argv)
+{
+    ReplayArgs_t args;
+    if (!ParseArgs(argc, argv, &args))
+    {
+        fprintf(stderr, "usage: %s trace.ptr [-o out.rep] [--csv out.csv] [--expect golden.rep [--tol n]] "
+                        "[--flash image.bin]\n", argv[0]);
+        return 2;
+    }
+
+    uint32_t count = 0;
+    PadTraceFrame_t *frames = ReadFile(args.trace, PAD_TRACE_MAGIC, sizeof(PadTraceFrame_t), &count);
+    if (frames == NULL || count == 0)
+        return 2;
+    if (args.flash != NULL && MockFlash_Load(args.flash) != CL_ResSuccess)
+    {
+        fprintf(stderr, "%s: load failed\n", args.flash);
+        return 2;
+    }
+
+    reportOut = malloc((size_t)count * sizeof(PadReport_t));
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    Replay(frames, count);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double sec = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+    fprintf(stderr, "replayed %u frames (%.1f s device time) in %.3f s, %.2f Mframe/s\n",
+            count, (frames[count - 1].timeUs - frames[0].timeUs) / 1e6, sec, count / sec / 1e6);
+
+    if (reportIndex != count)
+    {
+        fprintf(stderr, "report count %u != frame count %u\n", reportIndex, count);
+        return 1;
+    }
+    if (args.out != NULL && !WriteReports(args.out, reportOut, count))
+        return 2;
+    if (args.csv != NULL && !WriteCsv(args.csv, frames, reportOut, count))
+        return 2;
+    if (args.expect != NULL)
+    {
+        uint32_t diffs = Compare(args.expect, reportOut, count, args.tol);
+        if (diffs != 0)
+        {
+            printf("%u frames differ from %s\n", diffs, args.expect);
+            return 1;
+        }
+        printf("all %u frames match %s\n", count, args.expect);
+    }
+    return 0;
+}
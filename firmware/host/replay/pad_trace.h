@@ -0,0 +1,30 @@
+#pragma once
+
+// 输入采集的回放格式, 小端, 由trace_decode.py --trace从设备采集记录转换, 或由pad_trace_gen合成
+// 文件头 + 定长帧; 每帧为一次上报时的ADC滤波值和16个按键引脚的状态(按上报按键位顺序, 重映射之前)
+// 回放输出的上报文件头相同, 帧为PadReport_t
+
+#include <stdint.h>
+
+#define PAD_TRACE_MAGIC (0x43525450u)  // "PTRC"
+#define PAD_REPORT_MAGIC (0x50455250u) // "PREP"
+#define PAD_TRACE_VERSION (1)
+
+typedef struct
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t frameSize; // 每帧字节数, 便于以后扩展
+    uint32_t frameCount;
+    uint32_t reserved;
+} PadTraceHeader_t;
+
+typedef struct
+{
+    uint32_t timeUs;   // 设备us时间, 回绕由回放处理
+    uint16_t adc[6];   // AdcChannel_t顺序
+    uint16_t buttons;  // button[1] << 8 | button[0], 对应引脚的电平
+    uint16_t reserved; // 填充到4字节对齐, 写0
+} PadTraceFrame_t;
+
+_Static_assert(sizeof(PadTraceFrame_t) == 20, "trace frame layout");
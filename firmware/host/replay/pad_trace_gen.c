@@ -0,0 +1,83 @@
+#include "pad_trace.h"
+#include "pad_synth.h"
+#include "adc.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// 合成输入: 静止 -> 摇杆搓圈 -> 扳机按压 -> 按键 -> 缓慢漂移, 循环; 2ms一帧
+// 用法: pad_trace_gen 帧数 输出文件
+
+#define FRAME_INTERVAL (2000) // us
+#define SECTION_FRAMES (500)  // 每段1s
+
+static void MakeFrame(uint32_t i, SynthRng_t *rng, const SynthStick_t *left, const SynthStick_t *right,
+                      PadTraceFrame_t *frame)
+{
+    uint32_t section = (i / SECTION_FRAMES) % 5;
+    float t = (i % SECTION_FRAMES) / (float)SECTION_FRAMES; // 段内进度0~1
+    float angle = 0, scale = 0, trigger = 0;
+    uint16_t buttons = 0;
+    SynthStick_t l = *left, r = *right;
+
+    switch (section)
+    {
+    case 0: // 静止
+        break;
+    case 1: // 搓圈, 半径由0推到边界再超出
+        angle = t * 4 * (float)M_PI;
+        scale = fminf(t * 2.4f, 1.2f);
+        break;
+    case 2: // 扳机按到底再松开, 摇杆斜推
+        trigger = 1.0f - fabsf(t * 2 - 1);
+        angle = (float)M_PI / 4;
+        scale = 0.5f;
+        break;
+    case 3: // A/上键/LB依次按下
+        buttons = (t < 0.3f ? 1 << 12 : 0) | (t > 0.2f && t < 0.6f ? 1 << 0 : 0) | (t > 0.5f ? 1 << 8 : 0);
+        break;
+    case 4: // 中心缓慢漂移
+        l.midX += 40 * t;
+        r.midY -= 30 * t;
+        break;
+    }
+
+    frame->timeUs = 1000000u + i * FRAME_INTERVAL;
+    uint16_t *adc = frame->adc;
+    Synth_Stick(&l, rng, angle, scale, &adc[AdcChan_LeftX], &adc[AdcChan_LeftY]);
+    Synth_Stick(&r, rng, -angle, scale, &adc[AdcChan_RightX], &adc[AdcChan_RightY]);
+    adc[AdcChan_LeftHall] = Synth_Clamp(300 + 3300 * trigger + 2.0f * Synth_Gauss(rng));
+    adc[AdcChan_RightHall] = Synth_Clamp(280 + 3400 * trigger + 2.0f * Synth_Gauss(rng));
+    frame->buttons = buttons;
+    frame->reserved = 0;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc != 3)
+    {
+        fprintf(stderr, "usage: %s frames out.ptr\n", argv[0]);
+        return 2;
+    }
+    uint32_t count = strtoul(argv[1], NULL, 0);
+    FILE *f = fopen(argv[2], "wb");
+    if (f == NULL)
+    {
+        perror(argv[2]);
+        return 1;
+    }
+
+    PadTraceHeader_t header = {PAD_TRACE_MAGIC, PAD_TRACE_VERSION, sizeof(PadTraceFrame_t), count, 0};
+    fwrite(&header, sizeof(header), 1, f);
+
+    SynthStick_t left, right;
+    Synth_DefaultSticks(&left, &right);
+    SynthRng_t rng = {20240601};
+    for (uint32_t i = 0; i < count; i++)
+    {
+        PadTraceFrame_t frame;
+        MakeFrame(i, &rng, &left, &right, &frame);
+        fwrite(&frame, sizeof(frame), 1, f);
+    }
+    return fclose(f) == 0 ? 0 : 1;
+}
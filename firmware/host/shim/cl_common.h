@@ -0,0 +1,29 @@
+#pragma once
+
+// 主机构建: common/clib子模块的最小替代, 只包含固件用到的部分
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum
+{
+    CL_ResSuccess = 0,
+    CL_ResFailed,
+    CL_ResBusy,
+} CL_Result_t;
+
+#define CL_NULL NULL
+#define CL_MIN(a, b) ((a) < (b) ? (a) : (b))
+#define CL_MAX(a, b) ((a) > (b) ? (a) : (b))
+#define CL_CLAMP(v, lo, hi) ((v) < (lo) ? (lo) : ((v) > (hi) ? (hi) : (v)))
+#define CL_ARRAY_LENGTH(a) ((int)(sizeof(a) / sizeof((a)[0])))
+#define CL_OFFSET_OF(type, member) offsetof(type, member)
+
+#ifdef __cplusplus
+}
+#endif
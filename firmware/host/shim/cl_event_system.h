@@ -0,0 +1,19 @@
+#pragma once
+
+#include "cl_common.h"
+#include "clib_config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 事件回调, 返回值保留
+typedef bool (*CL_EventCallback_t)(void *eventArg);
+
+CL_Result_t CL_EventSysInit(void);
+CL_Result_t CL_EventSysAddListener(CL_EventCallback_t func, CL_Event_t event, uint8_t session);
+CL_Result_t CL_EventSysRaise(CL_Event_t event, uint8_t session, void *eventArg);
+
+#ifdef __cplusplus
+}
+#endif
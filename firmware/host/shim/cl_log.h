@@ -0,0 +1,18 @@
+#pragma once
+
+#include "cl_common.h"
+#include "clib_config.h"
+
+// 主机构建: 默认不输出, 设置环境变量HOST_LOG=1后由CL_PRINTF打印
+extern bool hostLogEnable;
+
+#define CL_HOST_LOG(tag, fmt, ...)                          \
+    do                                                      \
+    {                                                       \
+        if (hostLogEnable)                                  \
+            CL_PRINTF("[" tag "] " fmt "\n", ##__VA_ARGS__); \
+    } while (0)
+
+#define CL_LOG_INFO(fmt, ...) CL_HOST_LOG("I", fmt, ##__VA_ARGS__)
+#define CL_LOG_WARN(fmt, ...) CL_HOST_LOG("W", fmt, ##__VA_ARGS__)
+#define CL_LOG_ERROR(fmt, ...) CL_HOST_LOG("E", fmt, ##__VA_ARGS__)
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "cl_common.h"
+#include "string.h"
+
+// clib的队列不在本仓库, 主机构建按固件的用法实现定长元素的环形队列
+typedef struct
+{
+    uint8_t *buff;
+    uint16_t elemSize;
+    uint16_t capacity;
+    uint16_t head;
+    uint16_t length;
+} CL_Queue_t;
+
+#define CL_QUEUE_DEF_INIT(name, size, type, modifier) \
+    modifier type name##Buff[size];                    \
+    modifier CL_Queue_t name = {(uint8_t *)name##Buff, sizeof(type), size, 0, 0}
+
+static inline uint16_t CL_QueueLength(const CL_Queue_t *q)
+{
+    return q->length;
+}
+
+static inline uint16_t CL_QueueFreeSpace(const CL_Queue_t *q)
+{
+    return q->capacity - q->length;
+}
+
+static inline bool CL_QueueFull(const CL_Queue_t *q)
+{
+    return q->length >= q->capacity;
+}
+
+static inline void CL_QueueClear(CL_Queue_t *q)
+{
+    q->head = 0;
+    q->length = 0;
+}
+
+static inline CL_Result_t CL_QueueAdd(CL_Queue_t *q, const void *data)
+{
+    if (q->length >= q->capacity)
+        return CL_ResFailed;
+
+    memcpy(q->buff + ((q->head + q->length) % q->capacity) * q->elemSize, data, q->elemSize);
+    q->length++;
+    return CL_ResSuccess;
+}
+
+static inline CL_Result_t CL_QueuePoll(CL_Queue_t *q, void *data)
+{
+    if (q->length == 0)
+        return CL_ResFailed;
+
+    if (data != NULL)
+        memcpy(data, q->buff + q->head * q->elemSize, q->elemSize);
+    q->head = (q->head + 1) % q->capacity;
+    q->length--;
+    return CL_ResSuccess;
+}
+
+// 按从旧到新的顺序遍历, ptr依次指向每个元素
+#define CL_QUEUE_FOR_EACH(q, ptr, type)                                                     \
+    for (uint16_t ptr##Idx = 0;                                                             \
+         ptr##Idx < (q)->length &&                                                          \
+         ((ptr) = (type *)((q)->buff + (((q)->head + ptr##Idx) % (q)->capacity) * (q)->elemSize), 1); \
+         ptr##Idx++)
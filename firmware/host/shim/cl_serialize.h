@@ -0,0 +1,42 @@
+#pragma once
+
+#include "cl_common.h"
+
+typedef enum
+{
+    CL_BigEndian = 0,
+    CL_LittleEndian,
+} CL_Endian_t;
+
+static inline void CL_Uint16ToBytes(uint16_t value, uint8_t *buff, CL_Endian_t endian)
+{
+    if (endian == CL_BigEndian)
+    {
+        buff[0] = value >> 8;
+        buff[1] = value;
+    }
+    else
+    {
+        buff[0] = value;
+        buff[1] = value >> 8;
+    }
+}
+
+static inline void CL_Uint32ToBytes(uint32_t value, uint8_t *buff, CL_Endian_t endian)
+{
+    for (int i = 0; i < 4; i++)
+        buff[endian == CL_BigEndian ? 3 - i : i] = value >> (i * 8);
+}
+
+static inline uint16_t CL_BytesToUint16(const uint8_t *buff, CL_Endian_t endian)
+{
+    return endian == CL_BigEndian ? (uint16_t)(buff[0] << 8 | buff[1]) : (uint16_t)(buff[1] << 8 | buff[0]);
+}
+
+static inline uint32_t CL_BytesToUint32(const uint8_t *buff, CL_Endian_t endian)
+{
+    uint32_t value = 0;
+    for (int i = 0; i < 4; i++)
+        value |= (uint32_t)buff[endian == CL_BigEndian ? 3 - i : i] << (i * 8);
+    return value;
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+#include "cl_common.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 与STM32 CRC外设一致的以太网CRC32(多项式0x04C11DB7)
+uint32_t Ethernet_CRC32(const uint8_t *data, uint32_t length);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,145 @@
+#pragma once
+
+// 主机构建: 代替CubeMX生成的main.h, 只提供固件用到的CMSIS/LL/HAL接口
+// 外设寄存器为普通内存, 由mock_hw.c中的测试接口读写
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//**************CMSIS****************
+typedef struct
+{
+    volatile uint32_t CTRL;
+    volatile uint32_t CYCCNT;
+} DWT_Type;
+
+typedef struct
+{
+    volatile uint32_t DEMCR;
+} CoreDebug_Type;
+
+extern DWT_Type mockDwt;
+extern CoreDebug_Type mockCoreDebug;
+#define DWT (&mockDwt)
+#define CoreDebug (&mockCoreDebug)
+#define CoreDebug_DEMCR_TRCENA_Msk (1UL << 24)
+#define DWT_CTRL_CYCCNTENA_Msk (1UL)
+
+extern uint32_t SystemCoreClock;
+extern uint32_t mockPrimask;
+
+typedef enum
+{
+    DMA1_Channel4_IRQn = 14,
+    ADC1_2_IRQn = 18,
+    TIM2_IRQn = 28,
+    TIM3_IRQn = 29,
+    USART1_IRQn = 37,
+} IRQn_Type;
+
+static inline void __disable_irq(void) { mockPrimask = 1; }
+static inline void __enable_irq(void) { mockPrimask = 0; }
+static inline uint32_t __get_PRIMASK(void) { return mockPrimask; }
+static inline void __set_PRIMASK(uint32_t primask) { mockPrimask = primask; }
+static inline void __DMB(void) { __sync_synchronize(); }
+static inline void __DSB(void) { __sync_synchronize(); }
+static inline void __ISB(void) { __sync_synchronize(); }
+static inline uint32_t __CLZ(uint32_t x) { return x == 0 ? 32 : (uint32_t)__builtin_clz(x); }
+// 单线程运行, 独占访问总是成功
+static inline uint32_t __LDREXW(volatile uint32_t *addr) { return *addr; }
+static inline uint32_t __STREXW(uint32_t value, volatile uint32_t *addr) { *addr = value; return 0; }
+static inline void __CLREX(void) {}
+
+void Mock_Wfi(void);
+#define __WFI() Mock_Wfi()
+#define __BKPT(value) __builtin_trap()
+
+// 复位和boot跳转app由mock截住, 见mock.h中的MockCpu_*
+void Mock_SystemReset(void) __attribute__((noreturn));
+void Mock_SetMsp(uint32_t sp) __attribute__((noreturn));
+#define NVIC_SystemReset() Mock_SystemReset()
+#define __set_MSP(sp) Mock_SetMsp(sp)
+
+static inline uint32_t NVIC_GetPriorityGrouping(void) { return 0; }
+static inline uint32_t NVIC_EncodePriority(uint32_t group, uint32_t preempt, uint32_t sub) { return preempt; }
+static inline void NVIC_SetPriority(IRQn_Type irq, uint32_t prio) {}
+static inline void NVIC_EnableIRQ(IRQn_Type irq) {}
+static inline void NVIC_DisableIRQ(IRQn_Type irq) {}
+
+//**************GPIO****************
+typedef struct
+{
+    volatile uint32_t IDR;
+    volatile uint32_t ODR;
+} GPIO_TypeDef;
+
+extern GPIO_TypeDef mockGpio[3];
+#define GPIOA (&mockGpio[0])
+#define GPIOB (&mockGpio[1])
+#define GPIOC (&mockGpio[2])
+
+#define LL_GPIO_PIN_0 (1UL << 0)
+#define LL_GPIO_PIN_1 (1UL << 1)
+#define LL_GPIO_PIN_2 (1UL << 2)
+#define LL_GPIO_PIN_3 (1UL << 3)
+#define LL_GPIO_PIN_4 (1UL << 4)
+#define LL_GPIO_PIN_5 (1UL << 5)
+#define LL_GPIO_PIN_6 (1UL << 6)
+#define LL_GPIO_PIN_7 (1UL << 7)
+#define LL_GPIO_PIN_8 (1UL << 8)
+#define LL_GPIO_PIN_9 (1UL << 9)
+#define LL_GPIO_PIN_10 (1UL << 10)
+#define LL_GPIO_PIN_11 (1UL << 11)
+#define LL_GPIO_PIN_12 (1UL << 12)
+#define LL_GPIO_PIN_13 (1UL << 13)
+#define LL_GPIO_PIN_14 (1UL << 14)
+#define LL_GPIO_PIN_15 (1UL << 15)
+
+#define LL_APB2_GRP1_PERIPH_GPIOA (1UL << 2)
+#define LL_APB2_GRP1_PERIPH_GPIOB (1UL << 3)
+#define LL_APB2_GRP1_PERIPH_GPIOC (1UL << 4)
+
+static inline uint32_t LL_GPIO_IsInputPinSet(GPIO_TypeDef *port, uint32_t pin)
+{
+    return (port->IDR & pin) == pin;
+}
+
+static inline void LL_GPIO_SetOutputPin(GPIO_TypeDef *port, uint32_t pin) { port->ODR |= pin; }
+static inline void LL_GPIO_ResetOutputPin(GPIO_TypeDef *port, uint32_t pin) { port->ODR &= ~pin; }
+static inline void LL_GPIO_TogglePin(GPIO_TypeDef *port, uint32_t pin) { port->ODR ^= pin; }
+
+#define LL_GPIO_MODE_INPUT (0x04U)
+#define LL_GPIO_PULL_DOWN (0x00U)
+static inline void LL_APB2_GRP1_EnableClock(uint32_t periphs) {}
+
+//**************HAL****************
+typedef struct
+{
+    uint32_t dummy;
+} TIM_HandleTypeDef;
+
+#define TIM_IT_UPDATE (1UL)
+#define __HAL_TIM_ENABLE_IT(handle, it) ((void)(handle), (void)(it))
+#define __HAL_TIM_DISABLE_IT(handle, it) ((void)(handle), (void)(it))
+
+#define FLASH_BASE (0x08000000UL)
+#define FLASH_PAGE_SIZE (0x400U)
+
+typedef enum
+{
+    HAL_OK = 0,
+    HAL_ERROR,
+} HAL_StatusTypeDef;
+
+static inline HAL_StatusTypeDef HAL_FLASH_Unlock(void) { return HAL_OK; }
+static inline HAL_StatusTypeDef HAL_FLASH_Lock(void) { return HAL_OK; }
+void HAL_Delay(uint32_t ms);
+
+#ifdef __cplusplus
+}
+#endif
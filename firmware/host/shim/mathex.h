@@ -0,0 +1,5 @@
+#pragma once
+
+#include <math.h>
+
+#define FLOAT_NEAR(a, b, eps) (fabsf((float)(a) - (float)(b)) < (eps))
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "cl_common.h"
+
+// clib的多缓冲区不在本仓库, 主机构建按comm.c的用法实现: count个size字节的缓冲区组成的队列
+// GetBack取得下一个可写的缓冲区, 写好后Push提交长度; Peek/Pop按先后顺序读出
+typedef struct
+{
+    uint8_t *buff;
+    uint32_t *lens;
+    uint16_t size;
+    uint16_t count;
+    uint16_t head;
+    uint16_t length;
+} MultiBuffer_t;
+
+#define MULTIBUFFER_STATIC_DEF(name, bufSize, bufCount, modifier) \
+    modifier uint8_t name##Buff[(bufCount) * (bufSize)];          \
+    modifier uint32_t name##Lens[bufCount];                       \
+    modifier MultiBuffer_t name = {name##Buff, name##Lens, bufSize, bufCount, 0, 0}
+
+static inline int MultiBufferGetBack(MultiBuffer_t *mb, uint8_t **buff)
+{
+    if (mb->length >= mb->count)
+        return -1;
+
+    *buff = mb->buff + ((mb->head + mb->length) % mb->count) * mb->size;
+    return 0;
+}
+
+static inline int MultiBufferPush(MultiBuffer_t *mb, uint32_t len)
+{
+    if (mb->length >= mb->count || len > mb->size)
+        return -1;
+
+    mb->lens[(mb->head + mb->length) % mb->count] = len;
+    mb->length++;
+    return 0;
+}
+
+static inline uint16_t MultiBufferGetCount(const MultiBuffer_t *mb)
+{
+    return mb->length;
+}
+
+static inline int MultiBufferPeek(MultiBuffer_t *mb, uint16_t idx, uint8_t **buff, uint32_t *len)
+{
+    if (idx >= mb->length)
+        return -1;
+
+    uint16_t pos = (mb->head + idx) % mb->count;
+    *buff = mb->buff + pos * mb->size;
+    *len = mb->lens[pos];
+    return 0;
+}
+
+static inline int MultiBufferPop(MultiBuffer_t *mb)
+{
+    if (mb->length == 0)
+        return -1;
+
+    mb->head = (mb->head + 1) % mb->count;
+    mb->length--;
+    return 0;
+}
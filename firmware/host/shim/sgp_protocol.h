@@ -0,0 +1,22 @@
+#pragma once
+
+#include "cl_common.h"
+#include "mmlib_config.h"
+#include "sgp_host.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// mmlib中SGP协议的固件侧接口, 主机构建由mock_sgp.c实现, 帧格式见sgp_host.h
+
+typedef CL_Result_t (*SgpSendFunc_t)(const uint8_t *buff, uint16_t count);
+
+void SgpProtocol_AddChannel(uint8_t handle, SgpSendFunc_t sendFunc);
+// 每收到一个完整的帧, 以SgpPacket_t *为参数触发CL_Event_SgpRecvMsg
+void SgpProtocol_RecvData(uint8_t handle, const uint8_t *data, uint32_t length);
+CL_Result_t SgpProtocol_SendMsg(uint8_t handle, uint8_t cmd, uint8_t subCmd, const uint8_t *data, uint8_t length);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,13 @@
+#pragma once
+
+#include "main.h"
+
+// mmlib的GPIO抽象, boot只用来读配对键
+static inline void Mmhl_GpioInit(GPIO_TypeDef *port, uint32_t pin, uint32_t mode, uint32_t pull)
+{
+}
+
+static inline uint8_t Mmhl_GpioReadInput(GPIO_TypeDef *port, uint32_t pin)
+{
+    return LL_GPIO_IsInputPinSet(port, pin) ? 1 : 0;
+}
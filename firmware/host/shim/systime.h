@@ -0,0 +1,23 @@
+#pragma once
+
+#include "cl_common.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ms时基, 主机构建中由虚拟时钟换算
+#define SYSTIME_SECOND(x) ((x) * 1000UL)
+
+uint32_t GetSysTime(void);
+
+static inline uint32_t SysTimeSpan(uint32_t lastTime)
+{
+    return GetSysTime() - lastTime;
+}
+
+void DelayOnSysTime(uint32_t ms);
+
+#ifdef __cplusplus
+}
+#endif
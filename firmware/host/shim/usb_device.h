@@ -0,0 +1,5 @@
+#pragma once
+
+#include "usbd_ioreq.h"
+
+extern USBD_HandleTypeDef hUsbDeviceFS;
@@ -0,0 +1,11 @@
+#pragma once
+
+#include "usbd_ioreq.h"
+
+// 主机构建: CDC由boot_emu的pty代替, 发送一次完成
+#define APP_TX_DATA_SIZE 64
+
+extern uint8_t UserTxBufferFS[APP_TX_DATA_SIZE];
+
+uint8_t CDC_Transmit_FS(uint8_t *Buf, uint16_t Len);
+USBD_StatusTypeDef CDC_GetTransmitStatus(void);
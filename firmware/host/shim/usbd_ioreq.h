@@ -0,0 +1,21 @@
+#pragma once
+
+// 主机构建: USB协议栈只保留类型, 上报由mock_usb.c记录
+#include "main.h"
+
+typedef struct
+{
+    uint32_t dummy;
+} USBD_HandleTypeDef;
+
+typedef struct
+{
+    uint32_t dummy;
+} USBD_ClassTypeDef;
+
+typedef enum
+{
+    USBD_OK = 0,
+    USBD_BUSY,
+    USBD_FAIL,
+} USBD_StatusTypeDef;
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "cl_common.h"
+#include <math.h>
+
+typedef struct
+{
+    float x;
+    float y;
+} Vector2;
+
+static inline float Vector2_SqrMagnitude(const Vector2 *v)
+{
+    return v->x * v->x + v->y * v->y;
+}
+
+static inline float Vector2_Magnitude(const Vector2 *v)
+{
+    return sqrtf(v->x * v->x + v->y * v->y);
+}
+
+static inline float Vector2_Cos(const Vector2 *a, const Vector2 *b)
+{
+    return (a->x * b->x + a->y * b->y) / (Vector2_Magnitude(a) * Vector2_Magnitude(b));
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+// 合成的摇杆/扳机输入, 测试/基准/回放共用
+// 摇杆边界为偏心的多瓣形状, 叠加高斯噪声, 与真实摇杆的误差来源相近
+
+#include <math.h>
+#include <stdint.h>
+
+typedef struct
+{
+    uint32_t state;
+} SynthRng_t;
+
+static inline uint32_t Synth_Next(SynthRng_t *rng)
+{ // xorshift32
+    uint32_t x = rng->state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return rng->state = x;
+}
+
+static inline float Synth_Uniform(SynthRng_t *rng)
+{
+    return (Synth_Next(rng) >> 8) * (1.0f / 16777216.0f);
+}
+
+static inline float Synth_Gauss(SynthRng_t *rng)
+{ // 12个均匀分布之和近似正态分布
+    float sum = 0;
+    for (int i = 0; i < 12; i++)
+        sum += Synth_Uniform(rng);
+    return sum - 6.0f;
+}
+
+typedef struct
+{
+    float midX, midY; // 中心ADC值
+    float radius;     // 平均边界半径
+    float lobe[3];    // 1~3次谐波幅度(与radius之比)
+    float phase[3];
+    float noise; // ADC噪声标准差
+} SynthStick_t;
+
+// angle从+y轴起顺时针, 与cali.c中边界表的角度一致
+static inline float Synth_Boundary(const SynthStick_t *s, float angle)
+{
+    float r = 1.0f;
+    for (int k = 0; k < 3; k++)
+        r += s->lobe[k] * cosf((k + 1) * angle + s->phase[k]);
+    return s->radius * r;
+}
+
+static inline uint16_t Synth_Clamp(float v)
+{
+    return v < 0 ? 0 : (v > 4095 ? 4095 : (uint16_t)(v + 0.5f));
+}
+
+// scale: 0为中心, 1为推到边界
+static inline void Synth_Stick(const SynthStick_t *s, SynthRng_t *rng, float angle, float scale,
+                               uint16_t *x, uint16_t *y)
+{
+    float r = Synth_Boundary(s, angle) * scale;
+    *x = Synth_Clamp(s->midX + r * sinf(angle) + s->noise * Synth_Gauss(rng));
+    *y = Synth_Clamp(s->midY + r * cosf(angle) + s->noise * Synth_Gauss(rng));
+}
+
+static inline void Synth_DefaultSticks(SynthStick_t *left, SynthStick_t *right)
+{
+    *left = (SynthStick_t){
+        .midX = 2010, .midY = 2093, .radius = 1400,
+        .lobe = {0.03f, 0.05f, 0.02f}, .phase = {0.4f, 1.1f, 2.0f}, .noise = 2.0f};
+    *right = (SynthStick_t){
+        .midX = 2101, .midY = 1987, .radius = 1350,
+        .lobe = {0.02f, 0.04f, 0.03f}, .phase = {2.3f, 0.2f, 0.9f}, .noise = 2.0f};
+}
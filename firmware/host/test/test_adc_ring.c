@@ -0,0 +1,87 @@
+#include "adc_ring.h"
+#include "test_util.h"
+
+#define RING_LEN (8)
+
+static AdcSample_t buff[RING_LEN];
+static AdcRing_t ring;
+
+static void Push(uint32_t i)
+{
+    AdcRing_Push(&ring, i * 500, i, i + 1, i + 2, i + 3);
+}
+
+// 按写入顺序读出, 时间和数值对应
+static void TestInOrder(void)
+{
+    AdcRing_Init(&ring, buff, RING_LEN);
+    uint32_t readCount = 0;
+    AdcSample_t out[RING_LEN];
+    TEST_EQ(AdcRing_Read(&ring, &readCount, out, RING_LEN), 0);
+
+    for (uint32_t i = 0; i < 5; i++)
+        Push(i);
+    TEST_EQ(AdcRing_Read(&ring, &readCount, out, 3), 3); // 受max限制
+    TEST_EQ(AdcRing_Read(&ring, &readCount, out + 3, RING_LEN), 2);
+    for (uint32_t i = 0; i < 5; i++)
+    {
+        TEST_EQ(out[i].time, i * 500);
+        TEST_EQ(out[i].value[0], i);
+        TEST_EQ(out[i].value[3], i + 3);
+    }
+    TEST_EQ(readCount, 5);
+}
+
+// 两个读者各自保存读计数, 互不影响
+static void TestIndependentReaders(void)
+{
+    AdcRing_Init(&ring, buff, RING_LEN);
+    uint32_t fast = 0, slow = 0;
+    AdcSample_t out[RING_LEN];
+    for (uint32_t i = 0; i < 6; i++)
+    {
+        Push(i);
+        TEST_EQ(AdcRing_Read(&ring, &fast, out, RING_LEN), 1);
+        TEST_EQ(out[0].value[0], i);
+    }
+    TEST_EQ(AdcRing_Read(&ring, &slow, out, RING_LEN), 6);
+    TEST_EQ(out[5].value[0], 5);
+}
+
+// 读取落后超过缓冲长度时丢弃最旧的, 只读出最近RING_LEN个
+static void TestOverrun(void)
+{
+    AdcRing_Init(&ring, buff, RING_LEN);
+    uint32_t readCount = 0;
+    AdcSample_t out[RING_LEN];
+    for (uint32_t i = 0; i < 20; i++)
+        Push(i);
+    TEST_EQ(AdcRing_Read(&ring, &readCount, out, RING_LEN), RING_LEN);
+    TEST_EQ(out[0].value[0], 20 - RING_LEN);
+    TEST_EQ(out[RING_LEN - 1].value[0], 19);
+    TEST_EQ(readCount, 20);
+}
+
+// 写计数溢出回绕后仍按顺序读出
+static void TestCountWrap(void)
+{
+    AdcRing_Init(&ring, buff, RING_LEN);
+    ring.writeCount = 0xfffffffdu;
+    uint32_t readCount = ring.writeCount;
+    AdcSample_t out[RING_LEN];
+    for (uint32_t i = 0; i < 6; i++)
+        Push(i);
+    TEST_EQ(ring.writeCount, 3);
+    TEST_EQ(AdcRing_Read(&ring, &readCount, out, RING_LEN), 6);
+    for (uint32_t i = 0; i < 6; i++)
+        TEST_EQ(out[i].value[0], i);
+}
+
+int main(void)
+{
+    TEST_RUN(TestInOrder);
+    TEST_RUN(TestIndependentReaders);
+    TEST_RUN(TestOverrun);
+    TEST_RUN(TestCountWrap);
+    return TEST_RESULT();
+}
@@ -0,0 +1,116 @@
+#include "button.h"
+#include "board.h"
+#include "cl_event_system.h"
+#include "systime.h"
+#include "mock.h"
+#include "test_util.h"
+
+#define EVENT_LOG_LEN (32)
+static ButtonEvent_t events[EVENT_LOG_LEN];
+static uint32_t eventTime[EVENT_LOG_LEN];
+static int eventCount = 0;
+
+static bool OnPairEvent(void *eventArg)
+{
+    if (eventCount < EVENT_LOG_LEN)
+    {
+        events[eventCount] = *(ButtonEvent_t *)eventArg;
+        eventTime[eventCount] = GetSysTime();
+        eventCount++;
+    }
+    return true;
+}
+
+// 按1ms任务周期运行ms次
+static void RunMs(uint32_t ms)
+{
+    for (uint32_t i = 0; i < ms; i++)
+    {
+        MockTime_Advance(1000);
+        Button_Process();
+    }
+}
+
+static void SetPair(bool press)
+{
+    MockGpio_Set(BTN_PAIR_PORT, BTN_PAIR_PIN, press);
+}
+
+static void TestBounceRejected(void)
+{
+    eventCount = 0;
+    // 按键抖动: 每10ms翻转一次, 持续300ms, 单次按下都不足去抖时间
+    for (int i = 0; i < 30; i++)
+    {
+        SetPair(i % 2 == 0);
+        RunMs(10);
+    }
+    SetPair(false);
+    RunMs(10);
+    TEST_EQ(eventCount, 0);
+    TEST_CHECK(!Button_IsPressed(BtnIdx_Pair));
+}
+
+static void TestClick(void)
+{
+    eventCount = 0;
+    uint32_t pressAt = GetSysTime();
+    SetPair(true);
+    RunMs(BUTTON_BOUNCE_TIME - 2);
+    TEST_EQ(eventCount, 0);
+    RunMs(3);
+    TEST_EQ(eventCount, 1);
+    TEST_EQ(events[0], ButtonEvent_Down);
+    TEST_NEAR(eventTime[0] - pressAt, BUTTON_BOUNCE_TIME, 1);
+    TEST_CHECK(Button_IsPressed(BtnIdx_Pair));
+
+    RunMs(100);
+    SetPair(false);
+    RunMs(1);
+    TEST_EQ(eventCount, 2);
+    TEST_EQ(events[1], ButtonEvent_Click);
+    TEST_CHECK(!Button_IsPressed(BtnIdx_Pair));
+}
+
+static void TestLongPress(void)
+{
+    eventCount = 0;
+    SetPair(true);
+    RunMs(BUTTON_LONG_PRESS_TIME + 10);
+    TEST_EQ(eventCount, 2);
+    TEST_EQ(events[0], ButtonEvent_Down);
+    TEST_EQ(events[1], ButtonEvent_LongPress);
+    TEST_NEAR(eventTime[1] - eventTime[0], BUTTON_LONG_PRESS_TIME - BUTTON_BOUNCE_TIME, 2);
+
+    SetPair(false);
+    RunMs(1);
+    TEST_EQ(eventCount, 3);
+    TEST_EQ(events[2], ButtonEvent_LpUp);
+}
+
+static void TestOtherButtonsIndependent(void)
+{
+    eventCount = 0;
+    MockGpio_Set(BTN_A_PORT, BTN_A_PIN, true);
+    RunMs(100);
+    TEST_CHECK(Button_IsPressed(BtnIdx_A));
+    TEST_CHECK(!Button_IsPressed(BtnIdx_Pair));
+    TEST_EQ(eventCount, 0);
+    MockGpio_Set(BTN_A_PORT, BTN_A_PIN, false);
+    RunMs(1);
+    TEST_CHECK(!Button_IsPressed(BtnIdx_A));
+    TEST_CHECK(!Button_IsPressed(BtnIdx_Max));
+}
+
+int main(void)
+{
+    Button_Init();
+    CL_EventSysAddListener(OnPairEvent, CL_Event_Button, BtnIdx_Pair);
+    Button_Process(); // 首次调用只记录时间
+
+    TEST_RUN(TestBounceRejected);
+    TEST_RUN(TestClick);
+    TEST_RUN(TestLongPress);
+    TEST_RUN(TestOtherButtonsIndependent);
+    return TEST_RESULT();
+}
@@ -0,0 +1,88 @@
+#include "button_map.h"
+#include "test_util.h"
+#include "stdlib.h"
+
+// 逐位映射的参考实现
+static uint16_t MapRef(const ButtonMapParams_t *params, uint16_t buttons)
+{
+    uint16_t out = 0;
+    for (int i = 0; i < BUTTON_MAP_COUNT; i++)
+    {
+        if ((buttons & (1 << i)) && params->target[i] != BUTTON_MAP_NONE)
+            out |= 1 << params->target[i];
+    }
+    return out;
+}
+
+static void TestDefaultIdentity(void)
+{
+    ButtonMapParams_t params;
+    ButtonMap_GetDefault(&params);
+    TEST_CHECK(ButtonMap_IsValid(&params));
+    ButtonMap_Build(&params);
+    for (uint32_t b = 0; b < 0x10000; b += 257)
+        TEST_EQ(ButtonMap_Apply(b), b);
+}
+
+static void TestValidity(void)
+{
+    ButtonMapParams_t params;
+    ButtonMap_GetDefault(&params);
+    params.target[3] = BUTTON_MAP_NONE;
+    TEST_CHECK(ButtonMap_IsValid(&params));
+    params.target[3] = BUTTON_MAP_COUNT;
+    TEST_CHECK(!ButtonMap_IsValid(&params));
+}
+
+static void TestRandomMaps(void)
+{
+    srand(1);
+    for (int round = 0; round < 50; round++)
+    {
+        ButtonMapParams_t params;
+        for (int i = 0; i < BUTTON_MAP_COUNT; i++)
+        {
+            int r = rand() % 18;
+            params.target[i] = r >= BUTTON_MAP_COUNT ? BUTTON_MAP_NONE : r; // 含禁用和多对一
+        }
+        TEST_CHECK(ButtonMap_IsValid(&params));
+        ButtonMap_Build(&params);
+        for (uint32_t b = 0; b < 0x10000; b++)
+        {
+            if (ButtonMap_Apply(b) != MapRef(&params, b))
+            {
+                TEST_EQ(ButtonMap_Apply(b), MapRef(&params, b));
+                return;
+            }
+        }
+    }
+}
+
+static void TestSwap(void)
+{
+    // A/B互换, 禁用XBOX
+    ButtonMapParams_t params;
+    ButtonMap_GetDefault(&params);
+    params.target[12] = 13;
+    params.target[13] = 12;
+    params.target[10] = BUTTON_MAP_NONE;
+    ButtonMap_Build(&params);
+    TEST_EQ(ButtonMap_Apply(1 << 12), 1 << 13);
+    TEST_EQ(ButtonMap_Apply(1 << 13), 1 << 12);
+    TEST_EQ(ButtonMap_Apply(1 << 10), 0);
+    TEST_EQ(ButtonMap_Apply(0x0001), 0x0001);
+
+    // 恢复默认后直接返回原值
+    ButtonMap_GetDefault(&params);
+    ButtonMap_Build(&params);
+    TEST_EQ(ButtonMap_Apply(1 << 10), 1 << 10);
+}
+
+int main(void)
+{
+    TEST_RUN(TestDefaultIdentity);
+    TEST_RUN(TestValidity);
+    TEST_RUN(TestRandomMaps);
+    TEST_RUN(TestSwap);
+    return TEST_RESULT();
+}
@@ -0,0 +1,211 @@
+#include "haptics.h"
+#include "mock.h"
+#include "test_util.h"
+
+static uint16_t MotorOut(HapticsMotor_t motor)
+{
+    return MockPwm_Get()->motor[motor];
+}
+
+// 按TIM3更新次数推进ms, 每次调用后节拍相位不变
+static void RunMs(uint32_t ms)
+{
+    for (uint32_t i = 0; i < ms * HAPTICS_TICK_DIV; i++)
+        Haptics_OnPwmUpdate();
+}
+
+// 清空效果和主机强度, 等待电机停转
+static void Settle(void)
+{
+    Haptics_Stop(HapticsMotor_Left);
+    Haptics_Stop(HapticsMotor_Right);
+    Haptics_Post(0, 0);
+    RunMs(HAPTICS_SPIN_DOWN + HAPTICS_BRAKE_TIME + 10);
+}
+
+static const HapticsEffect_t pulse2 = {
+    .level = 200,
+    .pulses = 2,
+    .attack = 10,
+    .sustain = 5,
+    .decay = 10,
+    .gap = 5,
+};
+
+static void TestEffectValid(void)
+{
+    TEST_CHECK(Haptics_EffectIsValid(&pulse2));
+    TEST_EQ(Haptics_EffectLength(&pulse2), 25 * 2 + 5);
+
+    HapticsEffect_t e = pulse2;
+    e.pulses = 0;
+    TEST_CHECK(!Haptics_EffectIsValid(&e));
+    TEST_EQ(Haptics_EffectLength(&e), 0);
+
+    e = pulse2;
+    e.attack = e.sustain = e.decay = 0;
+    TEST_CHECK(!Haptics_EffectIsValid(&e));
+
+    // 最长60s
+    e = (HapticsEffect_t){.level = 1, .pulses = 1, .attack = 60000};
+    TEST_CHECK(Haptics_EffectIsValid(&e));
+    e.sustain = 1;
+    TEST_CHECK(!Haptics_EffectIsValid(&e));
+}
+
+static void TestEnvelope(void)
+{
+    const HapticsEffect_t *e = &pulse2;
+
+    // 上升: 第1ms即有输出, 最后1ms到达峰值, 不减小
+    TEST_EQ(Haptics_EffectLevel(e, 0), 200 / 10);
+    TEST_EQ(Haptics_EffectLevel(e, 9), 200);
+    for (uint32_t t = 1; t < 10; t++)
+        TEST_CHECK(Haptics_EffectLevel(e, t) >= Haptics_EffectLevel(e, t - 1));
+
+    // 保持
+    for (uint32_t t = 10; t < 15; t++)
+        TEST_EQ(Haptics_EffectLevel(e, t), 200);
+
+    // 下降: 第1ms已低于峰值, 最后1ms仍有输出, 不增大
+    TEST_EQ(Haptics_EffectLevel(e, 15), 10 * 200 / 11);
+    TEST_EQ(Haptics_EffectLevel(e, 24), 200 / 11);
+    for (uint32_t t = 16; t < 25; t++)
+        TEST_CHECK(Haptics_EffectLevel(e, t) <= Haptics_EffectLevel(e, t - 1));
+
+    // 间隔为0, 第2个脉冲与第1个相同, 结束后为0
+    for (uint32_t t = 25; t < 30; t++)
+        TEST_EQ(Haptics_EffectLevel(e, t), 0);
+    for (uint32_t t = 0; t < 25; t++)
+        TEST_EQ(Haptics_EffectLevel(e, t + 30), Haptics_EffectLevel(e, t));
+    TEST_EQ(Haptics_EffectLevel(e, 55), 0);
+    TEST_EQ(Haptics_EffectLevel(e, 100000), 0);
+
+    // 无上升/下降时为方波
+    HapticsEffect_t square = {.level = 90, .pulses = 1, .sustain = 3};
+    TEST_EQ(Haptics_EffectLevel(&square, 0), 90);
+    TEST_EQ(Haptics_EffectLevel(&square, 2), 90);
+    TEST_EQ(Haptics_EffectLevel(&square, 3), 0);
+}
+
+static void TestLevelToDuty(void)
+{
+    TEST_EQ(Haptics_LevelToDuty(0), 0);
+    TEST_EQ(Haptics_LevelToDuty(1), HAPTICS_DUTY_MIN + (HAPTICS_DUTY_FULL - HAPTICS_DUTY_MIN) / 255);
+    TEST_EQ(Haptics_LevelToDuty(255), HAPTICS_DUTY_FULL);
+    for (int level = 2; level <= 255; level++)
+        TEST_CHECK(Haptics_LevelToDuty(level) > Haptics_LevelToDuty(level - 1));
+}
+
+// 停转后起动: 按目标占空比比例的时间满占空比输出
+static void TestKick(void)
+{
+    Settle();
+    uint16_t duty = Haptics_LevelToDuty(128);
+    uint32_t kickMs = HAPTICS_KICK_TIME * duty / HAPTICS_DUTY_FULL;
+    Haptics_Post(128, 0);
+    for (uint32_t ms = 0; ms < kickMs; ms++)
+    {
+        RunMs(1);
+        TEST_EQ(MotorOut(HapticsMotor_Left), HAPTICS_DUTY_FULL);
+    }
+    RunMs(1);
+    TEST_EQ(MotorOut(HapticsMotor_Left), duty);
+    TEST_EQ(MotorOut(HapticsMotor_Right), 0);
+
+    // 停止未超过HAPTICS_SPIN_DOWN, 电机仍在转, 再启动不加速
+    Haptics_Post(0, 0);
+    RunMs(HAPTICS_SPIN_DOWN / 2);
+    TEST_EQ(MotorOut(HapticsMotor_Left), 0);
+    Haptics_Post(128, 0);
+    RunMs(1);
+    TEST_EQ(MotorOut(HapticsMotor_Left), duty);
+
+    // 停转后再启动重新加速
+    Haptics_Post(0, 0);
+    RunMs(HAPTICS_SPIN_DOWN);
+    Haptics_Post(128, 0);
+    RunMs(1);
+    TEST_EQ(MotorOut(HapticsMotor_Left), HAPTICS_DUTY_FULL);
+}
+
+// 大幅减弱时断开输出HAPTICS_BRAKE_TIME, 小幅减弱直接输出
+static void TestBrake(void)
+{
+    Settle();
+    Haptics_Post(0, 255);
+    RunMs(HAPTICS_KICK_TIME + 5);
+    TEST_EQ(MotorOut(HapticsMotor_Right), HAPTICS_DUTY_FULL);
+
+    uint16_t small = Haptics_LevelToDuty(200);
+    TEST_CHECK(HAPTICS_DUTY_FULL - small <= HAPTICS_BRAKE_DROP);
+    Haptics_Post(0, 200);
+    RunMs(1);
+    TEST_EQ(MotorOut(HapticsMotor_Right), small);
+
+    uint16_t low = Haptics_LevelToDuty(30);
+    TEST_CHECK(small - low > HAPTICS_BRAKE_DROP);
+    Haptics_Post(0, 30);
+    for (uint32_t ms = 0; ms < HAPTICS_BRAKE_TIME; ms++)
+    {
+        RunMs(1);
+        TEST_EQ(MotorOut(HapticsMotor_Right), 0);
+    }
+    // 断开时间短于HAPTICS_SPIN_DOWN, 恢复时不加速
+    RunMs(1);
+    TEST_EQ(MotorOut(HapticsMotor_Right), low);
+}
+
+// 效果队列按包络输出, 与主机强度取较大值
+static void TestEffectQueue(void)
+{
+    Settle();
+    TEST_EQ(Haptics_Play(HapticsMotor_Right, &pulse2), CL_ResSuccess);
+    uint32_t kickMs = HAPTICS_KICK_TIME * Haptics_LevelToDuty(Haptics_EffectLevel(&pulse2, 0)) / HAPTICS_DUTY_FULL;
+    for (uint32_t t = 0; t < Haptics_EffectLength(&pulse2); t++)
+    {
+        RunMs(1);
+        uint16_t expect = t < kickMs ? HAPTICS_DUTY_FULL : Haptics_LevelToDuty(Haptics_EffectLevel(&pulse2, t));
+        TEST_EQ(MotorOut(HapticsMotor_Right), expect);
+        TEST_EQ(MotorOut(HapticsMotor_Left), 0);
+    }
+    RunMs(1);
+    TEST_EQ(MotorOut(HapticsMotor_Right), 0);
+
+    // 主机强度高于包络时输出主机强度
+    Settle();
+    Haptics_Post(0, 100);
+    RunMs(HAPTICS_KICK_TIME);
+    Haptics_Play(HapticsMotor_Right, &pulse2);
+    RunMs(1);
+    TEST_EQ(MotorOut(HapticsMotor_Right), Haptics_LevelToDuty(100));
+    RunMs(12);
+    TEST_EQ(MotorOut(HapticsMotor_Right), Haptics_LevelToDuty(200));
+
+    // 队列满/参数无效, 停止后清空
+    Settle();
+    for (int i = 0; i < HAPTICS_QUEUE_LEN; i++)
+        TEST_EQ(Haptics_Play(HapticsMotor_Left, &pulse2), CL_ResSuccess);
+    TEST_EQ(Haptics_Play(HapticsMotor_Left, &pulse2), CL_ResBusy);
+    HapticsEffect_t bad = pulse2;
+    bad.pulses = 0;
+    TEST_EQ(Haptics_Play(HapticsMotor_Right, &bad), CL_ResFailed);
+    RunMs(5);
+    TEST_CHECK(MotorOut(HapticsMotor_Left) > 0);
+    Haptics_Stop(HapticsMotor_Left);
+    RunMs(1);
+    TEST_EQ(MotorOut(HapticsMotor_Left), 0);
+    TEST_EQ(Haptics_Play(HapticsMotor_Left, &pulse2), CL_ResSuccess);
+}
+
+int main(void)
+{
+    Haptics_Init();
+    TEST_RUN(TestEffectValid);
+    TEST_RUN(TestEnvelope);
+    TEST_RUN(TestLevelToDuty);
+    TEST_RUN(TestKick);
+    TEST_RUN(TestBrake);
+    TEST_RUN(TestEffectQueue);
+    return TEST_RESULT();
+}
@@ -0,0 +1,92 @@
+#include "rapid_trigger.h"
+#include "test_util.h"
+
+#define LEFT_BIT (1 << 8)
+
+static RapidTrigParams_t params;
+
+static void Feed(uint16_t from, uint16_t to, uint16_t step)
+{
+    if (from <= to)
+        for (uint32_t v = from; v <= to; v += step)
+            RapidTrig_OnAdcFrame(v, 0);
+    else
+        for (int32_t v = from; v >= to; v -= step)
+            RapidTrig_OnAdcFrame(v, 0);
+}
+
+static void TestDisabled(void)
+{
+    RapidTrig_GetDefault(RapidTrig_Left, &params);
+    TEST_CHECK(RapidTrig_IsValid(&params));
+    RapidTrig_Config(RapidTrig_Left, &params, 200);
+    Feed(200, 3000, 10);
+    TEST_EQ(RapidTrig_GetButtons(), 0);
+}
+
+static void TestPressRelease(void)
+{
+    RapidTrig_GetDefault(RapidTrig_Left, &params);
+    params.enable = 1;
+    RapidTrig_Config(RapidTrig_Left, &params, 200);
+
+    // 在最小值附近(topDz内)不触发
+    Feed(200, 250, 5);
+    TEST_EQ(RapidTrig_GetButtons(), 0);
+
+    // 下压超过pressDelta按下
+    Feed(250, 1000, 5);
+    TEST_EQ(RapidTrig_GetButtons(), LEFT_BIT);
+
+    // 行程中间回弹releaseDelta释放, 与绝对位置无关
+    Feed(1000, 1000 - params.releaseDelta + 5, 5);
+    TEST_EQ(RapidTrig_GetButtons(), LEFT_BIT);
+    Feed(1000 - params.releaseDelta, 1000 - params.releaseDelta - 10, 5);
+    TEST_EQ(RapidTrig_GetButtons(), 0);
+
+    // 从局部最低点再下压按下
+    Feed(900, 900 + params.pressDelta, 5);
+    TEST_EQ(RapidTrig_GetButtons(), LEFT_BIT);
+
+    // 回到顶部死区内强制释放
+    RapidTrig_OnAdcFrame(200 + params.topDz, 0);
+    TEST_EQ(RapidTrig_GetButtons(), 0);
+}
+
+static void TestLatch(void)
+{
+    // 两次读取之间的短暂按下也会上报一次
+    RapidTrig_GetDefault(RapidTrig_Left, &params);
+    params.enable = 1;
+    RapidTrig_Config(RapidTrig_Left, &params, 200);
+    Feed(200, 800, 20);
+    Feed(800, 300, 20);
+    TEST_EQ(RapidTrig_GetButtons(), LEFT_BIT);
+    TEST_EQ(RapidTrig_GetButtons(), 0);
+}
+
+static void TestNoButtonAndValidity(void)
+{
+    RapidTrig_GetDefault(RapidTrig_Left, &params);
+    params.enable = 1;
+    params.buttonBit = RAPID_TRIG_NO_BUTTON;
+    TEST_CHECK(RapidTrig_IsValid(&params));
+    RapidTrig_Config(RapidTrig_Left, &params, 200);
+    Feed(200, 2000, 10);
+    TEST_EQ(RapidTrig_GetButtons(), 0);
+
+    params.buttonBit = 16;
+    TEST_CHECK(!RapidTrig_IsValid(&params));
+    RapidTrig_GetDefault(RapidTrig_Left, &params);
+    params.pressDelta = 0;
+    TEST_CHECK(!RapidTrig_IsValid(&params));
+}
+
+int main(void)
+{
+    TEST_RUN(TestDisabled);
+    TEST_RUN(TestPressRelease);
+    TEST_RUN(TestLatch);
+    TEST_RUN(TestNoButtonAndValidity);
+    return TEST_RESULT();
+}
@@ -0,0 +1,181 @@
+#include "sched.h"
+#include "ustime.h"
+#include "mock.h"
+#include "test_util.h"
+
+// 记录任务运行顺序和时间
+#define LOG_LEN (64)
+static char runLog[LOG_LEN];
+static uint32_t runTime[LOG_LEN];
+static int runCount = 0;
+
+static void Record(char name)
+{
+    if (runCount < LOG_LEN)
+    {
+        runLog[runCount] = name;
+        runTime[runCount] = GetUsTime();
+        runCount++;
+    }
+}
+
+static void ResetLog(void)
+{
+    runCount = 0;
+}
+
+static void TaskHigh(void) { Record('H'); }
+static void TaskLow(void) { Record('L'); }
+static void TaskOnce(void) { Record('O'); }
+
+static uint32_t slowCost = 0;
+static void TaskSlow(void)
+{
+    Record('S');
+    MockTime_Advance(slowCost);
+}
+
+static void TaskDelay(void)
+{
+    Record('D');
+    Sched_DelayCurrent(300);
+}
+
+static SchedTaskId_t idHigh, idLow, idOnce, idSlow, idDelay;
+
+// 运行到虚拟时间end为止
+static void RunUntil(uint64_t end)
+{
+    while (MockTime_Get() < end)
+        Sched_Run();
+}
+
+static void TestPriority(void)
+{
+    // 同时到期时高优先级先运行
+    uint64_t start = MockTime_Get();
+    ResetLog();
+    RunUntil(start + 1);
+    TEST_CHECK(runCount >= 2);
+    TEST_EQ(runLog[0], 'H');
+    TEST_EQ(runLog[1], 'L');
+}
+
+static void TestPeriod(void)
+{
+    uint64_t start = MockTime_Get();
+    ResetLog();
+    RunUntil(start + 10000);
+    int high = 0, low = 0;
+    for (int i = 0; i < runCount; i++)
+    {
+        high += runLog[i] == 'H';
+        low += runLog[i] == 'L';
+    }
+    TEST_NEAR(high, 10000 / 1000, 1);
+    TEST_NEAR(low, 10000 / 2500, 1);
+
+    const SchedTaskStat_t *stat = Sched_GetTaskStat(idHigh);
+    TEST_CHECK(stat != NULL && stat->runCount > 0);
+    TEST_CHECK(Sched_GetTaskStat(SCHED_MAX_TASK) == NULL);
+    TEST_CHECK(Sched_GetIdleStat()->idleCount > 0);
+}
+
+static void TestOneShot(void)
+{
+    ResetLog();
+    uint64_t start = MockTime_Get();
+    Sched_Start(idOnce, 500);
+    RunUntil(start + 3000);
+    int once = 0;
+    uint32_t at = 0;
+    for (int i = 0; i < runCount; i++)
+    {
+        if (runLog[i] == 'O')
+        {
+            once++;
+            at = runTime[i];
+        }
+    }
+    TEST_EQ(once, 1);
+    TEST_CHECK(at >= (uint32_t)start + 500);
+}
+
+static void TestOverrun(void)
+{
+    // 运行耗时超过整个周期时不补跑, 记一次overrun
+    Sched_Start(idSlow, 0);
+    Sched_SetPeriod(idSlow, 1000);
+    slowCost = 3500;
+    uint64_t start = MockTime_Get();
+    RunUntil(start + 20000);
+    Sched_Stop(idSlow);
+    const SchedTaskStat_t *stat = Sched_GetTaskStat(idSlow);
+    TEST_CHECK(stat->overrunCount > 0);
+    TEST_CHECK(stat->maxRunTime >= 3500);
+}
+
+static void TestDelayCurrent(void)
+{
+    ResetLog();
+    Sched_Start(idDelay, 0);
+    uint64_t start = MockTime_Get();
+    RunUntil(start + 2000);
+    Sched_Stop(idDelay);
+    uint32_t last = 0;
+    int delays = 0;
+    for (int i = 0; i < runCount; i++)
+    {
+        if (runLog[i] != 'D')
+            continue;
+        if (delays > 0)
+            TEST_CHECK(runTime[i] - last >= 300);
+        last = runTime[i];
+        delays++;
+    }
+    TEST_CHECK(delays >= 4);
+
+    // 任务外调用无效
+    Sched_DelayCurrent(100);
+}
+
+static void TestWrap(void)
+{
+    // 32位us时间回绕时周期保持
+    MockTime_Set(0x100000000ull - 5000);
+    for (SchedTaskId_t i = 0; i <= idLow; i++)
+        Sched_Start(i, 0);
+    ResetLog();
+    RunUntil(0x100000000ull + 5000);
+    int high = 0;
+    for (int i = 0; i < runCount; i++)
+        high += runLog[i] == 'H';
+    TEST_NEAR(high, 10, 1);
+}
+
+static void TestAddLimit(void)
+{
+    int added = 0;
+    while (Sched_AddTask(TaskOnce, 0, SchedPrio_Low, "fill") != SCHED_INVALID_ID)
+        added++;
+    TEST_EQ(added, SCHED_MAX_TASK - 5);
+    TEST_EQ(Sched_AddTask(NULL, 0, SchedPrio_Low, "null"), SCHED_INVALID_ID);
+}
+
+int main(void)
+{
+    idHigh = Sched_AddTask(TaskHigh, 1000, SchedPrio_High, "high");
+    idLow = Sched_AddTask(TaskLow, 2500, SchedPrio_Low, "low");
+    idOnce = Sched_AddTask(TaskOnce, 0, SchedPrio_Normal, "once");
+    idSlow = Sched_AddTask(TaskSlow, 0, SchedPrio_Normal, "slow");
+    idDelay = Sched_AddTask(TaskDelay, 0, SchedPrio_Normal, "delay");
+
+    TEST_RUN(TestPriority);
+    TEST_RUN(TestPeriod);
+    TEST_RUN(TestOneShot);
+    TEST_RUN(TestOverrun);
+    TEST_RUN(TestDelayCurrent);
+    TEST_RUN(TestWrap);
+    TEST_RUN(TestAddLimit);
+    return TEST_RESULT();
+}
@@ -0,0 +1,217 @@
+#include "shape.h"
+#include "test_util.h"
+
+#define STICK_MAX (32767)
+
+// 线性曲线的期望输出, 查表量化误差由调用者给出容差
+static float LinearRef(float r, float innerDz, float outerDz)
+{
+    float outer = 1.0f - outerDz;
+    if (r < innerDz)
+        return 0;
+    if (r >= outer)
+        return STICK_MAX;
+    return (r - innerDz) / (outer - innerDz) * STICK_MAX;
+}
+
+static float StickOut(ShapeInput_t in, float x, float y)
+{
+    Vector2 v = {x, y};
+    Shape_Stick(in, &v);
+    return sqrtf(v.x * v.x + v.y * v.y);
+}
+
+static void TestDefaults(void)
+{
+    for (int i = 0; i < ShapeIn_Max; i++)
+    {
+        ShapeParams_t params;
+        Shape_GetDefault((ShapeInput_t)i, &params);
+        TEST_CHECK(Shape_IsValid(&params));
+    }
+
+    ShapeParams_t bad;
+    Shape_GetDefault(ShapeIn_LeftStick, &bad);
+    bad.exponent = 0;
+    TEST_CHECK(!Shape_IsValid(&bad));
+    Shape_GetDefault(ShapeIn_LeftStick, &bad);
+    bad.innerDz = 500;
+    bad.outerDz = 400;
+    TEST_CHECK(!Shape_IsValid(&bad));
+    Shape_GetDefault(ShapeIn_LeftStick, &bad);
+    bad.curve = ShapeCurve_Max;
+    TEST_CHECK(!Shape_IsValid(&bad));
+}
+
+static void TestStickLinear(void)
+{
+    ShapeParams_t params;
+    Shape_GetDefault(ShapeIn_LeftStick, &params);
+    Shape_Build(ShapeIn_LeftStick, &params, 0.05f);
+
+    // 一个表项对应半径1/SHAPE_STICK_LUT_SIZE, 输出误差不超过一个表项的斜率
+    float tol = 1.0f / SHAPE_STICK_LUT_SIZE / (0.993f - 0.05f) * STICK_MAX + 1;
+    for (float r = 0; r <= 1.2f; r += 0.01f)
+        TEST_NEAR(StickOut(ShapeIn_LeftStick, 0, r), LinearRef(r, 0.05f, 0.007f), tol);
+
+    TEST_EQ(StickOut(ShapeIn_LeftStick, 0.03f, 0.03f), 0);
+    TEST_NEAR(StickOut(ShapeIn_LeftStick, 1.0f, 0), STICK_MAX, 1);
+}
+
+// 非线性曲线与反死区: 表项间插值的误差, 内死区边缘的跳变不被插值抹平
+static void TestStickInterp(void)
+{
+    ShapeParams_t params;
+    Shape_GetDefault(ShapeIn_LeftStick, &params);
+    params.innerDz = 101;
+    params.antiDz = 200;
+    params.exponent = 20; // 平方
+    Shape_Build(ShapeIn_LeftStick, &params, 0);
+
+    float inner = 0.101f, outer = 0.993f;
+    // 外死区所在的一格跨过曲线的拐点, 误差不超过斜率*表项间隔/4; 其它位置只有曲率带来的误差
+    float slope = 0.8f * 2 / (outer - inner) * STICK_MAX;
+    float kinkTol = slope / SHAPE_STICK_LUT_SIZE / 4 + 1;
+    for (float r = inner + 1e-4f; r < 1.0f; r += 0.0007f)
+    {
+        float x = CL_MIN((r - inner) / (outer - inner), 1.0f);
+        float ref = (0.2f + 0.8f * x * x) * STICK_MAX;
+        bool kink = fabsf(r - outer) < 1.0f / SHAPE_STICK_LUT_SIZE;
+        TEST_NEAR(StickOut(ShapeIn_LeftStick, 0, r), ref, kink ? kinkTol : 2);
+    }
+
+    TEST_EQ(StickOut(ShapeIn_LeftStick, 0, inner - 1e-4f), 0);
+    TEST_NEAR(StickOut(ShapeIn_LeftStick, 0, inner + 1e-4f), 0.2f * STICK_MAX, 2);
+}
+
+static void TestStickDirection(void)
+{
+    ShapeParams_t params;
+    Shape_GetDefault(ShapeIn_RightStick, &params);
+    Shape_Build(ShapeIn_RightStick, &params, 0.05f);
+    for (float a = 0; a < 6.28f; a += 0.3f)
+    {
+        Vector2 v = {0.6f * cosf(a), 0.6f * sinf(a)};
+        Shape_Stick(ShapeIn_RightStick, &v);
+        float outA = atan2f(v.y, v.x);
+        float diff = remainderf(outA - a, 2 * (float)M_PI);
+        TEST_NEAR(diff, 0, 1e-3);
+    }
+
+    // 超出边界时各轴限幅
+    Vector2 v = {1.5f, -1.5f};
+    Shape_Stick(ShapeIn_RightStick, &v);
+    TEST_CHECK(v.x <= STICK_MAX && v.y >= -STICK_MAX);
+}
+
+static void TestStickAxialAndCurve(void)
+{
+    ShapeParams_t params;
+    Shape_GetDefault(ShapeIn_LeftStick, &params);
+    params.axialDz = 100;
+    params.curve = ShapeCurve_Points;
+    params.point[0] = 0;
+    params.point[1] = 0;
+    params.point[2] = 0;
+    params.point[3] = 0;
+    params.point[4] = 255;
+    Shape_Build(ShapeIn_LeftStick, &params, 0);
+
+    // 单轴小于轴向死区时置0
+    Vector2 v = {0.05f, 0.9f};
+    Shape_Stick(ShapeIn_LeftStick, &v);
+    TEST_EQ(v.x, 0);
+    // 前3/4行程输出为0
+    TEST_EQ(StickOut(ShapeIn_LeftStick, 0, 0.7f), 0);
+    TEST_CHECK(StickOut(ShapeIn_LeftStick, 0, 0.9f) > 0);
+}
+
+static void TestTrigger(void)
+{
+    ShapeParams_t params;
+    Shape_GetDefault(ShapeIn_LeftTrigger, &params);
+    Shape_Build(ShapeIn_LeftTrigger, &params, 0);
+
+    TEST_EQ(Shape_Trigger(ShapeIn_LeftTrigger, 100, 200, 3200), 0);
+    TEST_EQ(Shape_Trigger(ShapeIn_LeftTrigger, 200, 200, 3200), 0);
+    TEST_EQ(Shape_Trigger(ShapeIn_LeftTrigger, 3300, 200, 3200), 255);
+    // 2.5%死区内为0
+    TEST_EQ(Shape_Trigger(ShapeIn_LeftTrigger, 200 + 3000 * 2 / 100, 200, 3200), 0);
+    // 平方根曲线: 中点约为0.7
+    float mid = (0.5f - 0.025f) / 0.975f;
+    TEST_NEAR(Shape_Trigger(ShapeIn_LeftTrigger, 1700, 200, 3200), sqrtf(mid) * 255, 3);
+
+    // 单调
+    uint8_t last = 0;
+    for (int adc = 200; adc <= 3200; adc += 7)
+    {
+        uint8_t out = Shape_Trigger(ShapeIn_LeftTrigger, adc, 200, 3200);
+        TEST_CHECK(out >= last);
+        last = out;
+    }
+}
+
+// 无内死区但有反死区: 松开时为0, 一离开min即从反死区起步
+static void TestTriggerAntiNoInner(void)
+{
+    ShapeParams_t params;
+    Shape_GetDefault(ShapeIn_RightTrigger, &params);
+    params.innerDz = 0;
+    params.antiDz = 200;
+    params.curve = ShapeCurve_Power;
+    params.exponent = 10;
+    TEST_CHECK(Shape_IsValid(&params));
+    Shape_Build(ShapeIn_RightTrigger, &params, 0);
+
+    TEST_EQ(Shape_Trigger(ShapeIn_RightTrigger, 150, 200, 3200), 0);
+    TEST_EQ(Shape_Trigger(ShapeIn_RightTrigger, 200, 200, 3200), 0);
+    TEST_NEAR(Shape_Trigger(ShapeIn_RightTrigger, 200 + 3000 * 2 / 100, 200, 3200), (0.2f + 0.8f * 0.02f) * 255, 2);
+    TEST_EQ(Shape_Trigger(ShapeIn_RightTrigger, 3200, 200, 3200), 255);
+}
+
+static void TestStage(void)
+{
+    ShapeParams_t params;
+    Shape_GetDefault(ShapeIn_LeftStick, &params);
+    Shape_Build(ShapeIn_LeftStick, &params, 0.05f);
+    float before = StickOut(ShapeIn_LeftStick, 0, 0.5f);
+
+    // 备用组生成期间仍使用原来的表
+    ShapeParams_t next = params;
+    next.innerDz = 600;
+    Shape_StageBegin(ShapeIn_LeftStick, &next, 0.05f);
+    int steps = 0;
+    while (!Shape_StageStep(64))
+    {
+        steps++;
+        TEST_NEAR(StickOut(ShapeIn_LeftStick, 0, 0.5f), before, 0.5f);
+    }
+    TEST_CHECK(steps > 0);
+    TEST_NEAR(StickOut(ShapeIn_LeftStick, 0, 0.5f), before, 0.5f);
+
+    // 其余输入原样生成到备用组后整体切换
+    for (int in = ShapeIn_RightStick; in < ShapeIn_Max; in++)
+    {
+        ShapeParams_t p;
+        Shape_GetDefault((ShapeInput_t)in, &p);
+        Shape_StageBegin((ShapeInput_t)in, &p, 0.05f);
+        while (!Shape_StageStep(64))
+            ;
+    }
+    Shape_StageCommit();
+    TEST_EQ(StickOut(ShapeIn_LeftStick, 0, 0.5f), 0);
+    TEST_CHECK(StickOut(ShapeIn_LeftStick, 0, 0.8f) > 0);
+}
+
+int main(void)
+{
+    TEST_RUN(TestDefaults);
+    TEST_RUN(TestStickLinear);
+    TEST_RUN(TestStickInterp);
+    TEST_RUN(TestStickDirection);
+    TEST_RUN(TestStickAxialAndCurve);
+    TEST_RUN(TestTrigger);
+    TEST_RUN(TestTriggerAntiNoInner);
+    TEST_RUN(TestStage);
+    return TEST_RESULT();
+}
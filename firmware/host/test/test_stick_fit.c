@@ -0,0 +1,116 @@
+#include "stick_fit.h"
+#include "pad_synth.h"
+#include "test_util.h"
+
+#define FIT_LEN (60)
+#define FIT_RATE (2) // 每ms采样数, 与摇杆帧率一致
+#define FIT_MAX_ERR (10.0f) // ADC值
+
+// 边界偏心且有多瓣, 校准的中心与真实中心相差(25, -18)
+static const SynthStick_t stick = {
+    .midX = 2035, .midY = 2075, .radius = 1400,
+    .lobe = {0.03f, 0.05f, 0.02f}, .phase = {0.4f, 1.1f, 2.0f}, .noise = 6.0f};
+static const float caliMidX = 2010, caliMidY = 2093;
+
+static StickFit_t fit;
+static SynthRng_t rng;
+
+static void Add(float angle, float scale)
+{
+    uint16_t x, y;
+    Synth_Stick(&stick, &rng, angle, scale, &x, &y);
+    StickFit_Add(&fit, x - caliMidX, y - caliMidY);
+}
+
+// 以校准中心为原点, angle方向(从+y轴起顺时针)到真实边界的距离, 二分求解
+static float BoundaryFromCaliMid(float angle)
+{
+    float lo = 0, hi = 3000;
+    for (int i = 0; i < 40; i++)
+    {
+        float t = (lo + hi) / 2;
+        float dx = caliMidX + t * sinf(angle) - stick.midX;
+        float dy = caliMidY + t * cosf(angle) - stick.midY;
+        float a = atan2f(dx, dy);
+        if (sqrtf(dx * dx + dy * dy) < Synth_Boundary(&stick, a))
+            lo = t;
+        else
+            hi = t;
+    }
+    return lo;
+}
+
+static float MaxError(const uint16_t *mags)
+{
+    float maxErr = 0;
+    for (int i = 0; i < FIT_LEN; i++)
+        maxErr = fmaxf(maxErr, fabsf(mags[i] - BoundaryFromCaliMid(i * 2 * (float)M_PI / FIT_LEN)));
+    return maxErr;
+}
+
+// 搓圈(0.8s一圈, 2kHz采样), 每3圈回中推拉一次, 另有单个采样的尖峰
+static void TestSynthBoundary(void)
+{
+    StickFit_Reset(&fit);
+    rng.state = 12345;
+    for (uint32_t i = 0; i < 5000 * FIT_RATE; i++)
+    {
+        float ms = (float)i / FIT_RATE;
+        float angle = ms * 2 * (float)M_PI / 800;
+        float phase = fmodf(ms, 2400);
+        float scale = phase < 100 ? fabsf(phase - 50) / 50.0f : 1.0f;
+        if (i % (337 * FIT_RATE) == 200 * FIT_RATE)
+            scale = 1.3f; // 尖峰
+        Add(angle, scale);
+    }
+    TEST_CHECK(StickFit_IsCovered(&fit));
+
+    uint16_t mags[FIT_LEN];
+    TEST_EQ(StickFit_Solve(&fit, mags, FIT_LEN), CL_ResSuccess);
+    float err = MaxError(mags);
+    TEST_CHECK(err < FIT_MAX_ERR);
+    printf("max error %.1f adc\n", err);
+}
+
+// 搓满边缘后只推到60%, 较小半径的采样被包络拒绝, 不拉低边界
+static void TestInnerStrokes(void)
+{
+    StickFit_Reset(&fit);
+    rng.state = 777;
+    for (uint32_t i = 0; i < 4000 * FIT_RATE; i++)
+    {
+        float ms = (float)i / FIT_RATE;
+        float angle = ms * 2 * (float)M_PI / 800;
+        float scale = ms < 2400 ? 1.0f : 0.6f;
+        Add(angle, scale);
+    }
+    uint16_t mags[FIT_LEN];
+    TEST_EQ(StickFit_Solve(&fit, mags, FIT_LEN), CL_ResSuccess);
+    TEST_CHECK(MaxError(mags) < FIT_MAX_ERR);
+}
+
+// 覆盖不足时求解失败
+static void TestCoverage(void)
+{
+    StickFit_Reset(&fit);
+    rng.state = 99;
+    for (uint32_t i = 0; i < 3000 * FIT_RATE; i++)
+        Add((i % (400 * FIT_RATE)) * (float)M_PI / (400 * FIT_RATE), 1.0f); // 只在半圈内来回
+    TEST_CHECK(!StickFit_IsCovered(&fit));
+    uint16_t mags[FIT_LEN];
+    TEST_EQ(StickFit_Solve(&fit, mags, FIT_LEN), CL_ResFailed);
+
+    // 中心附近的采样不计入
+    StickFit_Reset(&fit);
+    for (uint32_t i = 0; i < 3000 * FIT_RATE; i++)
+        Add(i * 2 * (float)M_PI / (800 * FIT_RATE), 0.1f);
+    TEST_EQ(fit.cosSum[0], 0);
+}
+
+int main(void)
+{
+    TEST_RUN(TestSynthBoundary);
+    TEST_RUN(TestInnerStrokes);
+    TEST_RUN(TestCoverage);
+    return TEST_RESULT();
+}
@@ -0,0 +1,124 @@
+#include "stick_lin.h"
+#include "test_util.h"
+
+#define LIN_TOL (2.0f / STICK_LIN_ONE * 4) // Q14截断误差
+
+static void TestDefaultIdentity(void)
+{
+    StickLinParams_t params;
+    StickLin_GetDefault(&params);
+    TEST_CHECK(StickLin_IsValid(&params));
+    for (float x = -1.2f; x <= 1.2f; x += 0.05f)
+    {
+        Vector2 v = {x, -x * 0.5f};
+        StickLin_Apply(&params, &v);
+        TEST_NEAR(v.x, x, LIN_TOL);
+        TEST_NEAR(v.y, -x * 0.5f, LIN_TOL);
+    }
+}
+
+static void TestInputClamp(void)
+{
+    StickLinParams_t params;
+    StickLin_GetDefault(&params);
+    Vector2 v = {5.0f, -5.0f};
+    StickLin_Apply(&params, &v);
+    TEST_NEAR(v.x, 1.5f, LIN_TOL);
+    TEST_NEAR(v.y, -1.5f, LIN_TOL);
+}
+
+// 模拟的摇杆: 各轴先经过非线性响应, 再叠加交叉耦合
+static const float couplingA = 0.08f;  // x轴推动时y的读数比例
+static const float couplingB = -0.05f; // y轴推动时x的读数比例
+
+static float Response(float t)
+{
+    return t + 0.12f * t * (1 - fabsf(t)); // 中段偏大
+}
+
+static void Measure(float tx, float ty, int16_t measured[2])
+{
+    float rx = Response(tx), ry = Response(ty);
+    measured[0] = lroundf((rx + couplingB * ry) * 1000);
+    measured[1] = lroundf((couplingA * rx + ry) * 1000);
+}
+
+static int BuildCaptures(StickLinCapture_t *captures)
+{
+    static const int16_t targets[] = {250, 500, 750, 1000, -250, -500, -750, -1000};
+    int n = 0;
+    for (int axis = 0; axis < 2; axis++)
+    {
+        for (int i = 0; i < CL_ARRAY_LENGTH(targets); i++)
+        {
+            StickLinCapture_t *c = &captures[n++];
+            c->target[axis] = targets[i];
+            c->target[1 - axis] = 0;
+            Measure(axis == 0 ? targets[i] / 1000.0f : 0, axis == 1 ? targets[i] / 1000.0f : 0, c->measured);
+        }
+    }
+    return n;
+}
+
+static void TestSolveCorrects(void)
+{
+    StickLinCapture_t captures[STICK_LIN_MAX_CAPTURES];
+    int n = BuildCaptures(captures);
+    StickLinParams_t params;
+    TEST_EQ(StickLin_Solve(captures, n, &params), CL_ResSuccess);
+    TEST_CHECK(StickLin_IsValid(&params));
+
+    // 采样点之间(含对角方向)校正后误差应明显小于校正前
+    float maxBefore = 0, maxAfter = 0;
+    for (float tx = -0.9f; tx <= 0.9f; tx += 0.1f)
+    {
+        for (float ty = -0.9f; ty <= 0.9f; ty += 0.3f)
+        {
+            int16_t m[2];
+            Measure(tx, ty, m);
+            Vector2 v = {m[0] / 1000.0f, m[1] / 1000.0f};
+            maxBefore = fmaxf(maxBefore, fmaxf(fabsf(v.x - tx), fabsf(v.y - ty)));
+            StickLin_Apply(&params, &v);
+            maxAfter = fmaxf(maxAfter, fmaxf(fabsf(v.x - tx), fabsf(v.y - ty)));
+        }
+    }
+    TEST_CHECK(maxBefore > 0.05f);
+    TEST_CHECK(maxAfter < 0.02f);
+}
+
+static void TestSolveRejects(void)
+{
+    StickLinCapture_t captures[STICK_LIN_MAX_CAPTURES];
+    StickLinParams_t params;
+    int n = BuildCaptures(captures);
+
+    // 缺少-y半轴
+    TEST_EQ(StickLin_Solve(captures, n - 4, &params), CL_ResFailed);
+
+    // 耦合过大
+    for (int i = 0; i < 8; i++)
+        captures[i].measured[1] = captures[i].measured[0] / 2;
+    TEST_EQ(StickLin_Solve(captures, n, &params), CL_ResFailed);
+}
+
+static void TestValidity(void)
+{
+    StickLinParams_t params;
+    StickLin_GetDefault(&params);
+    params.table[0][3] = params.table[0][4]; // 不单调
+    TEST_CHECK(!StickLin_IsValid(&params));
+
+    StickLin_GetDefault(&params);
+    params.matrix[0][1] = STICK_LIN_ONE; // 耦合过大
+    TEST_CHECK(!StickLin_IsValid(&params));
+}
+
+int main(void)
+{
+    TEST_RUN(TestDefaultIdentity);
+    TEST_RUN(TestInputClamp);
+    TEST_RUN(TestSolveCorrects);
+    TEST_RUN(TestSolveRejects);
+    TEST_RUN(TestValidity);
+    return TEST_RESULT();
+}
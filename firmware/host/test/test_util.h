@@ -0,0 +1,52 @@
+#pragma once
+
+// 主机单元测试的最小断言宏, 失败时打印位置并计数, main返回失败数
+
+#include <stdio.h>
+#include <math.h>
+
+static int testFailures = 0;
+
+#define TEST_CHECK(cond)                                                   \
+    do                                                                     \
+    {                                                                      \
+        if (!(cond))                                                       \
+        {                                                                  \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            testFailures++;                                                \
+        }                                                                  \
+    } while (0)
+
+#define TEST_EQ(a, b)                                                           \
+    do                                                                          \
+    {                                                                           \
+        long long va_ = (long long)(a), vb_ = (long long)(b);                   \
+        if (va_ != vb_)                                                         \
+        {                                                                       \
+            printf("%s:%d: %s == %s failed: %lld != %lld\n", __FILE__, __LINE__, \
+                   #a, #b, va_, vb_);                                           \
+            testFailures++;                                                     \
+        }                                                                       \
+    } while (0)
+
+#define TEST_NEAR(a, b, tol)                                                       \
+    do                                                                             \
+    {                                                                              \
+        double va_ = (double)(a), vb_ = (double)(b);                               \
+        if (!(fabs(va_ - vb_) <= (tol)))                                           \
+        {                                                                          \
+            printf("%s:%d: %s ~= %s failed: %g vs %g (tol %g)\n", __FILE__, __LINE__, \
+                   #a, #b, va_, vb_, (double)(tol));                               \
+            testFailures++;                                                        \
+        }                                                                          \
+    } while (0)
+
+#define TEST_RUN(func)            \
+    do                            \
+    {                             \
+        int before_ = testFailures; \
+        func();                   \
+        printf("%s %s\n", testFailures == before_ ? "[ok]  " : "[FAIL]", #func); \
+    } while (0)
+
+#define TEST_RESULT() (testFailures == 0 ? 0 : 1)
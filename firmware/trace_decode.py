@@ -0,0 +1,198 @@
+# pip install pyelftools pyserial
+# usage: python trace_decode.py app.axf COM3 [-b baudrate] [--raw capture.bin] [--csv capture.csv] [--trace capture.ptr]
+#        python trace_decode.py app.axf capture.bin [--csv capture.csv] [--trace capture.ptr]
+# --trace输出host/replay的回放格式, 用pad_replay在主机上重放
+
+import sys
+import struct
+import re
+import argparse
+import csv
+from elftools.elf.elffile import ELFFile
+
+FLASH_BASE = 0x08000000
+TRACE_SYNC = 0xA5
+RECORD_SIZE = 24
+
+class FormatTable:
+    def __init__(self, elfPath):
+        self.sections = []
+        self.cache = {}
+        with open(elfPath, "rb") as f:
+            elf = ELFFile(f)
+            for sec in elf.iter_sections():
+                if sec["sh_addr"] >= FLASH_BASE and sec["sh_type"] == "SHT_PROGBITS":
+                    self.sections.append((sec["sh_addr"], sec.data()))
+
+    def get(self, addr):
+        if addr in self.cache:
+            return self.cache[addr]
+
+        fmt = None
+        for base, data in self.sections:
+            if base <= addr < base + len(data):
+                end = data.find(b"\0", addr - base)
+                if end >= 0:
+                    fmt = data[addr - base:end].decode("utf-8", "replace")
+                break
+        self.cache[addr] = fmt
+        return fmt
+
+# C格式 -> python格式, 参数都按32位整数处理
+def ToPyFormat(fmt):
+    return re.sub(r"%([-+ #0]*\d*)(hh|h|ll|l)?([diuxXoc])", lambda m: "%" + m.group(1) + m.group(3).replace("u", "d"), fmt)
+
+def ToSigned(fmt, args):
+    result = []
+    for conv, arg in zip(re.findall(r"%[-+ #0]*\d*(?:hh|h|ll|l)?([diuxXoc%])", fmt), args):
+        if conv in "di" and arg >= 0x80000000:
+            arg -= 0x100000000
+        result.append(arg)
+    return result
+
+# PAD_CAPTURE_ENABLE输出的采集记录, 每帧一条输入一条输出
+CAPTURE_IN_FMT = "cap in: %08x %08x %08x %08x"
+CAPTURE_OUT_FMT = "cap out: %08x %08x %08x"
+CAPTURE_COLUMNS = ["time_us",
+                   "right_hall", "right_x", "right_y", "left_hall", "left_x", "left_y", "button0", "button1",
+                   "left_x_out", "left_y_out", "right_x_out", "right_y_out", "left_trigger_out", "right_trigger_out"]
+
+def Int16(v):
+    return v - 0x10000 if v >= 0x8000 else v
+
+# 与host/replay/pad_trace.h一致
+PAD_TRACE_MAGIC = 0x43525450
+PAD_TRACE_VERSION = 1
+PAD_TRACE_HEADER = "<IHHII"
+PAD_TRACE_FRAME = "<I6HHH"
+
+class CaptureWriter:
+    def __init__(self, csvPath, tracePath):
+        self.file = None
+        self.trace = None
+        self.traceCount = 0
+        if csvPath:
+            self.file = open(csvPath, "w", newline="")
+            self.writer = csv.writer(self.file)
+            self.writer.writerow(CAPTURE_COLUMNS)
+        if tracePath:
+            self.trace = open(tracePath, "wb")
+            self.WriteTraceHeader()
+        self.frame = None
+
+    def WriteTraceHeader(self):
+        self.trace.seek(0)
+        self.trace.write(struct.pack(PAD_TRACE_HEADER, PAD_TRACE_MAGIC, PAD_TRACE_VERSION,
+                                     struct.calcsize(PAD_TRACE_FRAME), self.traceCount, 0))
+
+    def WriteTraceFrame(self, frame):
+        # 按键为读取的引脚电平, 重映射之前
+        self.trace.write(struct.pack(PAD_TRACE_FRAME, frame[0] & 0xffffffff, *frame[1:7],
+                                     frame[7] | (frame[8] << 8), 0))
+        self.traceCount += 1
+
+    def OnRecord(self, us, fmt, args):
+        if fmt == CAPTURE_IN_FMT:
+            self.frame = [us,
+                          args[0] & 0xffff, args[0] >> 16, args[1] & 0xffff, args[1] >> 16,
+                          args[2] & 0xffff, args[2] >> 16, args[3] & 0xff, (args[3] >> 8) & 0xff]
+            if self.trace is not None:
+                self.WriteTraceFrame(self.frame)
+        elif fmt == CAPTURE_OUT_FMT and self.frame is not None:
+            self.frame += [Int16(args[0] & 0xffff), Int16(args[0] >> 16),
+                           Int16(args[1] & 0xffff), Int16(args[1] >> 16),
+                           args[2] & 0xff, (args[2] >> 8) & 0xff]
+            if self.file is not None:
+                self.writer.writerow(self.frame)
+            self.frame = None
+        else:
+            return False
+        return True
+
+    def Close(self):
+        if self.file is not None:
+            self.file.close()
+        if self.trace is not None:
+            self.WriteTraceHeader()
+            self.trace.close()
+
+class Decoder:
+    def __init__(self, table, capture=None):
+        self.table = table
+        self.capture = capture
+        self.buff = bytearray()
+        self.text = bytearray()
+        self.timeHigh = 0
+        self.lastTime = 0
+
+    def Feed(self, data):
+        self.buff += data
+        while len(self.buff) > 0:
+            if self.buff[0] != TRACE_SYNC:
+                ch = self.buff.pop(0)
+                if ch == ord("\n"):
+                    print(self.text.decode("utf-8", "replace").rstrip("\r"))
+                    self.text.clear()
+                else:
+                    self.text.append(ch)
+                continue
+
+            if len(self.buff) < RECORD_SIZE:
+                break
+
+            header, time, *args = struct.unpack_from("<II4I", self.buff)
+            fmt = self.table.get(FLASH_BASE + (header >> 15))
+            argc = (header >> 12) & 0x07
+            if fmt is None or argc > 4:
+                self.buff.pop(0) # 同步字误判, 丢弃后重新同步
+                continue
+
+            del self.buff[:RECORD_SIZE]
+            us = self.ExtendTime(time)
+            if self.capture is not None and self.capture.OnRecord(us, fmt, args[:argc]):
+                continue
+            print(self.Format(us, fmt, args[:argc]))
+
+    def ExtendTime(self, time):
+        if time < self.lastTime:
+            self.timeHigh += 1
+        self.lastTime = time
+        return (self.timeHigh << 32) | time
+
+    def Format(self, us, fmt, args):
+        try:
+            text = ToPyFormat(fmt) % tuple(ToSigned(fmt, args))
+        except (TypeError, ValueError):
+            text = "{0} {1}".format(fmt, args)
+        return "[{0:>12.6f}] {1}".format(us / 1000000, text)
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="decode binary trace records")
+    parser.add_argument("axf", help="firmware elf file, must match the running firmware")
+    parser.add_argument("source", help="serial port or captured raw file")
+    parser.add_argument("-b", "--baudrate", type=int, default=115200)
+    parser.add_argument("--raw", help="save received raw bytes, for decoding later")
+    parser.add_argument("--csv", help="export capture frames to csv")
+    parser.add_argument("--trace", help="export capture inputs for host replay")
+    args = parser.parse_args()
+
+    capture = CaptureWriter(args.csv, args.trace) if args.csv or args.trace else None
+    decoder = Decoder(FormatTable(args.axf), capture)
+    try:
+        if args.source.upper().startswith("COM") or args.source.startswith("/dev/"):
+            import serial
+            raw = open(args.raw, "wb") if args.raw else None
+            with serial.Serial(args.source, args.baudrate, timeout=0.1) as port:
+                while True:
+                    data = port.read(1024)
+                    if raw is not None:
+                        raw.write(data)
+                    decoder.Feed(data)
+        else:
+            with open(args.source, "rb") as f:
+                decoder.Feed(f.read())
+    except KeyboardInterrupt:
+        pass
+    finally:
+        if capture is not None:
+            capture.Close()